@@ -0,0 +1,326 @@
+#include <renoir-null/Renoir-null.h>
+
+#include <mn/Thread.h>
+#include <mn/Assert.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// api overhead microbenchmarks, they drive renoir-null headlessly so they run on any machine without a window or
+// a gpu, every api call is timed from multiple recording threads each with its own pass, and the results are
+// printed as json to stdout or to the file given with --out
+//
+// there's no immediate/defer_api_calls axis since renoir-null runs the same code for the pass commands in both modes,
+// the mode only changes when the commands execute in gl450/dx11
+//
+// usage: renoir-bench [--iterations N] [--out path]
+
+enum BENCH_OP
+{
+	BENCH_OP_DRAW,
+	BENCH_OP_BUFFER_WRITE,
+	BENCH_OP_TEXTURE_BIND,
+	BENCH_OP_USE_PIPELINE,
+	BENCH_OP_PASS_SUBMIT,
+	BENCH_OP_COUNT,
+};
+
+const char* BENCH_OP_NAMES[BENCH_OP_COUNT] = {
+	"draw",
+	"buffer_write",
+	"texture_bind",
+	"use_pipeline",
+	"pass_submit",
+};
+
+const int BENCH_THREADS[] = {1, 2, 4, 8, 16};
+constexpr int BENCH_THREADS_MAX = 16;
+
+struct Bench_Resources
+{
+	Renoir_Swapchain swapchain;
+	Renoir_Program program;
+	Renoir_Pipeline pipeline;
+	Renoir_Buffer vertices;
+	Renoir_Buffer uniforms;
+	Renoir_Texture texture;
+};
+
+struct Bench_Thread
+{
+	Renoir* gfx;
+	const Bench_Resources* resources;
+	BENCH_OP op;
+	size_t iterations;
+	Renoir_Pass pass;
+	std::atomic<int>* ready;
+	std::atomic<bool>* go;
+	uint64_t elapsed_in_nanos;
+};
+
+static uint64_t
+time_in_nanos()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+static void
+bench_op_run(Renoir* gfx, const Bench_Resources& resources, Renoir_Pass pass, BENCH_OP op, size_t iterations)
+{
+	switch (op)
+	{
+	case BENCH_OP_DRAW:
+	{
+		Renoir_Draw_Desc draw{};
+		draw.primitive = RENOIR_PRIMITIVE_TRIANGLES;
+		draw.elements_count = 3;
+		draw.vertex_buffers[0].buffer = resources.vertices;
+		draw.vertex_buffers[0].type = RENOIR_TYPE_FLOAT_2;
+		for (size_t i = 0; i < iterations; ++i)
+			gfx->draw(gfx, pass, draw);
+		break;
+	}
+	case BENCH_OP_BUFFER_WRITE:
+	{
+		float data[16] = {};
+		for (size_t i = 0; i < iterations; ++i)
+			gfx->buffer_write(gfx, pass, resources.uniforms, 0, data, sizeof(data));
+		break;
+	}
+	case BENCH_OP_TEXTURE_BIND:
+	{
+		for (size_t i = 0; i < iterations; ++i)
+			gfx->texture_bind(gfx, pass, resources.texture, RENOIR_SHADER_PIXEL, 0);
+		break;
+	}
+	case BENCH_OP_USE_PIPELINE:
+	{
+		for (size_t i = 0; i < iterations; ++i)
+			gfx->use_pipeline(gfx, pass, resources.pipeline);
+		break;
+	}
+	case BENCH_OP_PASS_SUBMIT:
+	{
+		for (size_t i = 0; i < iterations; ++i)
+			gfx->pass_submit(gfx, pass);
+		break;
+	}
+	default:
+		mn_unreachable();
+		break;
+	}
+}
+
+static void
+bench_thread_main(void* arg)
+{
+	auto self = (Bench_Thread*)arg;
+
+	// warm up the caches before all the threads start timing together
+	bench_op_run(self->gfx, *self->resources, self->pass, self->op, self->iterations / 10);
+
+	self->ready->fetch_add(1);
+	while (self->go->load() == false)
+	{}
+
+	auto start = time_in_nanos();
+	bench_op_run(self->gfx, *self->resources, self->pass, self->op, self->iterations);
+	self->elapsed_in_nanos = time_in_nanos() - start;
+}
+
+static Bench_Resources
+bench_resources_new(Renoir* gfx)
+{
+	Bench_Resources self{};
+
+	self.swapchain = gfx->swapchain_new(gfx, 800, 600, nullptr, nullptr);
+
+	Renoir_Program_Desc program_desc{};
+	program_desc.vertex.bytes = "";
+	program_desc.pixel.bytes = "";
+	self.program = gfx->program_new(gfx, program_desc);
+
+	Renoir_Pipeline_Desc pipeline_desc{};
+	pipeline_desc.program = self.program;
+	self.pipeline = gfx->pipeline_new(gfx, pipeline_desc);
+
+	float triangle_data[] = {
+		-1, -1,
+		 1, -1,
+		 0,  1,
+	};
+	Renoir_Buffer_Desc vertices_desc{};
+	vertices_desc.type = RENOIR_BUFFER_VERTEX;
+	vertices_desc.data = triangle_data;
+	vertices_desc.data_size = sizeof(triangle_data);
+	self.vertices = gfx->buffer_new(gfx, vertices_desc);
+
+	Renoir_Buffer_Desc uniforms_desc{};
+	uniforms_desc.type = RENOIR_BUFFER_UNIFORM;
+	uniforms_desc.usage = RENOIR_USAGE_DYNAMIC;
+	uniforms_desc.access = RENOIR_ACCESS_WRITE;
+	uniforms_desc.data_size = 16 * sizeof(float);
+	self.uniforms = gfx->buffer_new(gfx, uniforms_desc);
+
+	Renoir_Texture_Desc texture_desc{};
+	texture_desc.size.width = 64;
+	texture_desc.size.height = 64;
+	texture_desc.pixel_format = RENOIR_PIXELFORMAT_RGBA8;
+	self.texture = gfx->texture_new(gfx, texture_desc);
+
+	return self;
+}
+
+static void
+bench_resources_free(Renoir* gfx, Bench_Resources& self)
+{
+	gfx->texture_free(gfx, self.texture);
+	gfx->buffer_free(gfx, self.uniforms);
+	gfx->buffer_free(gfx, self.vertices);
+	gfx->pipeline_free(gfx, self.pipeline);
+	gfx->program_free(gfx, self.program);
+	gfx->swapchain_free(gfx, self.swapchain);
+}
+
+// runs the op on threads_count recording threads at the same time, each thread records into its own pass
+static bool
+bench_run(FILE* out, bool first, BENCH_OP op, int threads_count, size_t iterations)
+{
+	auto gfx = renoir_null_api();
+
+	Renoir_Settings settings{};
+	bool ok = gfx->init(gfx, settings, nullptr);
+	mn_assert_msg(ok, "gfx init failed");
+	if (ok == false)
+		return false;
+
+	auto resources = bench_resources_new(gfx);
+
+	std::atomic<int> ready{0};
+	std::atomic<bool> go{false};
+
+	Bench_Thread threads[BENCH_THREADS_MAX]{};
+	mn::Thread handles[BENCH_THREADS_MAX]{};
+	for (int i = 0; i < threads_count; ++i)
+	{
+		threads[i].gfx = gfx;
+		threads[i].resources = &resources;
+		threads[i].op = op;
+		threads[i].iterations = iterations;
+		threads[i].pass = gfx->pass_swapchain_new(gfx, resources.swapchain);
+		threads[i].ready = &ready;
+		threads[i].go = &go;
+		handles[i] = mn::thread_new(bench_thread_main, &threads[i], "renoir bench thread");
+	}
+
+	while (ready.load() < threads_count)
+	{}
+	go.store(true);
+
+	uint64_t elapsed_sum = 0, elapsed_max = 0;
+	for (int i = 0; i < threads_count; ++i)
+	{
+		mn::thread_join(handles[i]);
+		mn::thread_free(handles[i]);
+
+		elapsed_sum += threads[i].elapsed_in_nanos;
+		if (threads[i].elapsed_in_nanos > elapsed_max)
+			elapsed_max = threads[i].elapsed_in_nanos;
+	}
+
+	// present ends the frame
+	gfx->swapchain_present(gfx, resources.swapchain);
+
+	for (int i = 0; i < threads_count; ++i)
+		gfx->pass_free(gfx, threads[i].pass);
+	bench_resources_free(gfx, resources);
+	gfx->dispose(gfx);
+
+	// ns_per_call is the average latency of a call on a single thread, while calls_per_second is the throughput of all
+	// the threads together which is limited by the slowest thread
+	auto ns_per_call = double(elapsed_sum) / double(iterations * threads_count);
+	auto calls_per_second = elapsed_max > 0 ? double(iterations * threads_count) * 1e9 / double(elapsed_max) : 0.0;
+
+	fprintf(
+		out,
+		"%s\n\t\t{\"op\": \"%s\", \"threads\": %d, \"iterations\": %zu, \"ns_per_call\": %.3f, \"calls_per_second\": %.0f}",
+		first ? "" : ",",
+		BENCH_OP_NAMES[op],
+		threads_count,
+		iterations,
+		ns_per_call,
+		calls_per_second
+	);
+	fflush(out);
+	return true;
+}
+
+int
+main(int argc, char** argv)
+{
+	size_t iterations = 1000000;
+	const char* out_path = nullptr;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			iterations = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			out_path = argv[++i];
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--iterations N] [--out path]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (iterations == 0)
+	{
+		fprintf(stderr, "iterations should be > 0\n");
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if (out_path != nullptr)
+	{
+		out = fopen(out_path, "wb");
+		if (out == nullptr)
+		{
+			fprintf(stderr, "failed to open '%s'\n", out_path);
+			return 1;
+		}
+	}
+
+	auto gfx = renoir_null_api();
+	fprintf(out, "{\n\t\"backend\": \"%s\",\n\t\"results\": [", gfx->name());
+
+	bool first = true, ok = true;
+	for (int threads_count: BENCH_THREADS)
+	{
+		for (int op = 0; op < BENCH_OP_COUNT && ok; ++op)
+		{
+			ok = bench_run(out, first, BENCH_OP(op), threads_count, iterations);
+			first = false;
+		}
+	}
+
+	fprintf(out, "\n\t]\n}\n");
+
+	if (out != stdout)
+		fclose(out);
+
+	if (ok == false)
+	{
+		fprintf(stderr, "failed to initialize %s\n", gfx->name());
+		return 1;
+	}
+	return 0;
+}
@@ -9,9 +9,16 @@ extern "C" {
 
 typedef enum RENOIR_CONSTANT {
 	RENOIR_CONSTANT_DEFAULT_SAMPLER_CACHE_SIZE = 32,
+	RENOIR_CONSTANT_DEFAULT_FRAMES_IN_FLIGHT = 2,
 	RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE = 10,
 	RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE = 4,
 	RENOIR_CONSTANT_BUFFER_STORAGE_SIZE = 8,
+	// number of frames the profiler keeps in flight before it drops the oldest unfinished frame
+	RENOIR_CONSTANT_PROFILER_FRAME_COUNT = 4,
+	// max number of command kinds counted in Renoir_Frame_Stats
+	RENOIR_CONSTANT_STATS_COMMAND_KIND_SIZE = 64,
+	// events kept per thread by the tracer, the oldest events are overwritten once it's full
+	RENOIR_CONSTANT_TRACE_RING_SIZE = 16384,
 } RENOIR_CONSTANT;
 
 // Enums
@@ -20,6 +27,24 @@ typedef enum RENOIR_CLEAR {
 	RENOIR_CLEAR_DEPTH = 1 << 1
 } RENOIR_CLEAR;
 
+// what happens to the attachment contents when the pass begins
+typedef enum RENOIR_LOAD_ACTION {
+	RENOIR_LOAD_ACTION_LOAD,
+	RENOIR_LOAD_ACTION_CLEAR,
+	// previous contents are not needed, so the driver can skip loading them
+	RENOIR_LOAD_ACTION_DONT_CARE
+} RENOIR_LOAD_ACTION;
+
+// what happens to the attachment contents when the pass ends
+typedef enum RENOIR_STORE_ACTION {
+	// contents are kept and msaa attachments are resolved into their textures
+	RENOIR_STORE_ACTION_RESOLVE,
+	// contents are kept without resolving msaa attachments, use it when a later pass continues rendering into them
+	RENOIR_STORE_ACTION_STORE,
+	// contents are not needed after the pass (e.g. depth buffer), so the driver can skip writing them back
+	RENOIR_STORE_ACTION_DISCARD
+} RENOIR_STORE_ACTION;
+
 typedef enum RENOIR_SHADER {
 	RENOIR_SHADER_NONE,
 	RENOIR_SHADER_VERTEX,
@@ -34,13 +59,19 @@ typedef enum RENOIR_BUFFER {
 	RENOIR_BUFFER_INDEX,
 	RENOIR_BUFFER_UNIFORM,
 	// TODO(Moustapha): rename this to storage buffer
-	RENOIR_BUFFER_COMPUTE
+	RENOIR_BUFFER_COMPUTE,
+	// holds draw arguments (Renoir_Draw_Indirect_Command/Renoir_Draw_Indexed_Indirect_Command) used by draw_indirect
+	// or dispatch arguments (Renoir_Dispatch_Indirect_Command) used by dispatch_indirect, it can be bound using
+	// buffer_compute_bind so compute passes can write the arguments of the later draws/dispatches
+	RENOIR_BUFFER_INDIRECT
 } RENOIR_BUFFER;
 
 typedef enum RENOIR_USAGE {
 	RENOIR_USAGE_NONE,
 	RENOIR_USAGE_STATIC,
-	RENOIR_USAGE_DYNAMIC
+	RENOIR_USAGE_DYNAMIC,
+	// persistently mapped ring buffer, written each frame using buffer_stream_alloc, it's not supported in dx11
+	RENOIR_USAGE_STREAM
 } RENOIR_USAGE;
 
 typedef enum RENOIR_ACCESS {
@@ -50,6 +81,31 @@ typedef enum RENOIR_ACCESS {
 	RENOIR_ACCESS_READ_WRITE
 } RENOIR_ACCESS;
 
+// uses which should see the shader writes done through compute binds before the barrier
+typedef enum RENOIR_BARRIER {
+	RENOIR_BARRIER_NONE = 0,
+	// compute buffers and images bound by later dispatches
+	RENOIR_BARRIER_STORAGE = 1 << 0,
+	// sampled textures
+	RENOIR_BARRIER_TEXTURE = 1 << 1,
+	// vertex and index buffers
+	RENOIR_BARRIER_VERTEX = 1 << 2,
+	RENOIR_BARRIER_UNIFORM = 1 << 3,
+	// indirect draw arguments and counts
+	RENOIR_BARRIER_INDIRECT = 1 << 4,
+	// textures attached to offscreen passes
+	RENOIR_BARRIER_RENDER_TARGET = 1 << 5,
+	// buffer/texture reads and writes, clears and readbacks
+	RENOIR_BARRIER_TRANSFER = 1 << 6,
+	RENOIR_BARRIER_ALL = RENOIR_BARRIER_STORAGE |
+							RENOIR_BARRIER_TEXTURE |
+							RENOIR_BARRIER_VERTEX |
+							RENOIR_BARRIER_UNIFORM |
+							RENOIR_BARRIER_INDIRECT |
+							RENOIR_BARRIER_RENDER_TARGET |
+							RENOIR_BARRIER_TRANSFER
+} RENOIR_BARRIER;
+
 typedef enum RENOIR_PIXELFORMAT {
 	RENOIR_PIXELFORMAT_NONE,
 	RENOIR_PIXELFORMAT_RGBA8,
@@ -201,14 +257,17 @@ typedef enum RENOIR_COLOR_MASK
 } RENOIR_COLOR_MASK;
 
 // Handles
-typedef struct Renoir_Buffer { void* handle; } Renoir_Buffer;
-typedef struct Renoir_Texture { void* handle; } Renoir_Texture;
-typedef struct Renoir_Program { void* handle; } Renoir_Program;
-typedef struct Renoir_Compute { void* handle; } Renoir_Compute;
-typedef struct Renoir_Pass { void* handle; } Renoir_Pass;
-typedef struct Renoir_Swapchain { void* handle; } Renoir_Swapchain;
-typedef struct Renoir_Timer { void* handle; } Renoir_Timer;
-typedef struct Renoir_Pipeline { void* handle; } Renoir_Pipeline;
+// generation is the generation of the handle's slot when it was created, gl450 uses it to catch handles which are
+// used after they're freed, null and dx11 leave it 0 and don't check it
+typedef struct Renoir_Buffer { void* handle; uint32_t generation; } Renoir_Buffer;
+typedef struct Renoir_Texture { void* handle; uint32_t generation; } Renoir_Texture;
+typedef struct Renoir_Program { void* handle; uint32_t generation; } Renoir_Program;
+typedef struct Renoir_Compute { void* handle; uint32_t generation; } Renoir_Compute;
+typedef struct Renoir_Pass { void* handle; uint32_t generation; } Renoir_Pass;
+typedef struct Renoir_Swapchain { void* handle; uint32_t generation; } Renoir_Swapchain;
+typedef struct Renoir_Timer { void* handle; uint32_t generation; } Renoir_Timer;
+typedef struct Renoir_Readback { void* handle; uint32_t generation; } Renoir_Readback;
+typedef struct Renoir_Pipeline { void* handle; uint32_t generation; } Renoir_Pipeline;
 
 
 // Descriptons
@@ -226,10 +285,24 @@ typedef struct Renoir_Color {
 
 typedef struct Renoir_Settings {
 	bool defer_api_calls; // default: false
+	bool merge_draws; // default: false, merges consecutive compatible non instanced draws into a single multi draw call
 	bool external_context; // default: false
 	RENOIR_MSAA_MODE msaa; // default: RENOIR_MSAA_MODE_NONE
 	RENOIR_VSYNC_MODE vsync; // default: RENOIR_VSYNC_MODE_ON
 	int sampler_cache_size; // default: RENOIR_CONSTANT_DEFAULT_SAMPLER_CACHE_SIZE
+	bool profile_passes; // default: false, wraps every submitted pass in a profile scope named after its kind
+	bool render_thread; // default: false, executes the frames on an internal thread which owns the context, implies defer_api_calls
+	int frames_in_flight; // default: RENOIR_CONSTANT_DEFAULT_FRAMES_IN_FLIGHT, frames submitted to the render thread before present blocks
+	bool manual_barriers; // default: false, disables the barriers inserted after compute writes, use barrier to issue them yourself
+	// default: nullptr, existing folder where the linked programs are cached, later runs load them instead of compiling
+	// the shaders, entries are keyed by the shader sources and the driver so driver updates invalidate them
+	const char* program_cache_path;
+	// default: false, program_new/compute_new return without waiting for the shaders to compile, use
+	// program_ready/compute_ready to know when they're usable
+	bool async_programs;
+	// default: false, records the api calls, the command execution, and the gpu work as a timeline, it can be
+	// toggled later using trace_enable, use trace_write to save the latest events
+	bool trace;
 } Renoir_Settings;
 
 typedef struct Renoir_Depth_Desc {
@@ -261,6 +334,9 @@ typedef struct Renoir_Pipeline_Desc {
 	RENOIR_SWITCH independent_blend; // default: RENOIR_SWITCH_DISABLE
 	Renoir_Blend_Desc blend[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE];
 	Renoir_Program program;
+	// default: null, used instead of this pipeline while its program is still compiling (settings.async_programs),
+	// draws are skipped while neither program is ready
+	Renoir_Pipeline fallback;
 } Pipeline_Desc;
 
 typedef struct Renoir_Buffer_Desc {
@@ -272,6 +348,12 @@ typedef struct Renoir_Buffer_Desc {
 	size_t compute_buffer_stride;
 } Renoir_Buffer_Desc;
 
+// transient allocation in a stream buffer, it's valid until the end of the current frame
+typedef struct Renoir_Stream_Alloc {
+	void* ptr; // cpu pointer to write the data into
+	size_t offset; // offset of the allocation in the buffer, use it as the vertex/index/bind offset
+} Renoir_Stream_Alloc;
+
 typedef struct Renoir_Sampler_Desc {
 	RENOIR_FILTER filter; // default: RENOIR_FILTER_LINEAR
 	RENOIR_TEXMODE u; // default: RENOIR_TEXMODE_WRAP
@@ -338,6 +420,43 @@ typedef struct Renoir_Draw_Desc {
 	RENOIR_TYPE index_type; // default: RENOIR_TYPE_UINT16
 } Renoir_Draw_Desc;
 
+// layout of a single draw in the indirect buffer when there's no index buffer
+typedef struct Renoir_Draw_Indirect_Command {
+	uint32_t elements_count;
+	uint32_t instances_count;
+	uint32_t base_element;
+	uint32_t base_instance;
+} Renoir_Draw_Indirect_Command;
+
+// layout of a single draw in the indirect buffer when there's an index buffer
+typedef struct Renoir_Draw_Indexed_Indirect_Command {
+	uint32_t elements_count;
+	uint32_t instances_count;
+	uint32_t base_element;
+	int32_t base_vertex;
+	uint32_t base_instance;
+} Renoir_Draw_Indexed_Indirect_Command;
+
+// layout of the dispatch arguments in the indirect buffer, it's the number of work groups in every dimension
+typedef struct Renoir_Dispatch_Indirect_Command {
+	uint32_t x;
+	uint32_t y;
+	uint32_t z;
+} Renoir_Dispatch_Indirect_Command;
+
+typedef struct Renoir_Draw_Indirect_Desc {
+	RENOIR_PRIMITIVE primitive; // default: RENOIR_PRIMITIVE_TRIANGLES
+	Renoir_Vertex_Desc vertex_buffers[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE];
+	Renoir_Buffer index_buffer;
+	RENOIR_TYPE index_type; // default: RENOIR_TYPE_UINT16
+	Renoir_Buffer indirect_buffer; // should be of type RENOIR_BUFFER_INDIRECT
+	size_t indirect_offset; // offset in bytes of the first draw command, should be a multiple of 4
+	size_t indirect_stride; // default: tightly packed draw commands
+	int draw_count; // number of draws, or the max number of draws in case of draw_indirect_count
+	Renoir_Buffer count_buffer; // only used by draw_indirect_count, holds the uint32_t draw count
+	size_t count_offset; // offset in bytes of the draw count in count_buffer, should be a multiple of 4
+} Renoir_Draw_Indirect_Desc;
+
 typedef struct Renoir_Texture_Edit_Desc {
 	int x, y, z;
 	int width, height, depth;
@@ -351,6 +470,13 @@ typedef struct Renoir_Pass_Attachment {
 	int subresource;
 	// this is used to choose which mip map level you want to be attached to the pass
 	int level;
+	// load/store actions are applied every time the pass is submitted
+	RENOIR_LOAD_ACTION load; // default: RENOIR_LOAD_ACTION_LOAD
+	RENOIR_STORE_ACTION store; // default: RENOIR_STORE_ACTION_RESOLVE
+	// used with RENOIR_LOAD_ACTION_CLEAR, color attachments use clear_color, depth_stencil uses clear_depth and clear_stencil
+	Renoir_Color clear_color;
+	float clear_depth;
+	int clear_stencil;
 } Renoir_Pass_Attachment;
 
 typedef struct Renoir_Pass_Offscreen_Desc {
@@ -361,13 +487,88 @@ typedef struct Renoir_Pass_Offscreen_Desc {
 typedef struct Renoir_Buffer_Storage_Bind_Desc {
 	Renoir_Buffer buffers[RENOIR_CONSTANT_BUFFER_STORAGE_SIZE];
 	int start_slot;
+	// default: 0, should be a multiple of info.storage_buffer_offset_alignment
+	size_t offsets[RENOIR_CONSTANT_BUFFER_STORAGE_SIZE];
+	// default: 0, which binds the rest of the buffer after the offset
+	size_t sizes[RENOIR_CONSTANT_BUFFER_STORAGE_SIZE];
 } Renoir_Buffer_Storage_Bind_Desc;
 
+typedef struct Renoir_Profile_Scope {
+	const char* name;
+	int depth; // nesting level of the scope, top level scopes have depth 0
+	uint64_t elapsed_time_in_nanos;
+} Renoir_Profile_Scope;
+
+// scopes are listed in the order they began, the memory is valid until the next profile_results call
+typedef struct Renoir_Profile_Results {
+	uint64_t frame; // index of the frame the results belong to
+	const Renoir_Profile_Scope* scopes;
+	size_t scopes_count;
+} Renoir_Profile_Results;
+
 typedef struct Renoir_Info {
 	const char* description; // description of the gpu renoir is currently using
 	size_t gpu_memory_in_bytes; // gpu memory size, in case we can't get memory size we set it to 0
+	size_t upload_bytes_last_frame; // bytes uploaded using buffer_write/texture_write in the last frame
+	size_t upload_bytes_high_water; // max upload_bytes_last_frame since init, use it to size the command chunks
+	size_t state_calls_emitted_last_frame; // pipeline state calls issued to the driver in the last frame
+	size_t state_calls_skipped_last_frame; // pipeline state calls skipped in the last frame because the state didn't change
+	size_t sampler_cache_hits; // sampler cache lookups which found a matching sampler since init
+	size_t sampler_cache_misses; // sampler cache lookups which created a new sampler since init
+	size_t sampler_cache_evictions; // samplers evicted since init, increase sampler_cache_size if this keeps growing
+	size_t program_cache_hits; // programs and computes loaded from settings.program_cache_path since init
+	size_t program_cache_misses; // programs and computes compiled because they were not in settings.program_cache_path since init
+	uint64_t program_compile_time_in_nanos; // time spent compiling and linking programs and computes from source since init
+	uint64_t program_load_time_in_nanos; // time spent loading programs and computes from settings.program_cache_path since init
+	size_t uniform_buffer_offset_alignment; // offsets given to buffer_bind_range for uniform buffers should be a multiple of it
+	size_t storage_buffer_offset_alignment; // storage/compute buffer offsets should be a multiple of it, 0 if ranges are not supported
+	bool draw_indirect_count_supported; // whether draw_indirect_count can be used, it's never supported in dx11
 } Renoir_Info;
 
+typedef enum RENOIR_RESOURCE {
+	RENOIR_RESOURCE_SWAPCHAIN,
+	RENOIR_RESOURCE_RASTER_PASS,
+	RENOIR_RESOURCE_COMPUTE_PASS,
+	RENOIR_RESOURCE_BUFFER,
+	RENOIR_RESOURCE_TEXTURE,
+	RENOIR_RESOURCE_SAMPLER,
+	RENOIR_RESOURCE_PROGRAM,
+	RENOIR_RESOURCE_COMPUTE,
+	RENOIR_RESOURCE_PIPELINE,
+	RENOIR_RESOURCE_TIMER,
+	RENOIR_RESOURCE_READBACK,
+	RENOIR_RESOURCE_COUNT
+} RENOIR_RESOURCE;
+
+// live resources, it's always tracked (unlike the leak detection which is debug only), use it to watch the memory
+// growth in long running sessions, bytes are estimated from the buffer and texture descs
+typedef struct Renoir_Resource_Stats {
+	size_t count[RENOIR_RESOURCE_COUNT]; // live resources of each kind, indexed by RENOIR_RESOURCE
+	size_t count_high_water[RENOIR_RESOURCE_COUNT]; // max count of each kind since init
+	size_t buffer_bytes; // bytes of the live buffers
+	size_t buffer_bytes_high_water;
+	size_t texture_bytes; // bytes of the live textures including their mips, cube faces, and msaa samples
+	size_t texture_bytes_high_water;
+} Renoir_Resource_Stats;
+
+// counters of the last executed frame, they're reset and snapshotted with every swapchain_present/flush, renoir
+// should be built with RENOIR_STATS for them to be collected, otherwise they're all zeros
+typedef struct Renoir_Frame_Stats {
+	uint64_t frame; // index of the frame the counters belong to
+	size_t commands_count; // total number of commands executed
+	// commands executed of each kind, indexed by the backend command kind, use frame_stats_command_name to get its name
+	size_t commands[RENOIR_CONSTANT_STATS_COMMAND_KIND_SIZE];
+	size_t draws; // indirect draws count their max draw count
+	size_t dispatches;
+	size_t primitives; // primitives submitted by the direct draws
+	size_t upload_bytes; // bytes uploaded through buffer_write/texture_write
+	size_t pipeline_binds;
+	size_t texture_binds;
+	size_t mtx_locks; // times the api lock was taken by the recording threads
+	uint64_t mtx_wait_time_in_nanos; // time spent waiting to take the api lock
+	uint64_t mtx_hold_time_in_nanos; // time spent holding the api lock
+} Renoir_Frame_Stats;
+
 struct IRenoir;
 
 typedef struct Renoir
@@ -382,6 +583,10 @@ typedef struct Renoir
 	const char* (*name)();
 	RENOIR_TEXTURE_ORIGIN (*texture_origin)();
 	Renoir_Info (*info)(struct Renoir* api);
+	Renoir_Resource_Stats (*resource_stats)(struct Renoir* api);
+	Renoir_Frame_Stats (*frame_stats)(struct Renoir* api);
+	// name of the command kind which indexes Renoir_Frame_Stats::commands, null if there's no such kind
+	const char* (*frame_stats_command_name)(struct Renoir* api, int kind);
 
 	void (*handle_ref)(struct Renoir* api, void* handle);
 	void (*flush)(struct Renoir* api, void* device, void* context);
@@ -394,6 +599,8 @@ typedef struct Renoir
 	Renoir_Buffer (*buffer_new)(struct Renoir* api, Renoir_Buffer_Desc desc);
 	void (*buffer_free)(struct Renoir* api, Renoir_Buffer buffer);
 	size_t (*buffer_size)(struct Renoir* api, Renoir_Buffer buffer);
+	// allocates size bytes from a stream buffer, the memory is reused once the gpu finishes the frame which used it
+	Renoir_Stream_Alloc (*buffer_stream_alloc)(struct Renoir* api, Renoir_Buffer buffer, size_t size, size_t alignment);
 
 	Renoir_Texture (*texture_new)(struct Renoir* api, Renoir_Texture_Desc desc);
 	void (*texture_free)(struct Renoir* api, Renoir_Texture texture);
@@ -403,9 +610,13 @@ typedef struct Renoir
 
 	Renoir_Program (*program_new)(struct Renoir* api, Renoir_Program_Desc desc);
 	void (*program_free)(struct Renoir* api, Renoir_Program program);
+	// returns true once the program is compiled, it never waits, programs are always ready unless settings.async_programs is enabled
+	bool (*program_ready)(struct Renoir* api, Renoir_Program program);
 
 	Renoir_Compute (*compute_new)(struct Renoir* api, Renoir_Compute_Desc desc);
 	void (*compute_free)(struct Renoir* api, Renoir_Compute compute);
+	// returns true once the compute is compiled, dispatches are skipped until then
+	bool (*compute_ready)(struct Renoir* api, Renoir_Compute compute);
 
 	Renoir_Pipeline (*pipeline_new)(struct Renoir* api, Renoir_Pipeline_Desc desc);
 	void (*pipeline_free)(struct Renoir* api, Renoir_Pipeline pipeline);
@@ -413,6 +624,10 @@ typedef struct Renoir
 	Renoir_Pass (*pass_swapchain_new)(struct Renoir* api, Renoir_Swapchain view);
 	Renoir_Pass (*pass_offscreen_new)(struct Renoir* api, Renoir_Pass_Offscreen_Desc desc);
 	Renoir_Pass (*pass_compute_new)(struct Renoir* api);
+	// secondary passes record commands for their parent pass, each pass can be recorded on its own thread
+	// without any locking, then merged into the parent with pass_merge, the order of the merge calls defines
+	// the execution order so the result is deterministic regardless of which thread finished recording first
+	Renoir_Pass (*pass_secondary_new)(struct Renoir* api, Renoir_Pass parent);
 	void (*pass_free)(struct Renoir* api, Renoir_Pass pass);
 	Renoir_Size (*pass_size)(struct Renoir* api, Renoir_Pass pass);
 	Renoir_Pass_Offscreen_Desc (*pass_offscreen_desc)(struct Renoir* api, Renoir_Pass pass);
@@ -423,6 +638,8 @@ typedef struct Renoir
 
 	// Graphics Commands
 	void (*pass_submit)(struct Renoir* api, Renoir_Pass pass);
+	// appends the commands recorded in the secondary pass to the end of the pass, the secondary pass is empty after this call
+	void (*pass_merge)(struct Renoir* api, Renoir_Pass pass, Renoir_Pass secondary);
 	void (*clear)(struct Renoir* api, Renoir_Pass pass, Renoir_Clear_Desc desc);
 	void (*use_pipeline)(struct Renoir* api, Renoir_Pass pass, Renoir_Pipeline pipeline);
 	void (*use_compute)(struct Renoir* api, Renoir_Pass pass, Renoir_Compute compute);
@@ -439,8 +656,24 @@ typedef struct Renoir
 	// Read Functions
 	void (*buffer_read)(struct Renoir* api, Renoir_Buffer buffer, size_t offset, void* bytes, size_t bytes_size);
 	void (*texture_read)(struct Renoir* api, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc);
+	// Async Read Functions
+	// these copy the data into a staging buffer on the gpu without stalling the cpu, they're scheduled on the
+	// global command list, use readback_poll/readback_wait to get the data once the copy is done, they're not
+	// supported in dx11
+	Renoir_Readback (*buffer_read_async)(struct Renoir* api, Renoir_Buffer buffer, size_t offset, size_t bytes_size);
+	// desc.bytes is ignored, desc.bytes_size is the size of the read pixels
+	Renoir_Readback (*texture_read_async)(struct Renoir* api, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc);
+	// returns true and copies the data into bytes if the readback is done, otherwise returns false without blocking
+	bool (*readback_poll)(struct Renoir* api, Renoir_Readback readback, void* bytes, size_t bytes_size);
+	// blocks until the readback is done then copies the data into bytes, with defer_api_calls the readback
+	// command should be submitted with flush/present before waiting on it
+	void (*readback_wait)(struct Renoir* api, Renoir_Readback readback, void* bytes, size_t bytes_size);
+	void (*readback_free)(struct Renoir* api, Renoir_Readback readback);
 	// Bind Functions
 	void (*buffer_bind)(struct Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER shader, int slot);
+	// binds size bytes of the buffer starting at offset, which lets one big uniform buffer hold the constants of many
+	// draws, offset should be a multiple of info.uniform_buffer_offset_alignment
+	void (*buffer_bind_range)(struct Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER shader, int slot, size_t offset, size_t size);
 	// TODO(Moustapha): consider making buffer_bind work like buffer_storage_bind, which means providing all the bindings
 	// at once, if you do that then there will be no need for separate buffer_storage_bind function
 	void (*buffer_storage_bind)(struct Renoir* api, Renoir_Pass pass, Renoir_Buffer_Storage_Bind_Desc desc);
@@ -451,11 +684,35 @@ typedef struct Renoir
 	void (*texture_compute_bind)(struct Renoir* api, Renoir_Pass pass, Renoir_Texture texture, int slot, int mip_level, RENOIR_ACCESS gpu_access);
 	// Draw
 	void (*draw)(struct Renoir* api, Renoir_Pass pass, Renoir_Draw_Desc desc);
+	// issues desc.draw_count draws with the arguments read from the indirect buffer
+	void (*draw_indirect)(struct Renoir* api, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc);
+	// same as draw_indirect but the draw count is read from the count buffer on the gpu, clamped to desc.draw_count,
+	// check info().draw_indirect_count_supported before using it, it's not supported in dx11 since the draw count can't
+	// be read from the gpu there, and gl450 needs ARB_indirect_parameters
+	void (*draw_indirect_count)(struct Renoir* api, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc);
 	// Dispatch
 	void (*dispatch)(struct Renoir* api, Renoir_Pass pass, int x, int y, int z);
+	// same as dispatch but the work group counts are read from the indirect buffer at offset, which should be a multiple of 4
+	void (*dispatch_indirect)(struct Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, size_t offset);
+	// makes the writes of the previous dispatches visible to the given uses (RENOIR_BARRIER flags), the needed barriers
+	// are inserted automatically for the resources written through compute binds unless settings.manual_barriers is enabled
+	void (*barrier)(struct Renoir* api, Renoir_Pass pass, int barriers);
 	// Timer
 	void (*timer_begin)(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer);
 	void (*timer_end)(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer);
+	// Profiler
+	// profile scopes can be nested and can span multiple passes, but they should end in the same frame they began
+	void (*profile_begin)(struct Renoir* api, Renoir_Pass pass, const char* name);
+	void (*profile_end)(struct Renoir* api, Renoir_Pass pass);
+	// gets the results of the latest frame the gpu finished, it never waits for the gpu, returns false if no results are ready
+	bool (*profile_results)(struct Renoir* api, Renoir_Profile_Results* results);
+
+	// Tracer
+	// events are kept in a ring per thread so it's cheap enough to leave on, or enable it for a few sampled frames
+	void (*trace_enable)(struct Renoir* api, bool enabled);
+	// writes the recorded events as chrome trace-event json (chrome://tracing or ui.perfetto.dev), the gpu events are
+	// on their own track, returns false if the backend doesn't support tracing or the file can't be written
+	bool (*trace_write)(struct Renoir* api, const char* path);
 } Renoir;
 
 #define RENOIR_API "renoir"
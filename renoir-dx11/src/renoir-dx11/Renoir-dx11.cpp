@@ -15,10 +15,12 @@
 #include <mn/Assert.h>
 
 #include <atomic>
+#include <chrono>
 #include <math.h>
 #include <stdio.h>
 
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <d3dcommon.h>
 #include <d3dcompiler.h>
 #include <dxgi.h>
@@ -50,6 +52,8 @@ _renoir_buffer_type_to_dx(RENOIR_BUFFER type)
 	case RENOIR_BUFFER_UNIFORM: return D3D11_BIND_CONSTANT_BUFFER;
 	case RENOIR_BUFFER_INDEX: return D3D11_BIND_INDEX_BUFFER;
 	case RENOIR_BUFFER_COMPUTE: return D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+	// indirect args buffers are identified by the misc flag, they have raw views so compute passes can write the arguments
+	case RENOIR_BUFFER_INDIRECT: return D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
 	default: mn_unreachable(); return 0;
 	}
 }
@@ -121,6 +125,29 @@ _renoir_pixelformat_to_size(RENOIR_PIXELFORMAT format)
 	}
 }
 
+// estimated bytes of the texture, it counts all the mip levels, the cube faces, and the msaa textures of the render targets
+inline static size_t
+_renoir_texture_desc_bytes(const Renoir_Texture_Desc& desc)
+{
+	size_t width = desc.size.width > 0 ? desc.size.width : 1;
+	size_t height = desc.size.height > 0 ? desc.size.height : 1;
+	size_t depth = desc.size.depth > 0 ? desc.size.depth : 1;
+	size_t pixel_size = _renoir_pixelformat_to_size(desc.pixel_format);
+	size_t faces = desc.cube_map ? 6 : 1;
+
+	size_t res = 0;
+	int mipmaps = desc.mipmaps > 0 ? desc.mipmaps : 1;
+	for (int i = 0; i < mipmaps; ++i)
+	{
+		res += (width >> i > 0 ? width >> i : 1) * (height >> i > 0 ? height >> i : 1) * (depth >> i > 0 ? depth >> i : 1) * pixel_size;
+	}
+	res *= faces;
+
+	if (desc.render_target && desc.msaa != RENOIR_MSAA_MODE_NONE)
+		res += width * height * pixel_size * size_t(desc.msaa) * faces;
+	return res;
+}
+
 inline static bool
 _renoir_pixelformat_is_depth(RENOIR_PIXELFORMAT format)
 {
@@ -376,6 +403,8 @@ struct Renoir_Handle
 		{
 			Renoir_Command *command_list_head;
 			Renoir_Command *command_list_tail;
+			// used by secondary passes which are merged into their parent
+			Renoir_Handle* parent;
 			// used when rendering is done on screen/window
 			Renoir_Handle* swapchain;
 			// used when rendering is done off screen
@@ -389,6 +418,8 @@ struct Renoir_Handle
 		{
 			Renoir_Command *command_list_head;
 			Renoir_Command *command_list_tail;
+			// used by secondary passes which are merged into their parent
+			Renoir_Handle* parent;
 			// can be buffers or textures
 			mn::Buf<Renoir_Compute_Write_Slot> write_resources;
 		} compute_pass;
@@ -429,6 +460,9 @@ struct Renoir_Handle
 		{
 			ID3D11SamplerState* sampler;
 			Renoir_Sampler_Desc desc;
+			// intrusive lru list of the sampler cache
+			Renoir_Handle* lru_prev;
+			Renoir_Handle* lru_next;
 		} sampler;
 
 		struct
@@ -480,10 +514,43 @@ _renoir_handle_kind_name(RENOIR_HANDLE_KIND kind)
 	case RENOIR_HANDLE_KIND_PROGRAM: return "program";
 	case RENOIR_HANDLE_KIND_COMPUTE: return "compute";
 	case RENOIR_HANDLE_KIND_PIPELINE: return "pipeline";
+	case RENOIR_HANDLE_KIND_TIMER: return "timer";
 	default: mn_unreachable_msg("invalid handle kind"); return "<INVALID>";
 	}
 }
 
+inline static RENOIR_RESOURCE
+_renoir_handle_kind_to_resource(RENOIR_HANDLE_KIND kind)
+{
+	switch(kind)
+	{
+	case RENOIR_HANDLE_KIND_SWAPCHAIN: return RENOIR_RESOURCE_SWAPCHAIN;
+	case RENOIR_HANDLE_KIND_RASTER_PASS: return RENOIR_RESOURCE_RASTER_PASS;
+	case RENOIR_HANDLE_KIND_COMPUTE_PASS: return RENOIR_RESOURCE_COMPUTE_PASS;
+	case RENOIR_HANDLE_KIND_BUFFER: return RENOIR_RESOURCE_BUFFER;
+	case RENOIR_HANDLE_KIND_TEXTURE: return RENOIR_RESOURCE_TEXTURE;
+	case RENOIR_HANDLE_KIND_SAMPLER: return RENOIR_RESOURCE_SAMPLER;
+	case RENOIR_HANDLE_KIND_PROGRAM: return RENOIR_RESOURCE_PROGRAM;
+	case RENOIR_HANDLE_KIND_COMPUTE: return RENOIR_RESOURCE_COMPUTE;
+	case RENOIR_HANDLE_KIND_PIPELINE: return RENOIR_RESOURCE_PIPELINE;
+	case RENOIR_HANDLE_KIND_TIMER: return RENOIR_RESOURCE_TIMER;
+	default: mn_unreachable_msg("invalid handle kind"); return RENOIR_RESOURCE_COUNT;
+	}
+}
+
+inline static size_t
+_renoir_primitive_count(RENOIR_PRIMITIVE p, int elements_count, int instances_count)
+{
+	size_t instances = instances_count > 1 ? instances_count : 1;
+	switch (p)
+	{
+	case RENOIR_PRIMITIVE_POINTS: return elements_count * instances;
+	case RENOIR_PRIMITIVE_LINES: return elements_count / 2 * instances;
+	case RENOIR_PRIMITIVE_TRIANGLES: return elements_count / 3 * instances;
+	default: mn_unreachable(); return 0;
+	}
+}
+
 inline static bool
 _renoir_handle_kind_should_track(RENOIR_HANDLE_KIND kind)
 {
@@ -589,11 +656,69 @@ enum RENOIR_COMMAND_KIND
 	RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND,
 	RENOIR_COMMAND_KIND_TEXTURE_BIND,
 	RENOIR_COMMAND_KIND_DRAW,
+	RENOIR_COMMAND_KIND_DRAW_INDIRECT,
 	RENOIR_COMMAND_KIND_DISPATCH,
+	RENOIR_COMMAND_KIND_DISPATCH_INDIRECT,
 	RENOIR_COMMAND_KIND_TIMER_BEGIN,
 	RENOIR_COMMAND_KIND_TIMER_END,
+	RENOIR_COMMAND_KIND_COUNT,
 };
 
+static_assert(int(RENOIR_COMMAND_KIND_COUNT) <= int(RENOIR_CONSTANT_STATS_COMMAND_KIND_SIZE), "frame stats can't count all the command kinds");
+
+inline static const char*
+_renoir_dx11_command_kind_name(int kind)
+{
+	switch(kind)
+	{
+	case RENOIR_COMMAND_KIND_NONE: return "none";
+	case RENOIR_COMMAND_KIND_INIT: return "init";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_NEW: return "swapchain_new";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_FREE: return "swapchain_free";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_RESIZE: return "swapchain_resize";
+	case RENOIR_COMMAND_KIND_PASS_SWAPCHAIN_NEW: return "pass_swapchain_new";
+	case RENOIR_COMMAND_KIND_PASS_OFFSCREEN_NEW: return "pass_offscreen_new";
+	case RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW: return "pass_compute_new";
+	case RENOIR_COMMAND_KIND_PASS_FREE: return "pass_free";
+	case RENOIR_COMMAND_KIND_BUFFER_NEW: return "buffer_new";
+	case RENOIR_COMMAND_KIND_BUFFER_FREE: return "buffer_free";
+	case RENOIR_COMMAND_KIND_TEXTURE_NEW: return "texture_new";
+	case RENOIR_COMMAND_KIND_TEXTURE_FREE: return "texture_free";
+	case RENOIR_COMMAND_KIND_SAMPLER_NEW: return "sampler_new";
+	case RENOIR_COMMAND_KIND_SAMPLER_FREE: return "sampler_free";
+	case RENOIR_COMMAND_KIND_PROGRAM_NEW: return "program_new";
+	case RENOIR_COMMAND_KIND_PROGRAM_FREE: return "program_free";
+	case RENOIR_COMMAND_KIND_COMPUTE_NEW: return "compute_new";
+	case RENOIR_COMMAND_KIND_COMPUTE_FREE: return "compute_free";
+	case RENOIR_COMMAND_KIND_PIPELINE_NEW: return "pipeline_new";
+	case RENOIR_COMMAND_KIND_PIPELINE_FREE: return "pipeline_free";
+	case RENOIR_COMMAND_KIND_TIMER_NEW: return "timer_new";
+	case RENOIR_COMMAND_KIND_TIMER_FREE: return "timer_free";
+	case RENOIR_COMMAND_KIND_TIMER_ELAPSED: return "timer_elapsed";
+	case RENOIR_COMMAND_KIND_PASS_BEGIN: return "pass_begin";
+	case RENOIR_COMMAND_KIND_PASS_END: return "pass_end";
+	case RENOIR_COMMAND_KIND_PASS_CLEAR: return "pass_clear";
+	case RENOIR_COMMAND_KIND_USE_PIPELINE: return "use_pipeline";
+	case RENOIR_COMMAND_KIND_USE_COMPUTE: return "use_compute";
+	case RENOIR_COMMAND_KIND_SCISSOR: return "scissor";
+	case RENOIR_COMMAND_KIND_BUFFER_CLEAR: return "buffer_clear";
+	case RENOIR_COMMAND_KIND_BUFFER_WRITE: return "buffer_write";
+	case RENOIR_COMMAND_KIND_TEXTURE_WRITE: return "texture_write";
+	case RENOIR_COMMAND_KIND_BUFFER_READ: return "buffer_read";
+	case RENOIR_COMMAND_KIND_TEXTURE_READ: return "texture_read";
+	case RENOIR_COMMAND_KIND_BUFFER_BIND: return "buffer_bind";
+	case RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND: return "buffer_storage_bind";
+	case RENOIR_COMMAND_KIND_TEXTURE_BIND: return "texture_bind";
+	case RENOIR_COMMAND_KIND_DRAW: return "draw";
+	case RENOIR_COMMAND_KIND_DRAW_INDIRECT: return "draw_indirect";
+	case RENOIR_COMMAND_KIND_DISPATCH: return "dispatch";
+	case RENOIR_COMMAND_KIND_DISPATCH_INDIRECT: return "dispatch_indirect";
+	case RENOIR_COMMAND_KIND_TIMER_BEGIN: return "timer_begin";
+	case RENOIR_COMMAND_KIND_TIMER_END: return "timer_end";
+	default: return nullptr;
+	}
+}
+
 struct Renoir_Command
 {
 	Renoir_Command *prev, *next;
@@ -799,6 +924,9 @@ struct Renoir_Command
 			RENOIR_SHADER shader;
 			int slot;
 			RENOIR_ACCESS gpu_access;
+			// both are 0 when the whole buffer is bound
+			size_t offset;
+			size_t size;
 		} buffer_bind;
 
 		struct
@@ -822,11 +950,22 @@ struct Renoir_Command
 			Renoir_Draw_Desc desc;
 		} draw;
 
+		struct
+		{
+			Renoir_Draw_Indirect_Desc desc;
+		} draw_indirect;
+
 		struct
 		{
 			int x, y, z;
 		} dispatch;
 
+		struct
+		{
+			Renoir_Handle* buffer;
+			size_t offset;
+		} dispatch_indirect;
+
 		struct
 		{
 			Renoir_Handle* handle;
@@ -845,6 +984,33 @@ struct Renoir_Leak_Info
 	size_t callstack_size;
 };
 
+inline static bool
+operator==(const Renoir_Sampler_Desc& a, const Renoir_Sampler_Desc& b)
+{
+	return (
+		a.filter == b.filter &&
+		a.u == b.u &&
+		a.v == b.v &&
+		a.w == b.w &&
+		a.compare == b.compare &&
+		a.border.r == b.border.r &&
+		a.border.g == b.border.g &&
+		a.border.b == b.border.b &&
+		a.border.a == b.border.a
+	);
+}
+
+// hashes the fields not the struct bytes so the padding doesn't affect the hash
+struct Renoir_DX11_Sampler_Desc_Hasher
+{
+	inline size_t
+	operator()(const Renoir_Sampler_Desc& desc) const
+	{
+		int32_t modes[5] = {desc.filter, desc.u, desc.v, desc.w, desc.compare};
+		return mn::hash_mix(mn::murmur_hash(modes, sizeof(modes)), mn::murmur_hash(&desc.border, sizeof(desc.border)));
+	}
+};
+
 struct IRenoir
 {
 	mn::Mutex mtx;
@@ -852,7 +1018,11 @@ struct IRenoir
 	IDXGIAdapter* adapter;
 	ID3D11Device* device;
 	ID3D11DeviceContext* context;
+	// 11.1 interface of the context which is needed by constant buffer ranges, it's null if the context doesn't support it
+	ID3D11DeviceContext1* context1;
 	mn::Pool handle_pool;
+	// resource accounting, it's updated with the handles so it's guarded by mtx as well
+	Renoir_Resource_Stats resource_stats;
 	mn::Pool command_pool;
 	Renoir_Settings settings;
 
@@ -876,7 +1046,21 @@ struct IRenoir
 	Renoir_Handle* current_pass;
 
 	// caches
-	mn::Buf<Renoir_Handle*> sampler_cache;
+	// samplers are cached by desc, the lru list is threaded through the sampler handles
+	mn::Map<Renoir_Sampler_Desc, Renoir_Handle*, Renoir_DX11_Sampler_Desc_Hasher> sampler_cache;
+	Renoir_Handle* sampler_lru_head;
+	Renoir_Handle* sampler_lru_tail;
+	size_t sampler_cache_hits;
+	size_t sampler_cache_misses;
+	size_t sampler_cache_evictions;
+
+#if RENOIR_STATS
+	// frame stats, they're guarded by mtx and snapshotted into frame_stats_last by present/flush
+	uint64_t frame_index;
+	uint64_t mtx_locked_time;
+	Renoir_Frame_Stats frame_stats;
+	Renoir_Frame_Stats frame_stats_last;
+#endif
 
 	// leak detection
 	mn::Map<Renoir_Handle*, Renoir_Leak_Info> alive_handles;
@@ -885,6 +1069,84 @@ struct IRenoir
 static void
 _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command);
 
+static uint64_t
+_renoir_dx11_time_in_nanos()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+// queries the 11.1 interface once whenever the context changes instead of on every ranged bind
+static void
+_renoir_dx11_context1_update(IRenoir* self)
+{
+	if (self->context1)
+		self->context1->Release();
+	self->context1 = nullptr;
+
+	if (self->context == nullptr)
+		return;
+
+	auto res = self->context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&self->context1);
+	if (FAILED(res))
+		self->context1 = nullptr;
+}
+
+// api lock, it's timed when the frame stats are enabled
+inline static void
+_renoir_dx11_mtx_lock(IRenoir* self)
+{
+#if RENOIR_STATS
+	auto start_time = _renoir_dx11_time_in_nanos();
+	mn::mutex_lock(self->mtx);
+	self->mtx_locked_time = _renoir_dx11_time_in_nanos();
+	self->frame_stats.mtx_wait_time_in_nanos += self->mtx_locked_time - start_time;
+	++self->frame_stats.mtx_locks;
+#else
+	mn::mutex_lock(self->mtx);
+#endif
+}
+
+inline static void
+_renoir_dx11_mtx_unlock(IRenoir* self)
+{
+#if RENOIR_STATS
+	self->frame_stats.mtx_hold_time_in_nanos += _renoir_dx11_time_in_nanos() - self->mtx_locked_time;
+#endif
+	mn::mutex_unlock(self->mtx);
+}
+
+// called by present/flush under mtx after the frame's commands are executed
+static void
+_renoir_dx11_frame_end(IRenoir* self)
+{
+#if RENOIR_STATS
+	// the hold time of the present/flush lock is counted in the next frame since it's still held
+	self->frame_stats.frame = self->frame_index++;
+	self->frame_stats_last = self->frame_stats;
+	self->frame_stats = Renoir_Frame_Stats{};
+#endif
+}
+
+// buffers and textures add their bytes once their desc is set, the bytes are removed when the handle is freed
+static void
+_renoir_dx11_resource_bytes_add(IRenoir* self, Renoir_Handle* h)
+{
+	auto& stats = self->resource_stats;
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+	{
+		stats.buffer_bytes += h->buffer.size;
+		if (stats.buffer_bytes > stats.buffer_bytes_high_water)
+			stats.buffer_bytes_high_water = stats.buffer_bytes;
+	}
+	else if (h->kind == RENOIR_HANDLE_KIND_TEXTURE)
+	{
+		stats.texture_bytes += _renoir_texture_desc_bytes(h->texture.desc);
+		if (stats.texture_bytes > stats.texture_bytes_high_water)
+			stats.texture_bytes_high_water = stats.texture_bytes;
+	}
+}
+
 static Renoir_Handle*
 _renoir_dx11_handle_new(IRenoir* self, RENOIR_HANDLE_KIND kind)
 {
@@ -893,6 +1155,12 @@ _renoir_dx11_handle_new(IRenoir* self, RENOIR_HANDLE_KIND kind)
 	handle->kind = kind;
 	handle->rc = 1;
 
+	auto& stats = self->resource_stats;
+	auto resource = _renoir_handle_kind_to_resource(kind);
+	++stats.count[resource];
+	if (stats.count[resource] > stats.count_high_water[resource])
+		stats.count_high_water[resource] = stats.count[resource];
+
 	#ifdef DEBUG
 	if (_renoir_handle_kind_should_track(kind))
 	{
@@ -918,6 +1186,13 @@ _renoir_dx11_handle_free(IRenoir* self, Renoir_Handle* h)
 		mn_assert_msg(removed, "free was called with an invalid renoir handle");
 	}
 	#endif
+	auto& stats = self->resource_stats;
+	--stats.count[_renoir_handle_kind_to_resource(h->kind)];
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+		stats.buffer_bytes -= h->buffer.size;
+	else if (h->kind == RENOIR_HANDLE_KIND_TEXTURE)
+		stats.texture_bytes -= _renoir_texture_desc_bytes(h->texture.desc);
+
 	mn::pool_put(self->handle_pool, h);
 }
 
@@ -934,6 +1209,23 @@ _renoir_dx11_handle_unref(Renoir_Handle* h)
 	return h->rc.fetch_sub(1) == 1;
 }
 
+inline static Renoir_Handle*
+_renoir_dx11_pass_parent(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		return h->raster_pass.parent;
+	mn_assert_msg(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS, "invalid pass");
+	return h->compute_pass.parent;
+}
+
+// returns the pass the commands will execute in, which is the parent in case of secondary passes
+inline static Renoir_Handle*
+_renoir_dx11_pass_primary(Renoir_Handle* h)
+{
+	auto parent = _renoir_dx11_pass_parent(h);
+	return parent ? parent : h;
+}
+
 template<typename T>
 static Renoir_Command*
 _renoir_dx11_command_new(T* self, RENOIR_COMMAND_KIND kind)
@@ -1032,7 +1324,9 @@ _renoir_dx11_command_free(T* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND:
 	case RENOIR_COMMAND_KIND_TEXTURE_BIND:
 	case RENOIR_COMMAND_KIND_DRAW:
+	case RENOIR_COMMAND_KIND_DRAW_INDIRECT:
 	case RENOIR_COMMAND_KIND_DISPATCH:
+	case RENOIR_COMMAND_KIND_DISPATCH_INDIRECT:
 	case RENOIR_COMMAND_KIND_TIMER_BEGIN:
 	case RENOIR_COMMAND_KIND_TIMER_END:
 	default:
@@ -1256,30 +1550,14 @@ _renoir_dx11_sampler_free(IRenoir* self, Renoir_Handle* h)
 	_renoir_dx11_command_process(self, command);
 }
 
-inline static bool
-operator==(const Renoir_Sampler_Desc& a, const Renoir_Sampler_Desc& b)
-{
-	return (
-		a.filter == b.filter &&
-		a.u == b.u &&
-		a.v == b.v &&
-		a.w == b.w &&
-		a.compare == b.compare &&
-		a.border.r == b.border.r &&
-		a.border.g == b.border.g &&
-		a.border.b == b.border.b &&
-		a.border.a == b.border.a
-	);
-}
-
 inline static Renoir_Handle*
 _renoir_dx11_pipeline_new(IRenoir* self, Renoir_Pipeline_Desc desc)
 {
 	_renoir_dx11_pipeline_desc_defaults(&desc);
 	auto h_program = (Renoir_Handle*)desc.program.handle;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_PIPELINE);
 	h->pipeline.desc = desc;
@@ -1296,8 +1574,8 @@ _renoir_dx11_pipeline_free(IRenoir* self, Renoir_Handle* pipeline)
 {
 	mn_assert(pipeline != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PIPELINE_FREE);
 	command->pipeline_free.handle = pipeline;
 	_renoir_dx11_command_process(self, command);
@@ -1311,69 +1589,121 @@ _renoir_dx11_pipeline_use(IRenoir* self, Renoir_Handle* h)
 	self->context->RSSetState(h->pipeline.raster_state);
 }
 
-inline static Renoir_Handle*
-_renoir_dx11_sampler_get(IRenoir* self, Renoir_Sampler_Desc desc)
+inline static void
+_renoir_dx11_sampler_lru_remove(IRenoir* self, Renoir_Handle* h)
 {
-	size_t best_ix = self->sampler_cache.count;
-	size_t first_empty_ix = self->sampler_cache.count;
-	for (size_t i = 0; i < self->sampler_cache.count; ++i)
-	{
-		auto hsampler = self->sampler_cache[i];
-		if (hsampler == nullptr)
-		{
-			if (first_empty_ix == self->sampler_cache.count)
-				first_empty_ix = i;
-			continue;
-		}
+	if (h->sampler.lru_prev)
+		h->sampler.lru_prev->sampler.lru_next = h->sampler.lru_next;
+	else
+		self->sampler_lru_head = h->sampler.lru_next;
 
-		if (desc == hsampler->sampler.desc)
-		{
-			best_ix = i;
-			break;
-		}
-	}
+	if (h->sampler.lru_next)
+		h->sampler.lru_next->sampler.lru_prev = h->sampler.lru_prev;
+	else
+		self->sampler_lru_tail = h->sampler.lru_prev;
+
+	h->sampler.lru_prev = nullptr;
+	h->sampler.lru_next = nullptr;
+}
 
-	// we found what we were looking for
-	if (best_ix < self->sampler_cache.count)
+inline static void
+_renoir_dx11_sampler_lru_push_front(IRenoir* self, Renoir_Handle* h)
+{
+	h->sampler.lru_prev = nullptr;
+	h->sampler.lru_next = self->sampler_lru_head;
+	if (self->sampler_lru_head)
+		self->sampler_lru_head->sampler.lru_prev = h;
+	self->sampler_lru_head = h;
+	if (self->sampler_lru_tail == nullptr)
+		self->sampler_lru_tail = h;
+}
+
+inline static Renoir_Handle*
+_renoir_dx11_sampler_get(IRenoir* self, Renoir_Sampler_Desc desc)
+{
+	// we found what we were looking for, so move it to the front of the lru list
+	if (auto it = mn::map_lookup(self->sampler_cache, desc))
 	{
-		auto res = self->sampler_cache[best_ix];
-		// reorder the cache
-		for (size_t i = 0; i < best_ix; ++i)
+		++self->sampler_cache_hits;
+		auto res = it->value;
+		if (self->sampler_lru_head != res)
 		{
-			auto index = best_ix - i - 1;
-			self->sampler_cache[index + 1] = self->sampler_cache[index];
+			_renoir_dx11_sampler_lru_remove(self, res);
+			_renoir_dx11_sampler_lru_push_front(self, res);
 		}
-		self->sampler_cache[0] = res;
 		return res;
 	}
 
-	// we didn't find a matching sampler, so create new one
-	size_t sampler_ix = first_empty_ix;
+	++self->sampler_cache_misses;
 
-	// we didn't find an empty slot for the new sampler so we'll have to make one for it
-	if (sampler_ix == self->sampler_cache.count)
+	// the cache is full, so evict the least recently used sampler
+	if (self->sampler_cache.count >= size_t(self->settings.sampler_cache_size))
 	{
-		auto to_be_evicted = mn::buf_top(self->sampler_cache);
-		for (size_t i = 0; i + 1 < self->sampler_cache.count; ++i)
-		{
-			auto index = self->sampler_cache.count - i - 1;
-			self->sampler_cache[index] = self->sampler_cache[index - 1];
-		}
+		auto to_be_evicted = self->sampler_lru_tail;
+		_renoir_dx11_sampler_lru_remove(self, to_be_evicted);
+		mn::map_remove(self->sampler_cache, to_be_evicted->sampler.desc);
 		_renoir_dx11_sampler_free(self, to_be_evicted);
+		++self->sampler_cache_evictions;
 		mn::log_warning("dx11: sampler evicted");
-		sampler_ix = 0;
 	}
 
 	// create the new sampler and put it at the head of the cache
 	auto sampler = _renoir_dx11_sampler_new(self, desc);
-	self->sampler_cache[sampler_ix] = sampler;
+	mn::map_insert(self->sampler_cache, desc, sampler);
+	_renoir_dx11_sampler_lru_push_front(self, sampler);
 	return sampler;
 }
 
 
+static void
+_renoir_dx11_input_assembler_set(IRenoir* self, Renoir_Draw_Desc& desc)
+{
+	auto hprogram = self->current_pipeline->pipeline.program;
+	if (hprogram->program.input_layout == nullptr)
+		_renoir_dx11_input_layout_create(self, hprogram, desc);
+
+	self->context->IASetInputLayout(hprogram->program.input_layout);
+	switch(desc.primitive)
+	{
+	case RENOIR_PRIMITIVE_POINTS:
+		self->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
+		break;
+	case RENOIR_PRIMITIVE_LINES:
+		self->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+		break;
+	case RENOIR_PRIMITIVE_TRIANGLES:
+		self->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		break;
+	default:
+		mn_unreachable();
+		break;
+	}
+
+	for (size_t i = 0; i < RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE; ++i)
+	{
+		auto& vertex_buffer = desc.vertex_buffers[i];
+		if (vertex_buffer.buffer.handle == nullptr)
+			continue;
+
+		// calculate the default stride for the vertex buffer
+		if (vertex_buffer.stride == 0)
+			vertex_buffer.stride = _renoir_type_to_size(vertex_buffer.type);
+
+		auto hbuffer = (Renoir_Handle*)vertex_buffer.buffer.handle;
+		UINT offset = vertex_buffer.offset;
+		UINT stride = vertex_buffer.stride;
+		self->context->IASetVertexBuffers(i, 1, &hbuffer->buffer.buffer, &stride, &offset);
+	}
+}
+
 static void
 _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 {
+#if RENOIR_STATS
+	++self->frame_stats.commands_count;
+	++self->frame_stats.commands[command->kind];
+#endif
+
 	switch(command->kind)
 	{
 	case RENOIR_COMMAND_KIND_INIT:
@@ -1685,6 +2015,15 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 			mn::buf_free(h->compute_pass.write_resources);
 		}
 
+		// secondary passes hold a reference to their parent
+		if (auto parent = _renoir_dx11_pass_parent(h))
+		{
+			auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PASS_FREE);
+			command->pass_free.handle = parent;
+			_renoir_dx11_command_execute(self, command);
+			_renoir_dx11_command_free(self, command);
+		}
+
 		_renoir_dx11_handle_free(self, h);
 		break;
 	}
@@ -1717,6 +2056,11 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 			buffer_desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
 			buffer_desc.StructureByteStride = desc.compute_buffer_stride;
 		}
+		else if (desc.type == RENOIR_BUFFER_INDIRECT)
+		{
+			mn_assert_msg(desc.data_size % 4 == 0, "indirect buffer size should be a multiple of 4");
+			buffer_desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS | D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+		}
 
 		if (desc.data)
 		{
@@ -1747,6 +2091,24 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 			res = self->device->CreateUnorderedAccessView(h->buffer.buffer, &uav_desc, &h->buffer.uav);
 			mn_assert(SUCCEEDED(res));
 		}
+		else if (desc.type == RENOIR_BUFFER_INDIRECT)
+		{
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc{};
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+			srv_desc.Format = DXGI_FORMAT_R32_TYPELESS;
+			srv_desc.BufferEx.NumElements = buffer_desc.ByteWidth / 4;
+			srv_desc.BufferEx.Flags = D3D11_BUFFEREX_SRV_FLAG_RAW;
+			auto res = self->device->CreateShaderResourceView(h->buffer.buffer, &srv_desc, &h->buffer.srv);
+			mn_assert(SUCCEEDED(res));
+
+			D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc{};
+			uav_desc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+			uav_desc.Format = DXGI_FORMAT_R32_TYPELESS;
+			uav_desc.Buffer.NumElements = buffer_desc.ByteWidth / 4;
+			uav_desc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+			res = self->device->CreateUnorderedAccessView(h->buffer.buffer, &uav_desc, &h->buffer.uav);
+			mn_assert(SUCCEEDED(res));
+		}
 
 		if (desc.access != RENOIR_ACCESS_NONE)
 		{
@@ -2464,6 +2826,24 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 			else
 			{
 				self->context->OMSetRenderTargets(RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE, h->raster_pass.render_target_view, h->raster_pass.depth_stencil_view);
+
+				// dx11.0 has no way to discard views, so only the clear load action is applied
+				auto& offscreen = h->raster_pass.offscreen;
+				for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+				{
+					if (h->raster_pass.render_target_view[i] && offscreen.color[i].load == RENOIR_LOAD_ACTION_CLEAR)
+						self->context->ClearRenderTargetView(h->raster_pass.render_target_view[i], &offscreen.color[i].clear_color.r);
+				}
+				if (h->raster_pass.depth_stencil_view && offscreen.depth_stencil.load == RENOIR_LOAD_ACTION_CLEAR)
+				{
+					self->context->ClearDepthStencilView(
+						h->raster_pass.depth_stencil_view,
+						D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL,
+						offscreen.depth_stencil.clear_depth,
+						offscreen.depth_stencil.clear_stencil
+					);
+				}
+
 				D3D11_VIEWPORT viewport{};
 				viewport.Width = h->raster_pass.width;
 				viewport.Height = h->raster_pass.height;
@@ -2508,8 +2888,9 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 				if (color == nullptr)
 					continue;
 
-				// only resolve msaa textures
-				if (color->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+				// only resolve msaa textures which requested it
+				if (color->texture.desc.msaa != RENOIR_MSAA_MODE_NONE &&
+					h->raster_pass.offscreen.color[i].store == RENOIR_STORE_ACTION_RESOLVE)
 				{
 					auto dx_pixel_format = _renoir_pixelformat_to_dx(color->texture.desc.pixel_format);
 					self->context->ResolveSubresource(
@@ -2559,7 +2940,8 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 			auto depth = (Renoir_Handle*)h->raster_pass.offscreen.depth_stencil.texture.handle;
 			if (depth)
 			{
-				if (depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+				if (depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE &&
+					h->raster_pass.offscreen.depth_stencil.store == RENOIR_STORE_ACTION_RESOLVE)
 				{
 					mn_assert(depth->texture.uavs.count > 0);
 					mn_assert(depth->texture.render_depth_buffer_srv != nullptr);
@@ -2722,6 +3104,9 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 	}
 	case RENOIR_COMMAND_KIND_USE_PIPELINE:
 	{
+#if RENOIR_STATS
+		++self->frame_stats.pipeline_binds;
+#endif
 		self->current_pipeline = command->use_pipeline.pipeline;
 		_renoir_dx11_pipeline_use(self, self->current_pipeline);
 
@@ -2765,6 +3150,9 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_BUFFER_WRITE:
 	{
 		auto h = command->buffer_write.handle;
+#if RENOIR_STATS
+		self->frame_stats.upload_bytes += command->buffer_write.bytes_size;
+#endif
 
 		mn_assert(h->buffer.access == RENOIR_ACCESS_WRITE || h->buffer.access == RENOIR_ACCESS_READ_WRITE);
 
@@ -2799,6 +3187,9 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 	{
 		auto h = command->texture_write.handle;
 		auto& desc = command->texture_write.desc;
+#if RENOIR_STATS
+		self->frame_stats.upload_bytes += desc.bytes_size;
+#endif
 
 		auto dx_pixel_size = _renoir_pixelformat_to_size(h->texture.desc.pixel_format);
 
@@ -3015,7 +3406,34 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 	{
 		auto h = command->buffer_bind.handle;
 
-		if (h->buffer.type == RENOIR_BUFFER_UNIFORM)
+		if (h->buffer.type == RENOIR_BUFFER_UNIFORM && command->buffer_bind.size != 0)
+		{
+			// constant buffer ranges need the 11.1 context, they're in 16 byte constants and a multiple of 16 constants
+			auto context1 = self->context1;
+			mn_assert_msg(context1 != nullptr, "buffer_bind_range needs a Direct3D 11.1 device context");
+
+			auto first_constant = UINT(command->buffer_bind.offset / 16);
+			auto constants_count = UINT((command->buffer_bind.size + 255) / 256 * 16);
+			switch(command->buffer_bind.shader)
+			{
+			case RENOIR_SHADER_VERTEX:
+				context1->VSSetConstantBuffers1(command->buffer_bind.slot, 1, &h->buffer.buffer, &first_constant, &constants_count);
+				break;
+			case RENOIR_SHADER_PIXEL:
+				context1->PSSetConstantBuffers1(command->buffer_bind.slot, 1, &h->buffer.buffer, &first_constant, &constants_count);
+				break;
+			case RENOIR_SHADER_GEOMETRY:
+				context1->GSSetConstantBuffers1(command->buffer_bind.slot, 1, &h->buffer.buffer, &first_constant, &constants_count);
+				break;
+			case RENOIR_SHADER_COMPUTE:
+				context1->CSSetConstantBuffers1(command->buffer_bind.slot, 1, &h->buffer.buffer, &first_constant, &constants_count);
+				break;
+			default:
+				mn_unreachable();
+				break;
+			}
+		}
+		else if (h->buffer.type == RENOIR_BUFFER_UNIFORM)
 		{
 			switch(command->buffer_bind.shader)
 			{
@@ -3036,7 +3454,7 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 				break;
 			}
 		}
-		else if (h->buffer.type == RENOIR_BUFFER_COMPUTE)
+		else if (h->buffer.type == RENOIR_BUFFER_COMPUTE || h->buffer.type == RENOIR_BUFFER_INDIRECT)
 		{
 			if (command->buffer_bind.gpu_access == RENOIR_ACCESS_READ)
 			{
@@ -3085,6 +3503,9 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_TEXTURE_BIND:
 	{
 		auto h = command->texture_bind.handle;
+#if RENOIR_STATS
+		++self->frame_stats.texture_binds;
+#endif
 		switch(command->texture_bind.shader)
 		{
 		case RENOIR_SHADER_VERTEX:
@@ -3134,42 +3555,11 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 		mn_assert_msg(self->current_pipeline, "you should use a program and a pipeline before drawing");
 
 		auto& desc = command->draw.desc;
-		auto hprogram = self->current_pipeline->pipeline.program;
-		if (hprogram->program.input_layout == nullptr)
-			_renoir_dx11_input_layout_create(self, hprogram, desc);
-
-		self->context->IASetInputLayout(hprogram->program.input_layout);
-		switch(desc.primitive)
-		{
-		case RENOIR_PRIMITIVE_POINTS:
-			self->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
-			break;
-		case RENOIR_PRIMITIVE_LINES:
-			self->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-			break;
-		case RENOIR_PRIMITIVE_TRIANGLES:
-			self->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-			break;
-		default:
-			mn_unreachable();
-			break;
-		}
-
-		for (size_t i = 0; i < RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE; ++i)
-		{
-			auto& vertex_buffer = desc.vertex_buffers[i];
-			if (vertex_buffer.buffer.handle == nullptr)
-				continue;
-
-			// calculate the default stride for the vertex buffer
-			if (vertex_buffer.stride == 0)
-				vertex_buffer.stride = _renoir_type_to_size(vertex_buffer.type);
-
-			auto hbuffer = (Renoir_Handle*)vertex_buffer.buffer.handle;
-			UINT offset = vertex_buffer.offset;
-			UINT stride = vertex_buffer.stride;
-			self->context->IASetVertexBuffers(i, 1, &hbuffer->buffer.buffer, &stride, &offset);
-		}
+#if RENOIR_STATS
+		++self->frame_stats.draws;
+		self->frame_stats.primitives += _renoir_primitive_count(desc.primitive, desc.elements_count, desc.instances_count);
+#endif
+		_renoir_dx11_input_assembler_set(self, desc);
 
 		if (desc.index_buffer.handle != nullptr)
 		{
@@ -3218,12 +3608,72 @@ _renoir_dx11_command_execute(IRenoir* self, Renoir_Command* command)
 		}
 		break;
 	}
+	case RENOIR_COMMAND_KIND_DRAW_INDIRECT:
+	{
+		mn_assert_msg(self->current_pipeline, "you should use a program and a pipeline before drawing");
+
+		auto& desc = command->draw_indirect.desc;
+#if RENOIR_STATS
+		self->frame_stats.draws += desc.draw_count;
+#endif
+
+		// dx11 has no multi draw, so we issue one indirect draw per command in the indirect buffer
+		Renoir_Draw_Desc draw{};
+		draw.primitive = desc.primitive;
+		::memcpy(draw.vertex_buffers, desc.vertex_buffers, sizeof(draw.vertex_buffers));
+		_renoir_dx11_input_assembler_set(self, draw);
+
+		auto hindirect = (Renoir_Handle*)desc.indirect_buffer.handle;
+		if (desc.index_buffer.handle != nullptr)
+		{
+			if (desc.index_type == RENOIR_TYPE_NONE)
+				desc.index_type = RENOIR_TYPE_UINT16;
+
+			auto hbuffer = (Renoir_Handle*)desc.index_buffer.handle;
+			self->context->IASetIndexBuffer(hbuffer->buffer.buffer, _renoir_type_to_dx(desc.index_type), 0);
+
+			auto stride = desc.indirect_stride ? desc.indirect_stride : sizeof(Renoir_Draw_Indexed_Indirect_Command);
+			for (int i = 0; i < desc.draw_count; ++i)
+				self->context->DrawIndexedInstancedIndirect(hindirect->buffer.buffer, UINT(desc.indirect_offset + i * stride));
+		}
+		else
+		{
+			auto stride = desc.indirect_stride ? desc.indirect_stride : sizeof(Renoir_Draw_Indirect_Command);
+			for (int i = 0; i < desc.draw_count; ++i)
+				self->context->DrawInstancedIndirect(hindirect->buffer.buffer, UINT(desc.indirect_offset + i * stride));
+		}
+		break;
+	}
 	case RENOIR_COMMAND_KIND_DISPATCH:
 	{
 		mn_assert_msg(self->current_compute, "you should use a compute before dispatching it");
+#if RENOIR_STATS
+		++self->frame_stats.dispatches;
+#endif
 		self->context->Dispatch(command->dispatch.x, command->dispatch.y, command->dispatch.z);
 		break;
 	}
+	case RENOIR_COMMAND_KIND_DISPATCH_INDIRECT:
+	{
+		mn_assert_msg(self->current_compute, "you should use a compute before dispatching it");
+#if RENOIR_STATS
+		++self->frame_stats.dispatches;
+#endif
+		auto h = command->dispatch_indirect.buffer;
+
+		// the arguments can't be read while the buffer is still bound for writing in this pass
+		for (auto [hres, slot]: self->current_pass->compute_pass.write_resources)
+		{
+			if (hres == h)
+			{
+				ID3D11UnorderedAccessView* null_uav = nullptr;
+				self->context->CSSetUnorderedAccessViews(slot, 1, &null_uav, nullptr);
+			}
+		}
+
+		self->context->DispatchIndirect(h->buffer.buffer, UINT(command->dispatch_indirect.offset));
+		break;
+	}
 	case RENOIR_COMMAND_KIND_TIMER_BEGIN:
 	{
 		auto h = command->timer_begin.handle;
@@ -3293,6 +3743,12 @@ _renoir_dx11_handle_leak_free(IRenoir* self, Renoir_Command* command)
 		{
 			mn::buf_free(h->compute_pass.write_resources);
 		}
+		if (auto parent = _renoir_dx11_pass_parent(h))
+		{
+			auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PASS_FREE);
+			command->pass_free.handle = parent;
+			_renoir_dx11_handle_leak_free(self, command);
+		}
 		_renoir_dx11_handle_free(self, h);
 		break;
 	}
@@ -3374,6 +3830,12 @@ _renoir_dx11_init(Renoir* api, Renoir_Settings settings, void*)
 	if (settings.sampler_cache_size <= 0)
 		settings.sampler_cache_size = RENOIR_CONSTANT_DEFAULT_SAMPLER_CACHE_SIZE;
 
+	if (settings.render_thread)
+	{
+		mn::log_warning("dx11: render thread is not supported, frames are executed by the thread which calls present");
+		settings.render_thread = false;
+	}
+
 	IDXGIFactory* factory = nullptr;
 	IDXGIAdapter* adapter = nullptr;
 	ID3D11Device* device = nullptr;
@@ -3429,13 +3891,13 @@ _renoir_dx11_init(Renoir* api, Renoir_Settings settings, void*)
 	self->adapter = adapter; adapter = nullptr;
 	self->device = device; device = nullptr;
 	self->context = context; context = nullptr;
+	_renoir_dx11_context1_update(self);
 	self->handle_pool = mn::pool_new(sizeof(Renoir_Handle), 128);
 	self->command_pool = mn::pool_new(sizeof(Renoir_Command), 128);
 	self->settings = settings;
 	self->info_description = mn::str_new();
-	self->sampler_cache = mn::buf_new<Renoir_Handle*>();
+	self->sampler_cache = mn::map_new<Renoir_Sampler_Desc, Renoir_Handle*, Renoir_DX11_Sampler_Desc_Hasher>();
 	self->alive_handles = mn::map_new<Renoir_Handle*, Renoir_Leak_Info>();
-	mn::buf_resize_fill(self->sampler_cache, self->settings.sampler_cache_size, nullptr);
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_INIT);
 	_renoir_dx11_command_process(self, command);
@@ -3472,6 +3934,8 @@ _renoir_dx11_dispose(Renoir* api)
 			::fprintf(stderr, "renoir leak count: %zu, for callstack turn on 'RENOIR_LEAK' flag\n", self->alive_handles.count);
 	#endif
 	mn::mutex_free(self->mtx);
+	if (self->context1)
+		self->context1->Release();
 	if (self->settings.external_context == false)
 	{
 		self->factory->Release();
@@ -3482,7 +3946,7 @@ _renoir_dx11_dispose(Renoir* api)
 	mn::pool_free(self->handle_pool);
 	mn::pool_free(self->command_pool);
 	mn::str_free(self->info_description);
-	mn::buf_free(self->sampler_cache);
+	mn::map_free(self->sampler_cache);
 	mn::map_free(self->alive_handles);
 	mn::free(self);
 }
@@ -3507,9 +3971,48 @@ _renoir_dx11_info(Renoir* api)
 	Renoir_Info res{};
 	res.description = self->info_description.ptr;
 	res.gpu_memory_in_bytes = self->gpu_memory_in_bytes;
+
+	_renoir_dx11_mtx_lock(self);
+	res.sampler_cache_hits = self->sampler_cache_hits;
+	res.sampler_cache_misses = self->sampler_cache_misses;
+	res.sampler_cache_evictions = self->sampler_cache_evictions;
+	_renoir_dx11_mtx_unlock(self);
+	res.uniform_buffer_offset_alignment = 256;
+	res.storage_buffer_offset_alignment = 0;
+	res.draw_indirect_count_supported = false;
 	return res;
 }
 
+static Renoir_Resource_Stats
+_renoir_dx11_resource_stats(Renoir* api)
+{
+	auto self = api->ctx;
+
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
+	return self->resource_stats;
+}
+
+static Renoir_Frame_Stats
+_renoir_dx11_frame_stats(Renoir* api)
+{
+#if RENOIR_STATS
+	auto self = api->ctx;
+
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
+	return self->frame_stats_last;
+#else
+	return Renoir_Frame_Stats{};
+#endif
+}
+
+static const char*
+_renoir_dx11_frame_stats_command_name(Renoir*, int kind)
+{
+	return _renoir_dx11_command_kind_name(kind);
+}
+
 static void
 _renoir_dx11_handle_ref(Renoir* api, void* handle)
 {
@@ -3522,11 +4025,15 @@ _renoir_dx11_flush(Renoir* api, void* device, void* context)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	self->device = (ID3D11Device*)device;
-	self->context = (ID3D11DeviceContext*)context;
+	if (self->context != (ID3D11DeviceContext*)context)
+	{
+		self->context = (ID3D11DeviceContext*)context;
+		_renoir_dx11_context1_update(self);
+	}
 
 	// process commands
 	for(auto it = self->command_list_head; it != nullptr; it = it->next)
@@ -3537,6 +4044,8 @@ _renoir_dx11_flush(Renoir* api, void* device, void* context)
 
 	self->command_list_head = nullptr;
 	self->command_list_tail = nullptr;
+
+	_renoir_dx11_frame_end(self);
 }
 
 static Renoir_Swapchain
@@ -3544,8 +4053,8 @@ _renoir_dx11_swapchain_new(Renoir* api, int width, int height, void* window, voi
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_SWAPCHAIN);
 	h->swapchain.width = width;
@@ -3565,8 +4074,8 @@ _renoir_dx11_swapchain_free(Renoir* api, Renoir_Swapchain swapchain)
 	auto h = (Renoir_Handle*)swapchain.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_SWAPCHAIN_FREE);
 	command->swapchain_free.handle = h;
@@ -3580,8 +4089,8 @@ _renoir_dx11_swapchain_resize(Renoir* api, Renoir_Swapchain swapchain, int width
 	auto h = (Renoir_Handle*)swapchain.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_SWAPCHAIN_RESIZE);
 	command->swapchain_resize.handle = h;
@@ -3597,8 +4106,8 @@ _renoir_dx11_swapchain_present(Renoir* api, Renoir_Swapchain swapchain)
 	auto h = (Renoir_Handle*)swapchain.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	// process commands
 	for(auto it = self->command_list_head; it != nullptr; it = it->next)
@@ -3610,6 +4119,8 @@ _renoir_dx11_swapchain_present(Renoir* api, Renoir_Swapchain swapchain)
 	self->command_list_head = nullptr;
 	self->command_list_tail = nullptr;
 
+	_renoir_dx11_frame_end(self);
+
 	if (self->settings.vsync == RENOIR_VSYNC_MODE_ON)
 		h->swapchain.swapchain->Present(1, 0);
 	else
@@ -3632,16 +4143,22 @@ _renoir_dx11_buffer_new(Renoir* api, Renoir_Buffer_Desc desc)
 		mn_unreachable_msg("uniform buffers should be aligned to 16 bytes");
 	}
 
+	if (desc.usage == RENOIR_USAGE_STREAM)
+	{
+		mn_unreachable_msg("dx11 doesn't support stream buffers");
+	}
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_BUFFER);
 	h->buffer.type = desc.type;
 	h->buffer.usage = desc.usage;
 	h->buffer.access = desc.access;
 	h->buffer.size = desc.data_size;
+	_renoir_dx11_resource_bytes_add(self, h);
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_NEW);
 	command->buffer_new.handle = h;
@@ -3666,8 +4183,8 @@ _renoir_dx11_buffer_free(Renoir* api, Renoir_Buffer buffer)
 	auto h = (Renoir_Handle*)buffer.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_FREE);
 	command->buffer_free.handle = h;
 	_renoir_dx11_command_process(self, command);
@@ -3683,6 +4200,13 @@ _renoir_dx11_buffer_size(Renoir* api, Renoir_Buffer buffer)
 	return h->buffer.size;
 }
 
+static Renoir_Stream_Alloc
+_renoir_dx11_buffer_stream_alloc(Renoir*, Renoir_Buffer, size_t, size_t)
+{
+	mn_unreachable_msg("dx11 doesn't support stream buffers, use dynamic buffers with buffer_write instead");
+	return Renoir_Stream_Alloc{};
+}
+
 static Renoir_Texture
 _renoir_dx11_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 {
@@ -3711,13 +4235,14 @@ _renoir_dx11_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_TEXTURE);
 	h->texture.desc = desc;
 	::memset(h->texture.desc.data, 0, sizeof(h->texture.desc.data));
 	h->texture.desc.data_size = 0;
+	_renoir_dx11_resource_bytes_add(self, h);
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_NEW);
 	command->texture_new.handle = h;
@@ -3745,8 +4270,8 @@ _renoir_dx11_texture_free(Renoir* api, Renoir_Texture texture)
 	auto h = (Renoir_Handle*)texture.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
 	command->texture_free.handle = h;
 	_renoir_dx11_command_process(self, command);
@@ -3796,8 +4321,8 @@ _renoir_dx11_program_new(Renoir* api, Renoir_Program_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_PROGRAM);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_NEW);
@@ -3830,14 +4355,24 @@ _renoir_dx11_program_free(Renoir* api, Renoir_Program program)
 	auto h = (Renoir_Handle*)program.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_FREE);
 	command->program_free.handle = h;
 	_renoir_dx11_command_process(self, command);
 }
 
+// dx11 backend compiles the shaders in program_new/compute_new, so the programs are always ready
+static bool
+_renoir_dx11_program_ready(Renoir* api, Renoir_Program program)
+{
+	auto h = (Renoir_Handle*)program.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_PROGRAM);
+	return true;
+}
+
 static Renoir_Compute
 _renoir_dx11_compute_new(Renoir* api, Renoir_Compute_Desc desc)
 {
@@ -3847,8 +4382,8 @@ _renoir_dx11_compute_new(Renoir* api, Renoir_Compute_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_COMPUTE);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_COMPUTE_NEW);
@@ -3872,14 +4407,23 @@ _renoir_dx11_compute_free(Renoir* api, Renoir_Compute compute)
 	auto h = (Renoir_Handle*)compute.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_COMPUTE_FREE);
 	command->compute_free.handle = h;
 	_renoir_dx11_command_process(self, command);
 }
 
+static bool
+_renoir_dx11_compute_ready(Renoir* api, Renoir_Compute compute)
+{
+	auto h = (Renoir_Handle*)compute.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE);
+	return true;
+}
+
 static Renoir_Pipeline
 _renoir_dx11_pipeline_new(Renoir* api, Renoir_Pipeline_Desc desc)
 {
@@ -3889,9 +4433,11 @@ _renoir_dx11_pipeline_new(Renoir* api, Renoir_Pipeline_Desc desc)
 	auto h_program = (Renoir_Handle*)desc.program.handle;
 	mn_assert(h_program);
 	mn_assert(h_program->kind == RENOIR_HANDLE_KIND_PROGRAM);
+	auto h_fallback = (Renoir_Handle*)desc.fallback.handle;
+	mn_assert(h_fallback == nullptr || h_fallback->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_PIPELINE);
 	h->pipeline.desc = desc;
@@ -3912,8 +4458,8 @@ _renoir_dx11_pipeline_free(Renoir* api, Renoir_Pipeline pipeline)
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PIPELINE_FREE);
 	command->pipeline_free.handle = h;
@@ -3925,8 +4471,8 @@ _renoir_dx11_pass_swapchain_new(Renoir* api, Renoir_Swapchain swapchain)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_RASTER_PASS);
 	h->raster_pass.swapchain = (Renoir_Handle*)swapchain.handle;
@@ -3979,8 +4525,8 @@ _renoir_dx11_pass_offscreen_new(Renoir* api, Renoir_Pass_Offscreen_Desc desc)
 		}
 	}
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_RASTER_PASS);
 	h->raster_pass.offscreen = desc;
@@ -3999,8 +4545,8 @@ _renoir_dx11_pass_compute_new(Renoir* api)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_COMPUTE_PASS);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW);
@@ -4009,13 +4555,34 @@ _renoir_dx11_pass_compute_new(Renoir* api)
 	return Renoir_Pass{h};
 }
 
+static Renoir_Pass
+_renoir_dx11_pass_secondary_new(Renoir* api, Renoir_Pass parent)
+{
+	auto self = api->ctx;
+	auto hparent = (Renoir_Handle*)parent.handle;
+	mn_assert(hparent != nullptr);
+	mn_assert_msg(_renoir_dx11_pass_parent(hparent) == nullptr, "secondary passes can't be nested");
+
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
+
+	// secondary passes only record commands which will be merged into the parent pass
+	auto h = _renoir_dx11_handle_new(self, hparent->kind);
+	_renoir_dx11_handle_ref(hparent);
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		h->raster_pass.parent = hparent;
+	else
+		h->compute_pass.parent = hparent;
+	return Renoir_Pass{h};
+}
+
 static void
 _renoir_dx11_pass_free(Renoir* api, Renoir_Pass pass)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = (Renoir_Handle*)pass.handle;
 	mn_assert(h != nullptr);
@@ -4061,8 +4628,8 @@ _renoir_dx11_timer_new(Renoir* api)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto h = _renoir_dx11_handle_new(self, RENOIR_HANDLE_KIND_TIMER);
 
@@ -4079,8 +4646,8 @@ _renoir_dx11_timer_free(struct Renoir* api, Renoir_Timer timer)
 	auto h = (Renoir_Handle*)timer.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TIMER_FREE);
 	command->timer_free.handle = h;
@@ -4103,10 +4670,10 @@ _renoir_dx11_timer_elapsed(struct Renoir* api, Renoir_Timer timer, uint64_t* ela
 	}
 	else if (h->timer.state == RENOIR_TIMER_STATE_END)
 	{
-		mn::mutex_lock(self->mtx);
+		_renoir_dx11_mtx_lock(self);
 		auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TIMER_ELAPSED);
 		h->timer.state = RENOIR_TIMER_STATE_READ_SCHEDULED;
-		mn::mutex_unlock(self->mtx);
+		_renoir_dx11_mtx_unlock(self);
 
 		command->timer_elapsed.handle = h;
 		_renoir_dx11_command_process(self, command);
@@ -4124,12 +4691,13 @@ _renoir_dx11_pass_submit(Renoir* api, Renoir_Pass pass)
 	auto self = api->ctx;
 	auto h = (Renoir_Handle*)pass.handle;
 	mn_assert(h != nullptr);
+	mn_assert_msg(_renoir_dx11_pass_parent(h) == nullptr, "secondary passes are merged into their parent, not submitted");
 
 	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
 	{
 		if (h->raster_pass.command_list_head != nullptr)
 		{
-			mn::mutex_lock(self->mtx);
+			_renoir_dx11_mtx_lock(self);
 
 			// push the pass begin command
 			{
@@ -4173,7 +4741,7 @@ _renoir_dx11_pass_submit(Renoir* api, Renoir_Pass pass)
 			h->raster_pass.command_list_head = nullptr;
 			h->raster_pass.command_list_tail = nullptr;
 
-			mn::mutex_unlock(self->mtx);
+			_renoir_dx11_mtx_unlock(self);
 		}
 		h->raster_pass.command_list_head = nullptr;
 		h->raster_pass.command_list_tail = nullptr;
@@ -4182,7 +4750,7 @@ _renoir_dx11_pass_submit(Renoir* api, Renoir_Pass pass)
 	{
 		if (h->compute_pass.command_list_head != nullptr)
 		{
-			mn::mutex_lock(self->mtx);
+			_renoir_dx11_mtx_lock(self);
 
 			// push the pass begin command
 			{
@@ -4222,7 +4790,7 @@ _renoir_dx11_pass_submit(Renoir* api, Renoir_Pass pass)
 				}
 			}
 
-			mn::mutex_unlock(self->mtx);
+			_renoir_dx11_mtx_unlock(self);
 		}
 		h->compute_pass.command_list_head = nullptr;
 		h->compute_pass.command_list_tail = nullptr;
@@ -4233,6 +4801,44 @@ _renoir_dx11_pass_submit(Renoir* api, Renoir_Pass pass)
 	}
 }
 
+template<typename T>
+inline static void
+_renoir_dx11_command_list_append(T* self, T* other)
+{
+	if (other->command_list_head == nullptr)
+		return;
+
+	if (self->command_list_tail == nullptr)
+	{
+		self->command_list_head = other->command_list_head;
+	}
+	else
+	{
+		self->command_list_tail->next = other->command_list_head;
+		other->command_list_head->prev = self->command_list_tail;
+	}
+	self->command_list_tail = other->command_list_tail;
+
+	other->command_list_head = nullptr;
+	other->command_list_tail = nullptr;
+}
+
+static void
+_renoir_dx11_pass_merge(Renoir* api, Renoir_Pass pass, Renoir_Pass secondary)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	auto hsecondary = (Renoir_Handle*)secondary.handle;
+	mn_assert(hsecondary != nullptr);
+	mn_assert_msg(_renoir_dx11_pass_parent(hsecondary) == h, "secondary pass can only be merged into its parent");
+
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		_renoir_dx11_command_list_append(&h->raster_pass, &hsecondary->raster_pass);
+	else
+		_renoir_dx11_command_list_append(&h->compute_pass, &hsecondary->compute_pass);
+}
+
 static void
 _renoir_dx11_clear(Renoir* api, Renoir_Pass pass, Renoir_Clear_Desc desc)
 {
@@ -4245,9 +4851,9 @@ _renoir_dx11_clear(Renoir* api, Renoir_Pass pass, Renoir_Clear_Desc desc)
 	if (desc.independent_clear_color == RENOIR_SWITCH_DEFAULT)
 		desc.independent_clear_color = RENOIR_SWITCH_DISABLE;
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_PASS_CLEAR);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->pass_clear.desc = desc;
 	_renoir_dx11_command_push_back(&h->raster_pass, command);
@@ -4264,9 +4870,9 @@ _renoir_dx11_use_pipeline(Renoir* api, Renoir_Pass pass, Renoir_Pipeline pipelin
 	auto h_pipeline = (Renoir_Handle*)pipeline.handle;
 	mn_assert(h_pipeline->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_USE_PIPELINE);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->use_pipeline.pipeline = h_pipeline;
 	_renoir_dx11_command_push_back(&h->raster_pass, command);
@@ -4281,9 +4887,9 @@ _renoir_dx11_use_compute(Renoir* api, Renoir_Pass pass, Renoir_Compute compute)
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_USE_COMPUTE);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->use_compute.compute = (Renoir_Handle*)compute.handle;
 	_renoir_dx11_command_push_back(&h->compute_pass, command);
@@ -4298,9 +4904,9 @@ _renoir_dx11_scissor(Renoir* api, Renoir_Pass pass, int x, int y, int width, int
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_SCISSOR);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->scissor.x = x;
 	command->scissor.y = y;
@@ -4318,8 +4924,8 @@ _renoir_dx11_buffer_zero_global(Renoir* api, Renoir_Buffer buffer)
 
 	mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_CLEAR);
 	command->buffer_clear.handle = hbuffer;
@@ -4343,9 +4949,9 @@ _renoir_dx11_buffer_zero(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer)
 		mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
 		mn_assert(hbuffer->buffer.uav);
 
-		mn::mutex_lock(self->mtx);
+		_renoir_dx11_mtx_lock(self);
 		auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_CLEAR);
-		mn::mutex_unlock(self->mtx);
+		_renoir_dx11_mtx_unlock(self);
 
 		command->buffer_clear.handle = hbuffer;
 
@@ -4373,8 +4979,8 @@ _renoir_dx11_buffer_write_global(Renoir* api, Renoir_Buffer buffer, size_t offse
 
 	mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_WRITE);
 	command->buffer_write.handle = hbuffer;
@@ -4405,9 +5011,9 @@ _renoir_dx11_buffer_write(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, s
 
 		mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
 
-		mn::mutex_lock(self->mtx);
+		_renoir_dx11_mtx_lock(self);
 		auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_WRITE);
-		mn::mutex_unlock(self->mtx);
+		_renoir_dx11_mtx_unlock(self);
 
 		command->buffer_write.handle = hbuffer;
 		command->buffer_write.offset = offset;
@@ -4438,8 +5044,8 @@ _renoir_dx11_texture_write_global(Renoir* api, Renoir_Texture texture, Renoir_Te
 	auto htexture = (Renoir_Handle*)texture.handle;
 	mn_assert(htexture->texture.desc.usage != RENOIR_USAGE_STATIC);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_dx11_mtx_lock(self);
+	mn_defer{_renoir_dx11_mtx_unlock(self);};
 
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_WRITE);
 	command->texture_write.handle = htexture;
@@ -4467,9 +5073,9 @@ _renoir_dx11_texture_write(Renoir* api, Renoir_Pass pass, Renoir_Texture texture
 		auto htexture = (Renoir_Handle*)texture.handle;
 		mn_assert(htexture->texture.desc.usage != RENOIR_USAGE_STATIC);
 
-		mn::mutex_lock(self->mtx);
+		_renoir_dx11_mtx_lock(self);
 		auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_WRITE);
-		mn::mutex_unlock(self->mtx);
+		_renoir_dx11_mtx_unlock(self);
 
 		command->texture_write.handle = htexture;
 		command->texture_write.desc = desc;
@@ -4516,9 +5122,9 @@ _renoir_dx11_buffer_read(Renoir* api, Renoir_Buffer buffer, size_t offset, void*
 	command.buffer_read.bytes = bytes;
 	command.buffer_read.bytes_size = bytes_size;
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	_renoir_dx11_command_execute(self, &command);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 }
 
 static void
@@ -4544,9 +5150,43 @@ _renoir_dx11_texture_read(Renoir* api, Renoir_Texture texture, Renoir_Texture_Ed
 	command.texture_read.handle = h;
 	command.texture_read.desc = desc;
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	_renoir_dx11_command_execute(self, &command);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
+}
+
+// async readbacks are not supported in dx11, use buffer_read/texture_read instead
+static Renoir_Readback
+_renoir_dx11_buffer_read_async(Renoir*, Renoir_Buffer, size_t, size_t)
+{
+	mn_unreachable_msg("dx11 doesn't support async readback, use buffer_read instead");
+	return Renoir_Readback{};
+}
+
+static Renoir_Readback
+_renoir_dx11_texture_read_async(Renoir*, Renoir_Texture, Renoir_Texture_Edit_Desc)
+{
+	mn_unreachable_msg("dx11 doesn't support async readback, use texture_read instead");
+	return Renoir_Readback{};
+}
+
+static bool
+_renoir_dx11_readback_poll(Renoir*, Renoir_Readback, void*, size_t)
+{
+	mn_unreachable_msg("dx11 doesn't support async readback");
+	return false;
+}
+
+static void
+_renoir_dx11_readback_wait(Renoir*, Renoir_Readback, void*, size_t)
+{
+	mn_unreachable_msg("dx11 doesn't support async readback");
+}
+
+static void
+_renoir_dx11_readback_free(Renoir*, Renoir_Readback)
+{
+	mn_unreachable_msg("dx11 doesn't support async readback");
 }
 
 static void
@@ -4558,9 +5198,9 @@ _renoir_dx11_buffer_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RE
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->buffer_bind.handle = (Renoir_Handle*)buffer.handle;
 	command->buffer_bind.shader = shader;
@@ -4570,6 +5210,37 @@ _renoir_dx11_buffer_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RE
 	_renoir_dx11_command_push_back(&h->raster_pass, command);
 }
 
+static void
+_renoir_dx11_buffer_bind_range(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER shader, int slot, size_t offset, size_t size)
+{
+	auto self = api->ctx;
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	mn_assert(hbuffer != nullptr);
+	mn_assert_msg(hbuffer->buffer.type == RENOIR_BUFFER_UNIFORM, "dx11 only supports binding ranges of uniform buffers");
+	mn_assert_msg(size > 0, "buffer bind range should not be empty");
+	mn_assert_msg(offset % 256 == 0, "buffer bind offset should be a multiple of the buffer offset alignment");
+	// external contexts are only known after the first flush
+	mn_assert_msg(self->context == nullptr || self->context1 != nullptr, "buffer_bind_range needs a Direct3D 11.1 device context");
+
+	_renoir_dx11_mtx_lock(self);
+	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_BIND);
+	_renoir_dx11_mtx_unlock(self);
+
+	command->buffer_bind.handle = hbuffer;
+	command->buffer_bind.shader = shader;
+	command->buffer_bind.slot = slot;
+	command->buffer_bind.gpu_access = RENOIR_ACCESS_NONE;
+	command->buffer_bind.offset = offset;
+	command->buffer_bind.size = size;
+
+	_renoir_dx11_command_push_back(&h->raster_pass, command);
+}
+
 static void
 _renoir_dx11_buffer_storage_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer_Storage_Bind_Desc desc)
 {
@@ -4579,12 +5250,14 @@ _renoir_dx11_buffer_storage_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer_St
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
+	// secondary passes render into their parent's targets
+	auto primary = _renoir_dx11_pass_primary(h);
 	size_t render_target_count = 0;
-	if (h->raster_pass.swapchain)
+	if (primary->raster_pass.swapchain)
 	{
 		render_target_count = 1;
 	}
@@ -4592,7 +5265,7 @@ _renoir_dx11_buffer_storage_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer_St
 	{
 		for (size_t i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
 		{
-			auto texture = h->raster_pass.offscreen.color[i].texture;
+			auto texture = primary->raster_pass.offscreen.color[i].texture;
 			if (texture.handle == nullptr)
 				continue;
 			++render_target_count;
@@ -4607,6 +5280,8 @@ _renoir_dx11_buffer_storage_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer_St
 		if (desc.buffers[i].handle)
 		{
 			mn_assert(h->buffer.uav);
+			// the uavs are created with the buffer so they always view the whole buffer
+			mn_assert_msg(desc.offsets[i] == 0 && desc.sizes[i] == 0, "dx11 doesn't support storage buffer ranges");
 			command->buffer_storage_bind.handle[i] = h;
 		}
 	}
@@ -4625,10 +5300,10 @@ _renoir_dx11_texture_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture texture,
 	auto htex = (Renoir_Handle*)texture.handle;
 	mn_assert(htex != nullptr);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto hsampler = _renoir_dx11_sampler_get(self, htex->texture.desc.sampler);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->texture_bind.handle = htex;
 	command->texture_bind.shader = shader;
@@ -4648,10 +5323,10 @@ _renoir_dx11_texture_sampler_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture
 	auto htex = (Renoir_Handle*)texture.handle;
 	mn_assert(htex != nullptr);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto hsampler = _renoir_dx11_sampler_get(self, sampler);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->texture_bind.handle = htex;
 	command->texture_bind.shader = shader;
@@ -4674,9 +5349,9 @@ _renoir_dx11_buffer_compute_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer bu
 		"gpu should read, write, or both, it has no meaning to bind a buffer that the GPU cannot read or write from"
 	);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_BUFFER_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->buffer_bind.handle = (Renoir_Handle*)buffer.handle;
 	command->buffer_bind.shader = RENOIR_SHADER_COMPUTE;
@@ -4706,9 +5381,9 @@ _renoir_dx11_texture_compute_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture
 
 	auto htex = (Renoir_Handle*)texture.handle;
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->texture_bind.handle = htex;
 	command->texture_bind.shader = RENOIR_SHADER_COMPUTE;
@@ -4728,15 +5403,43 @@ _renoir_dx11_draw(Renoir* api, Renoir_Pass pass, Renoir_Draw_Desc desc)
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_DRAW);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->draw.desc = desc;
 
 	_renoir_dx11_command_push_back(&h->raster_pass, command);
 }
 
+static void
+_renoir_dx11_draw_indirect(Renoir* api, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc)
+{
+	auto self = api->ctx;
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	auto hindirect = (Renoir_Handle*)desc.indirect_buffer.handle;
+	mn_assert(hindirect != nullptr && hindirect->buffer.type == RENOIR_BUFFER_INDIRECT);
+	mn_assert_msg(desc.indirect_offset % 4 == 0, "indirect offset should be a multiple of 4");
+
+	_renoir_dx11_mtx_lock(self);
+	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_DRAW_INDIRECT);
+	_renoir_dx11_mtx_unlock(self);
+
+	command->draw_indirect.desc = desc;
+
+	_renoir_dx11_command_push_back(&h->raster_pass, command);
+}
+
+static void
+_renoir_dx11_draw_indirect_count(Renoir*, Renoir_Pass, Renoir_Draw_Indirect_Desc)
+{
+	mn_unreachable_msg("dx11 doesn't support draw_indirect_count, the draw count can't be read from the gpu");
+}
+
 static void
 _renoir_dx11_dispatch(Renoir* api, Renoir_Pass pass, int x, int y, int z)
 {
@@ -4748,9 +5451,9 @@ _renoir_dx11_dispatch(Renoir* api, Renoir_Pass pass, int x, int y, int z)
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_DISPATCH);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->dispatch.x = x;
 	command->dispatch.y = y;
@@ -4759,6 +5462,41 @@ _renoir_dx11_dispatch(Renoir* api, Renoir_Pass pass, int x, int y, int z)
 	_renoir_dx11_command_push_back(&h->compute_pass, command);
 }
 
+static void
+_renoir_dx11_dispatch_indirect(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, size_t offset)
+{
+	auto self = api->ctx;
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+
+	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	mn_assert(hbuffer != nullptr && hbuffer->buffer.type == RENOIR_BUFFER_INDIRECT);
+	mn_assert_msg(offset % 4 == 0, "indirect offset should be a multiple of 4");
+	mn_assert_msg(offset + sizeof(Renoir_Dispatch_Indirect_Command) <= hbuffer->buffer.size, "indirect offset out of range");
+
+	_renoir_dx11_mtx_lock(self);
+	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_DISPATCH_INDIRECT);
+	_renoir_dx11_mtx_unlock(self);
+
+	command->dispatch_indirect.buffer = hbuffer;
+	command->dispatch_indirect.offset = offset;
+
+	_renoir_dx11_command_push_back(&h->compute_pass, command);
+}
+
+// d3d11 tracks the hazards between unordered access views and their later uses itself, so there's nothing to issue
+static void
+_renoir_dx11_barrier(Renoir*, Renoir_Pass pass, int barriers)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS ||
+			  h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+	mn_assert_msg((barriers & ~RENOIR_BARRIER_ALL) == 0, "invalid barrier flags");
+}
+
 static void
 _renoir_dx11_timer_begin(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer)
 {
@@ -4772,9 +5510,9 @@ _renoir_dx11_timer_begin(struct Renoir* api, Renoir_Pass pass, Renoir_Timer time
 	if(htimer->timer.state != RENOIR_TIMER_STATE_NONE)
 		return;
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TIMER_BEGIN);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->timer_begin.handle = htimer;
 	htimer->timer.state = RENOIR_TIMER_STATE_BEGIN;
@@ -4805,9 +5543,9 @@ _renoir_dx11_timer_end(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer)
 	if (htimer->timer.state != RENOIR_TIMER_STATE_BEGIN)
 		return;
 
-	mn::mutex_lock(self->mtx);
+	_renoir_dx11_mtx_lock(self);
 	auto command = _renoir_dx11_command_new(self, RENOIR_COMMAND_KIND_TIMER_END);
-	mn::mutex_unlock(self->mtx);
+	_renoir_dx11_mtx_unlock(self);
 
 	command->timer_end.handle = htimer;
 	htimer->timer.state = RENOIR_TIMER_STATE_END;
@@ -4826,6 +5564,40 @@ _renoir_dx11_timer_end(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer)
 	}
 }
 
+// the profiler is not implemented in dx11 yet, scopes are ignored and no results are ever ready
+static void
+_renoir_dx11_profile_begin(struct Renoir*, Renoir_Pass pass, const char* name)
+{
+	mn_assert(pass.handle != nullptr);
+	mn_assert(name != nullptr);
+}
+
+static void
+_renoir_dx11_profile_end(struct Renoir*, Renoir_Pass pass)
+{
+	mn_assert(pass.handle != nullptr);
+}
+
+static bool
+_renoir_dx11_profile_results(struct Renoir*, Renoir_Profile_Results* results)
+{
+	mn_assert(results != nullptr);
+	return false;
+}
+
+static void
+_renoir_dx11_trace_enable(Renoir*, bool)
+{
+	// tracing is not supported
+}
+
+static bool
+_renoir_dx11_trace_write(Renoir*, const char*)
+{
+	mn::log_error("dx11: tracing is not supported");
+	return false;
+}
+
 
 inline static void
 _renoir_load_api(Renoir* api)
@@ -4838,6 +5610,9 @@ _renoir_load_api(Renoir* api)
 	api->name = _renoir_dx11_name;
 	api->texture_origin = _renoir_dx11_texture_origin;
 	api->info = _renoir_dx11_info;
+	api->resource_stats = _renoir_dx11_resource_stats;
+	api->frame_stats = _renoir_dx11_frame_stats;
+	api->frame_stats_command_name = _renoir_dx11_frame_stats_command_name;
 
 	api->handle_ref = _renoir_dx11_handle_ref;
 	api->flush = _renoir_dx11_flush;
@@ -4850,6 +5625,7 @@ _renoir_load_api(Renoir* api)
 	api->buffer_new = _renoir_dx11_buffer_new;
 	api->buffer_free = _renoir_dx11_buffer_free;
 	api->buffer_size = _renoir_dx11_buffer_size;
+	api->buffer_stream_alloc = _renoir_dx11_buffer_stream_alloc;
 
 	api->texture_new = _renoir_dx11_texture_new;
 	api->texture_free = _renoir_dx11_texture_free;
@@ -4859,9 +5635,11 @@ _renoir_load_api(Renoir* api)
 
 	api->program_new = _renoir_dx11_program_new;
 	api->program_free = _renoir_dx11_program_free;
+	api->program_ready = _renoir_dx11_program_ready;
 
 	api->compute_new = _renoir_dx11_compute_new;
 	api->compute_free = _renoir_dx11_compute_free;
+	api->compute_ready = _renoir_dx11_compute_ready;
 
 	api->pipeline_new = _renoir_dx11_pipeline_new;
 	api->pipeline_free = _renoir_dx11_pipeline_free;
@@ -4869,6 +5647,7 @@ _renoir_load_api(Renoir* api)
 	api->pass_swapchain_new = _renoir_dx11_pass_swapchain_new;
 	api->pass_offscreen_new = _renoir_dx11_pass_offscreen_new;
 	api->pass_compute_new = _renoir_dx11_pass_compute_new;
+	api->pass_secondary_new = _renoir_dx11_pass_secondary_new;
 	api->pass_free = _renoir_dx11_pass_free;
 	api->pass_size = _renoir_dx11_pass_size;
 	api->pass_offscreen_desc = _renoir_dx11_pass_offscreen_desc;
@@ -4878,6 +5657,7 @@ _renoir_load_api(Renoir* api)
 	api->timer_elapsed = _renoir_dx11_timer_elapsed;
 
 	api->pass_submit = _renoir_dx11_pass_submit;
+	api->pass_merge = _renoir_dx11_pass_merge;
 	api->clear = _renoir_dx11_clear;
 	api->use_pipeline = _renoir_dx11_use_pipeline;
 	api->use_compute = _renoir_dx11_use_compute;
@@ -4887,16 +5667,31 @@ _renoir_load_api(Renoir* api)
 	api->texture_write = _renoir_dx11_texture_write;
 	api->buffer_read = _renoir_dx11_buffer_read;
 	api->texture_read = _renoir_dx11_texture_read;
+	api->buffer_read_async = _renoir_dx11_buffer_read_async;
+	api->texture_read_async = _renoir_dx11_texture_read_async;
+	api->readback_poll = _renoir_dx11_readback_poll;
+	api->readback_wait = _renoir_dx11_readback_wait;
+	api->readback_free = _renoir_dx11_readback_free;
 	api->buffer_bind = _renoir_dx11_buffer_bind;
+	api->buffer_bind_range = _renoir_dx11_buffer_bind_range;
 	api->buffer_storage_bind = _renoir_dx11_buffer_storage_bind;
 	api->texture_bind = _renoir_dx11_texture_bind;
 	api->texture_sampler_bind = _renoir_dx11_texture_sampler_bind;
 	api->texture_compute_bind = _renoir_dx11_texture_compute_bind;
 	api->buffer_compute_bind = _renoir_dx11_buffer_compute_bind;
 	api->draw = _renoir_dx11_draw;
+	api->draw_indirect = _renoir_dx11_draw_indirect;
+	api->draw_indirect_count = _renoir_dx11_draw_indirect_count;
 	api->dispatch = _renoir_dx11_dispatch;
+	api->dispatch_indirect = _renoir_dx11_dispatch_indirect;
+	api->barrier = _renoir_dx11_barrier;
 	api->timer_begin = _renoir_dx11_timer_begin;
 	api->timer_end = _renoir_dx11_timer_end;
+	api->profile_begin = _renoir_dx11_profile_begin;
+	api->profile_end = _renoir_dx11_profile_end;
+	api->profile_results = _renoir_dx11_profile_results;
+	api->trace_enable = _renoir_dx11_trace_enable;
+	api->trace_write = _renoir_dx11_trace_write;
 }
 
 extern "C" Renoir*
@@ -12,6 +12,11 @@ renoir_gl450_context_new(Renoir_Settings* settings, void* display);
 void
 renoir_gl450_context_free(Renoir_GL450_Context* self);
 
+// creates a context which shares the objects of the given context, it's used to compile programs on a worker
+// thread, bind it using renoir_gl450_context_bind and free it using renoir_gl450_context_free
+Renoir_GL450_Context*
+renoir_gl450_context_worker_new(Renoir_GL450_Context* self);
+
 void
 renoir_gl450_context_window_init(Renoir_GL450_Context* self, Renoir_Handle* h, Renoir_Settings* settings);
 
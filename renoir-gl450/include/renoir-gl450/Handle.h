@@ -6,7 +6,48 @@
 
 #include <GL/glew.h>
 
-struct Renoir_Command;
+struct Renoir_Command_Chunk;
+struct Renoir_Command_Allocator;
+struct Renoir_Handle;
+
+// commands are packed back to back (kind, size, then payload) into a linked list of chunks
+struct Renoir_Command_Stream
+{
+	Renoir_Command_Chunk* head;
+	Renoir_Command_Chunk* tail;
+};
+
+// every pass owns its command allocator so recording into different passes takes no global lock
+struct Renoir_Pass_Recorder
+{
+	Renoir_Command_Stream commands;
+	Renoir_Command_Allocator* allocator;
+	// secondary passes are recorded on other threads then merged into their parent pass
+	Renoir_Handle* parent;
+};
+
+struct Renoir_GL450_Blend_State
+{
+	GLboolean enabled;
+	GLenum src_rgb, dst_rgb;
+	GLenum src_alpha, dst_alpha;
+	GLenum eq_rgb, eq_alpha;
+	GLboolean color_mask[4];
+};
+
+// pipeline desc translated to gl values once at creation time, the executor diffs it against the current gl state
+struct Renoir_GL450_Pipeline_State
+{
+	GLboolean cull;
+	GLenum cull_face;
+	GLenum front_face;
+	GLboolean scissor;
+	GLboolean depth;
+	GLboolean depth_write_mask;
+	GLboolean independent_blend;
+	Renoir_GL450_Blend_State blend[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE];
+	GLuint program;
+};
 
 enum RENOIR_TIMER_STATE
 {
@@ -22,6 +63,14 @@ enum RENOIR_TIMER_STATE
 	RENOIR_TIMER_STATE_READY,
 };
 
+// shaders of a program which is being compiled in the background, see settings.async_programs
+struct Renoir_GL450_Program_Build
+{
+	GLuint shaders[3];
+	uint64_t cache_key;
+	uint64_t start_time;
+};
+
 enum RENOIR_HANDLE_KIND
 {
 	RENOIR_HANDLE_KIND_NONE,
@@ -35,12 +84,17 @@ enum RENOIR_HANDLE_KIND
 	RENOIR_HANDLE_KIND_COMPUTE,
 	RENOIR_HANDLE_KIND_PIPELINE,
 	RENOIR_HANDLE_KIND_TIMER,
+	RENOIR_HANDLE_KIND_READBACK,
+	RENOIR_HANDLE_KIND_COUNT,
 };
 
 struct Renoir_Handle
 {
 	RENOIR_HANDLE_KIND kind;
 	std::atomic<int> rc;
+	// incremented every time the handle is freed, it survives the reuse of the handle so stale handles can be detected
+	std::atomic<uint32_t> generation;
+	// handles are allocated with only the size of their kind's member, so never touch the members of other kinds
 	union
 	{
 		struct
@@ -54,8 +108,7 @@ struct Renoir_Handle
 
 		struct
 		{
-			Renoir_Command *command_list_head;
-			Renoir_Command *command_list_tail;
+			Renoir_Pass_Recorder recorder;
 			// used when rendering is done on screen/window
 			Renoir_Handle* swapchain;
 			// used when rendering is done off screen
@@ -66,8 +119,7 @@ struct Renoir_Handle
 
 		struct
 		{
-			Renoir_Command *command_list_head;
-			Renoir_Command *command_list_tail;
+			Renoir_Pass_Recorder recorder;
 		} compute_pass;
 
 		struct
@@ -77,6 +129,13 @@ struct Renoir_Handle
 			RENOIR_USAGE usage;
 			RENOIR_ACCESS access;
 			size_t size;
+			// stream buffers are persistently mapped and sub-allocated as a ring
+			uint8_t* stream_ptr;
+			size_t stream_head;
+			size_t stream_frame_begin;
+			size_t stream_frame_size;
+			// barrier bits still needed by the uses of the buffer after the last compute write, executor only
+			GLbitfield barrier_bits;
 		} buffer;
 
 		struct
@@ -84,28 +143,41 @@ struct Renoir_Handle
 			GLuint id;
 			GLuint render_buffer[6];
 			Renoir_Texture_Desc desc;
+			// barrier bits still needed by the uses of the texture after the last compute write, executor only
+			GLbitfield barrier_bits;
 		} texture;
 
 		struct
 		{
 			GLuint id;
 			Renoir_Sampler_Desc desc;
+			// intrusive lru list of the sampler cache
+			Renoir_Handle* lru_prev;
+			Renoir_Handle* lru_next;
 		} sampler;
 
 		struct
 		{
 			GLuint id;
+			Renoir_GL450_Program_Build build;
+			// set once the program is compiled and linked
+			std::atomic<bool> ready;
 		} program;
 
 		struct
 		{
 			GLuint id;
+			Renoir_GL450_Program_Build build;
+			std::atomic<bool> ready;
 		} compute;
 
 		struct
 		{
 			Renoir_Pipeline_Desc desc;
 			Renoir_Handle* program;
+			// used while the program is not ready
+			Renoir_Handle* fallback;
+			Renoir_GL450_Pipeline_State state;
 		} pipeline;
 
 		struct
@@ -114,5 +186,16 @@ struct Renoir_Handle
 			uint64_t elapsed_time_in_nanos;
 			RENOIR_TIMER_STATE state;
 		} timer;
+
+		struct
+		{
+			// the data is copied into the staging buffer on the gpu, the fence signals when the copy is done
+			GLuint staging;
+			GLsync fence;
+			size_t size;
+			// the executor copies the staging buffer here once the fence signals, then sets ready
+			void* data;
+			std::atomic<bool> ready;
+		} readback;
 	};
 };
@@ -13,6 +13,10 @@
 #include <mn/Debug.h>
 #include <mn/Assert.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include <GL/glew.h>
 
 #include <math.h>
@@ -243,6 +247,9 @@ _renoir_buffer_type_to_gl(RENOIR_BUFFER type)
 	case RENOIR_BUFFER_COMPUTE:
 		res = GL_SHADER_STORAGE_BUFFER;
 		break;
+	case RENOIR_BUFFER_INDIRECT:
+		res = GL_DRAW_INDIRECT_BUFFER;
+		break;
 	default:
 		mn_unreachable();
 		break;
@@ -721,6 +728,19 @@ _renoir_primitive_to_gl(RENOIR_PRIMITIVE p)
 	return res;
 }
 
+inline static size_t
+_renoir_primitive_count(RENOIR_PRIMITIVE p, int elements_count, int instances_count)
+{
+	size_t instances = instances_count > 1 ? instances_count : 1;
+	switch (p)
+	{
+	case RENOIR_PRIMITIVE_POINTS: return elements_count * instances;
+	case RENOIR_PRIMITIVE_LINES: return elements_count / 2 * instances;
+	case RENOIR_PRIMITIVE_TRIANGLES: return elements_count / 3 * instances;
+	default: mn_unreachable(); return 0;
+	}
+}
+
 inline static GLenum
 _renoir_access_to_gl(RENOIR_ACCESS a)
 {
@@ -743,6 +763,52 @@ _renoir_access_to_gl(RENOIR_ACCESS a)
 	return res;
 }
 
+inline static size_t
+_renoir_pixelformat_to_size(RENOIR_PIXELFORMAT format)
+{
+	switch(format)
+	{
+	case RENOIR_PIXELFORMAT_RGBA8:
+	case RENOIR_PIXELFORMAT_D32:
+	case RENOIR_PIXELFORMAT_R32F:
+	case RENOIR_PIXELFORMAT_D24S8:
+		return 4;
+	case RENOIR_PIXELFORMAT_R16I:
+	case RENOIR_PIXELFORMAT_R16UI:
+	case RENOIR_PIXELFORMAT_R16F:
+		return 2;
+	case RENOIR_PIXELFORMAT_R32G32F:
+	case RENOIR_PIXELFORMAT_R16G16B16A16F:
+		return 8;
+	case RENOIR_PIXELFORMAT_R32G32B32A32F: return 16;
+	case RENOIR_PIXELFORMAT_R8: return 1;
+	default: mn_unreachable(); return 0;
+	}
+}
+
+// estimated bytes of the texture, it counts all the mip levels, the cube faces, and the msaa render buffers of the render targets
+inline static size_t
+_renoir_texture_desc_bytes(const Renoir_Texture_Desc& desc)
+{
+	size_t width = desc.size.width > 0 ? desc.size.width : 1;
+	size_t height = desc.size.height > 0 ? desc.size.height : 1;
+	size_t depth = desc.size.depth > 0 ? desc.size.depth : 1;
+	size_t pixel_size = _renoir_pixelformat_to_size(desc.pixel_format);
+	size_t faces = desc.cube_map ? 6 : 1;
+
+	size_t res = 0;
+	int mipmaps = desc.mipmaps > 0 ? desc.mipmaps : 1;
+	for (int i = 0; i < mipmaps; ++i)
+	{
+		res += (width >> i > 0 ? width >> i : 1) * (height >> i > 0 ? height >> i : 1) * (depth >> i > 0 ? depth >> i : 1) * pixel_size;
+	}
+	res *= faces;
+
+	if (desc.render_target && desc.msaa != RENOIR_MSAA_MODE_NONE)
+		res += width * height * pixel_size * size_t(desc.msaa) * faces;
+	return res;
+}
+
 inline static const char*
 _renoir_handle_kind_name(RENOIR_HANDLE_KIND kind)
 {
@@ -758,10 +824,32 @@ _renoir_handle_kind_name(RENOIR_HANDLE_KIND kind)
 	case RENOIR_HANDLE_KIND_PROGRAM: return "program";
 	case RENOIR_HANDLE_KIND_COMPUTE: return "compute";
 	case RENOIR_HANDLE_KIND_PIPELINE: return "pipeline";
+	case RENOIR_HANDLE_KIND_TIMER: return "timer";
+	case RENOIR_HANDLE_KIND_READBACK: return "readback";
 	default: mn_unreachable_msg("invalid handle kind"); return "<INVALID>";
 	}
 }
 
+inline static RENOIR_RESOURCE
+_renoir_handle_kind_to_resource(RENOIR_HANDLE_KIND kind)
+{
+	switch(kind)
+	{
+	case RENOIR_HANDLE_KIND_SWAPCHAIN: return RENOIR_RESOURCE_SWAPCHAIN;
+	case RENOIR_HANDLE_KIND_RASTER_PASS: return RENOIR_RESOURCE_RASTER_PASS;
+	case RENOIR_HANDLE_KIND_COMPUTE_PASS: return RENOIR_RESOURCE_COMPUTE_PASS;
+	case RENOIR_HANDLE_KIND_BUFFER: return RENOIR_RESOURCE_BUFFER;
+	case RENOIR_HANDLE_KIND_TEXTURE: return RENOIR_RESOURCE_TEXTURE;
+	case RENOIR_HANDLE_KIND_SAMPLER: return RENOIR_RESOURCE_SAMPLER;
+	case RENOIR_HANDLE_KIND_PROGRAM: return RENOIR_RESOURCE_PROGRAM;
+	case RENOIR_HANDLE_KIND_COMPUTE: return RENOIR_RESOURCE_COMPUTE;
+	case RENOIR_HANDLE_KIND_PIPELINE: return RENOIR_RESOURCE_PIPELINE;
+	case RENOIR_HANDLE_KIND_TIMER: return RENOIR_RESOURCE_TIMER;
+	case RENOIR_HANDLE_KIND_READBACK: return RENOIR_RESOURCE_READBACK;
+	default: mn_unreachable_msg("invalid handle kind"); return RENOIR_RESOURCE_COUNT;
+	}
+}
+
 inline static bool
 _renoir_handle_kind_should_track(RENOIR_HANDLE_KIND kind)
 {
@@ -775,7 +863,8 @@ _renoir_handle_kind_should_track(RENOIR_HANDLE_KIND kind)
 		// we ignore the samplers because they are cached not user created
 		// kind == RENOIR_HANDLE_KIND_SAMPLER ||
 		kind == RENOIR_HANDLE_KIND_PROGRAM ||
-		kind == RENOIR_HANDLE_KIND_COMPUTE
+		kind == RENOIR_HANDLE_KIND_COMPUTE ||
+		kind == RENOIR_HANDLE_KIND_READBACK
 		// we ignore the pipeline because they are cached not user created
 		// kind == RENOIR_HANDLE_KIND_PIPELINE
 	);
@@ -852,6 +941,9 @@ enum RENOIR_COMMAND_KIND
 	RENOIR_COMMAND_KIND_TIMER_NEW,
 	RENOIR_COMMAND_KIND_TIMER_FREE,
 	RENOIR_COMMAND_KIND_TIMER_ELAPSED,
+	RENOIR_COMMAND_KIND_READBACK_BUFFER,
+	RENOIR_COMMAND_KIND_READBACK_TEXTURE,
+	RENOIR_COMMAND_KIND_READBACK_FREE,
 	RENOIR_COMMAND_KIND_PASS_BEGIN,
 	RENOIR_COMMAND_KIND_PASS_END,
 	RENOIR_COMMAND_KIND_PASS_CLEAR,
@@ -867,15 +959,82 @@ enum RENOIR_COMMAND_KIND
 	RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND,
 	RENOIR_COMMAND_KIND_TEXTURE_BIND,
 	RENOIR_COMMAND_KIND_DRAW,
+	RENOIR_COMMAND_KIND_DRAW_INDIRECT,
 	RENOIR_COMMAND_KIND_DISPATCH,
+	RENOIR_COMMAND_KIND_DISPATCH_INDIRECT,
+	RENOIR_COMMAND_KIND_BARRIER,
 	RENOIR_COMMAND_KIND_TIMER_BEGIN,
 	RENOIR_COMMAND_KIND_TIMER_END,
+	RENOIR_COMMAND_KIND_PROFILE_BEGIN,
+	RENOIR_COMMAND_KIND_PROFILE_END,
+	RENOIR_COMMAND_KIND_COUNT,
 };
 
+static_assert(int(RENOIR_COMMAND_KIND_COUNT) <= int(RENOIR_CONSTANT_STATS_COMMAND_KIND_SIZE), "frame stats can't count all the command kinds");
+
+inline static const char*
+_renoir_gl450_command_kind_name(int kind)
+{
+	switch(kind)
+	{
+	case RENOIR_COMMAND_KIND_NONE: return "none";
+	case RENOIR_COMMAND_KIND_INIT: return "init";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_NEW: return "swapchain_new";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_FREE: return "swapchain_free";
+	case RENOIR_COMMAND_KIND_PASS_SWAPCHAIN_NEW: return "pass_swapchain_new";
+	case RENOIR_COMMAND_KIND_PASS_OFFSCREEN_NEW: return "pass_offscreen_new";
+	case RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW: return "pass_compute_new";
+	case RENOIR_COMMAND_KIND_PASS_FREE: return "pass_free";
+	case RENOIR_COMMAND_KIND_BUFFER_NEW: return "buffer_new";
+	case RENOIR_COMMAND_KIND_BUFFER_FREE: return "buffer_free";
+	case RENOIR_COMMAND_KIND_TEXTURE_NEW: return "texture_new";
+	case RENOIR_COMMAND_KIND_TEXTURE_FREE: return "texture_free";
+	case RENOIR_COMMAND_KIND_SAMPLER_NEW: return "sampler_new";
+	case RENOIR_COMMAND_KIND_SAMPLER_FREE: return "sampler_free";
+	case RENOIR_COMMAND_KIND_PROGRAM_NEW: return "program_new";
+	case RENOIR_COMMAND_KIND_PROGRAM_FREE: return "program_free";
+	case RENOIR_COMMAND_KIND_COMPUTE_NEW: return "compute_new";
+	case RENOIR_COMMAND_KIND_COMPUTE_FREE: return "compute_free";
+	case RENOIR_COMMAND_KIND_PIPELINE_NEW: return "pipeline_new";
+	case RENOIR_COMMAND_KIND_PIPELINE_FREE: return "pipeline_free";
+	case RENOIR_COMMAND_KIND_TIMER_NEW: return "timer_new";
+	case RENOIR_COMMAND_KIND_TIMER_FREE: return "timer_free";
+	case RENOIR_COMMAND_KIND_TIMER_ELAPSED: return "timer_elapsed";
+	case RENOIR_COMMAND_KIND_READBACK_BUFFER: return "readback_buffer";
+	case RENOIR_COMMAND_KIND_READBACK_TEXTURE: return "readback_texture";
+	case RENOIR_COMMAND_KIND_READBACK_FREE: return "readback_free";
+	case RENOIR_COMMAND_KIND_PASS_BEGIN: return "pass_begin";
+	case RENOIR_COMMAND_KIND_PASS_END: return "pass_end";
+	case RENOIR_COMMAND_KIND_PASS_CLEAR: return "pass_clear";
+	case RENOIR_COMMAND_KIND_USE_PIPELINE: return "use_pipeline";
+	case RENOIR_COMMAND_KIND_USE_COMPUTE: return "use_compute";
+	case RENOIR_COMMAND_KIND_SCISSOR: return "scissor";
+	case RENOIR_COMMAND_KIND_BUFFER_CLEAR: return "buffer_clear";
+	case RENOIR_COMMAND_KIND_BUFFER_WRITE: return "buffer_write";
+	case RENOIR_COMMAND_KIND_TEXTURE_WRITE: return "texture_write";
+	case RENOIR_COMMAND_KIND_BUFFER_READ: return "buffer_read";
+	case RENOIR_COMMAND_KIND_TEXTURE_READ: return "texture_read";
+	case RENOIR_COMMAND_KIND_BUFFER_BIND: return "buffer_bind";
+	case RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND: return "buffer_storage_bind";
+	case RENOIR_COMMAND_KIND_TEXTURE_BIND: return "texture_bind";
+	case RENOIR_COMMAND_KIND_DRAW: return "draw";
+	case RENOIR_COMMAND_KIND_DRAW_INDIRECT: return "draw_indirect";
+	case RENOIR_COMMAND_KIND_DISPATCH: return "dispatch";
+	case RENOIR_COMMAND_KIND_DISPATCH_INDIRECT: return "dispatch_indirect";
+	case RENOIR_COMMAND_KIND_BARRIER: return "barrier";
+	case RENOIR_COMMAND_KIND_TIMER_BEGIN: return "timer_begin";
+	case RENOIR_COMMAND_KIND_TIMER_END: return "timer_end";
+	case RENOIR_COMMAND_KIND_PROFILE_BEGIN: return "profile_begin";
+	case RENOIR_COMMAND_KIND_PROFILE_END: return "profile_end";
+	default: return nullptr;
+	}
+}
+
 struct Renoir_Command
 {
-	Renoir_Command *prev, *next;
 	RENOIR_COMMAND_KIND kind;
+	// size of the command in bytes including this header, this is the stride to the next command in the stream
+	uint32_t size;
 	union
 	{
 		struct
@@ -997,6 +1156,25 @@ struct Renoir_Command
 			Renoir_Handle* handle;
 		} timer_elapsed;
 
+		struct
+		{
+			Renoir_Handle* handle;
+			Renoir_Handle* buffer;
+			size_t offset;
+		} readback_buffer;
+
+		struct
+		{
+			Renoir_Handle* handle;
+			Renoir_Handle* texture;
+			Renoir_Texture_Edit_Desc desc;
+		} readback_texture;
+
+		struct
+		{
+			Renoir_Handle* handle;
+		} readback_free;
+
 		struct
 		{
 			Renoir_Handle* handle;
@@ -1037,6 +1215,7 @@ struct Renoir_Command
 			Renoir_Handle* handle;
 		} buffer_clear;
 
+		// bytes point to the payload which is stored right after the command
 		struct
 		{
 			Renoir_Handle* handle;
@@ -1071,12 +1250,17 @@ struct Renoir_Command
 			RENOIR_SHADER shader;
 			int slot;
 			RENOIR_ACCESS gpu_access;
+			// both are 0 when the whole buffer is bound
+			size_t offset;
+			size_t size;
 		} buffer_bind;
 
 		struct
 		{
 			Renoir_Handle* handle[RENOIR_CONSTANT_BUFFER_STORAGE_SIZE];
 			int start_slot;
+			size_t offsets[RENOIR_CONSTANT_BUFFER_STORAGE_SIZE];
+			size_t sizes[RENOIR_CONSTANT_BUFFER_STORAGE_SIZE];
 		} buffer_storage_bind;
 
 		struct
@@ -1091,14 +1275,53 @@ struct Renoir_Command
 
 		struct
 		{
-			Renoir_Draw_Desc desc;
+			RENOIR_PRIMITIVE primitive;
+			int base_element;
+			int elements_count;
+			int instances_count;
+			Renoir_Buffer index_buffer;
+			RENOIR_TYPE index_type;
+			// packed vertex types of all the slots, used to find the cached vertex array
+			uint64_t layout;
+			int vertex_buffers_count;
+			// only the used prefix of the vertex slots is stored, it trails the command in the stream
+			Renoir_Vertex_Desc vertex_buffers[1];
 		} draw;
 
+		struct
+		{
+			RENOIR_PRIMITIVE primitive;
+			Renoir_Buffer index_buffer;
+			RENOIR_TYPE index_type;
+			Renoir_Handle* indirect_buffer;
+			size_t indirect_offset;
+			size_t indirect_stride;
+			int draw_count;
+			// null unless this is a draw_indirect_count
+			Renoir_Handle* count_buffer;
+			size_t count_offset;
+			uint64_t layout;
+			int vertex_buffers_count;
+			// only the used prefix of the vertex slots is stored, it trails the command in the stream
+			Renoir_Vertex_Desc vertex_buffers[1];
+		} draw_indirect;
+
 		struct
 		{
 			int x, y, z;
 		} dispatch;
 
+		struct
+		{
+			Renoir_Handle* buffer;
+			size_t offset;
+		} dispatch_indirect;
+
+		struct
+		{
+			int barriers;
+		} barrier;
+
 		struct
 		{
 			Renoir_Handle* handle;
@@ -1108,9 +1331,326 @@ struct Renoir_Command
 		{
 			Renoir_Handle* handle;
 		} timer_end;
+
+		struct
+		{
+			// the name is stored inline in the command stream right after the command
+			const char* name;
+			size_t name_size;
+		} profile_begin;
+
+		struct
+		{
+		} profile_end;
 	};
 };
 
+struct Renoir_Command_Chunk
+{
+	Renoir_Command_Chunk* next;
+	// the allocator this chunk goes back to after its commands are executed
+	Renoir_Command_Allocator* owner;
+	// number of bytes used, commands start right after the chunk header
+	size_t used;
+	size_t capacity;
+};
+
+struct Renoir_Command_Allocator
+{
+	// only touched by the thread which records into the owning pass
+	Renoir_Command_Chunk* free_chunks;
+	// chunks handed back by the executing thread, pushed lock free and taken all at once by the recording thread
+	std::atomic<Renoir_Command_Chunk*> returned_chunks;
+	// set when the owning pass is freed, chunks released after that go back to the heap
+	bool orphaned;
+	// 1 for the owning pass + 1 for each allocated chunk
+	std::atomic<int> rc;
+};
+
+constexpr size_t RENOIR_GL450_COMMAND_CHUNK_SIZE = 64 * 1024;
+
+inline static uint8_t*
+_renoir_gl450_command_chunk_data(Renoir_Command_Chunk* chunk)
+{
+	return (uint8_t*)(chunk + 1);
+}
+
+inline static size_t
+_renoir_gl450_command_size(RENOIR_COMMAND_KIND kind)
+{
+	size_t res = 0;
+	switch (kind)
+	{
+	case RENOIR_COMMAND_KIND_INIT:
+		res = sizeof(Renoir_Command::init);
+		break;
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_NEW:
+		res = sizeof(Renoir_Command::swapchain_new);
+		break;
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_FREE:
+		res = sizeof(Renoir_Command::swapchain_free);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_SWAPCHAIN_NEW:
+		res = sizeof(Renoir_Command::pass_swapchain_new);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_OFFSCREEN_NEW:
+		res = sizeof(Renoir_Command::pass_offscreen_new);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW:
+		res = sizeof(Renoir_Command::pass_compute_new);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_FREE:
+		res = sizeof(Renoir_Command::pass_free);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_NEW:
+		res = sizeof(Renoir_Command::buffer_new);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_FREE:
+		res = sizeof(Renoir_Command::buffer_free);
+		break;
+	case RENOIR_COMMAND_KIND_TEXTURE_NEW:
+		res = sizeof(Renoir_Command::texture_new);
+		break;
+	case RENOIR_COMMAND_KIND_TEXTURE_FREE:
+		res = sizeof(Renoir_Command::texture_free);
+		break;
+	case RENOIR_COMMAND_KIND_SAMPLER_NEW:
+		res = sizeof(Renoir_Command::sampler_new);
+		break;
+	case RENOIR_COMMAND_KIND_SAMPLER_FREE:
+		res = sizeof(Renoir_Command::sampler_free);
+		break;
+	case RENOIR_COMMAND_KIND_PROGRAM_NEW:
+		res = sizeof(Renoir_Command::program_new);
+		break;
+	case RENOIR_COMMAND_KIND_PROGRAM_FREE:
+		res = sizeof(Renoir_Command::program_free);
+		break;
+	case RENOIR_COMMAND_KIND_COMPUTE_NEW:
+		res = sizeof(Renoir_Command::compute_new);
+		break;
+	case RENOIR_COMMAND_KIND_COMPUTE_FREE:
+		res = sizeof(Renoir_Command::compute_free);
+		break;
+	case RENOIR_COMMAND_KIND_PIPELINE_NEW:
+		res = sizeof(Renoir_Command::pipeline_new);
+		break;
+	case RENOIR_COMMAND_KIND_PIPELINE_FREE:
+		res = sizeof(Renoir_Command::pipeline_free);
+		break;
+	case RENOIR_COMMAND_KIND_TIMER_NEW:
+		res = sizeof(Renoir_Command::timer_new);
+		break;
+	case RENOIR_COMMAND_KIND_TIMER_FREE:
+		res = sizeof(Renoir_Command::timer_free);
+		break;
+	case RENOIR_COMMAND_KIND_TIMER_ELAPSED:
+		res = sizeof(Renoir_Command::timer_elapsed);
+		break;
+	case RENOIR_COMMAND_KIND_READBACK_BUFFER:
+		res = sizeof(Renoir_Command::readback_buffer);
+		break;
+	case RENOIR_COMMAND_KIND_READBACK_TEXTURE:
+		res = sizeof(Renoir_Command::readback_texture);
+		break;
+	case RENOIR_COMMAND_KIND_READBACK_FREE:
+		res = sizeof(Renoir_Command::readback_free);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_BEGIN:
+		res = sizeof(Renoir_Command::pass_begin);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_END:
+		res = sizeof(Renoir_Command::pass_end);
+		break;
+	case RENOIR_COMMAND_KIND_PASS_CLEAR:
+		res = sizeof(Renoir_Command::pass_clear);
+		break;
+	case RENOIR_COMMAND_KIND_USE_PIPELINE:
+		res = sizeof(Renoir_Command::use_pipeline);
+		break;
+	case RENOIR_COMMAND_KIND_USE_COMPUTE:
+		res = sizeof(Renoir_Command::use_compute);
+		break;
+	case RENOIR_COMMAND_KIND_SCISSOR:
+		res = sizeof(Renoir_Command::scissor);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_CLEAR:
+		res = sizeof(Renoir_Command::buffer_clear);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_WRITE:
+		res = sizeof(Renoir_Command::buffer_write);
+		break;
+	case RENOIR_COMMAND_KIND_TEXTURE_WRITE:
+		res = sizeof(Renoir_Command::texture_write);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_READ:
+		res = sizeof(Renoir_Command::buffer_read);
+		break;
+	case RENOIR_COMMAND_KIND_TEXTURE_READ:
+		res = sizeof(Renoir_Command::texture_read);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_BIND:
+		res = sizeof(Renoir_Command::buffer_bind);
+		break;
+	case RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND:
+		res = sizeof(Renoir_Command::buffer_storage_bind);
+		break;
+	case RENOIR_COMMAND_KIND_TEXTURE_BIND:
+		res = sizeof(Renoir_Command::texture_bind);
+		break;
+	case RENOIR_COMMAND_KIND_DRAW:
+		// vertex buffers are not included in this size, they're trailing the command
+		res = offsetof(decltype(Renoir_Command::draw), vertex_buffers);
+		break;
+	case RENOIR_COMMAND_KIND_DRAW_INDIRECT:
+		res = offsetof(decltype(Renoir_Command::draw_indirect), vertex_buffers);
+		break;
+	case RENOIR_COMMAND_KIND_DISPATCH:
+		res = sizeof(Renoir_Command::dispatch);
+		break;
+	case RENOIR_COMMAND_KIND_DISPATCH_INDIRECT:
+		res = sizeof(Renoir_Command::dispatch_indirect);
+		break;
+	case RENOIR_COMMAND_KIND_BARRIER:
+		res = sizeof(Renoir_Command::barrier);
+		break;
+	case RENOIR_COMMAND_KIND_TIMER_BEGIN:
+		res = sizeof(Renoir_Command::timer_begin);
+		break;
+	case RENOIR_COMMAND_KIND_TIMER_END:
+		res = sizeof(Renoir_Command::timer_end);
+		break;
+	case RENOIR_COMMAND_KIND_PROFILE_BEGIN:
+		res = sizeof(Renoir_Command::profile_begin);
+		break;
+	case RENOIR_COMMAND_KIND_PROFILE_END:
+		res = sizeof(Renoir_Command::profile_end);
+		break;
+	case RENOIR_COMMAND_KIND_NONE:
+	default:
+		mn_unreachable();
+		break;
+	}
+
+	// add the header size
+	return offsetof(Renoir_Command, init) + res;
+}
+
+// handles are allocated with the size of their kind's member only, instead of the size of the whole union
+inline static size_t
+_renoir_gl450_handle_size(RENOIR_HANDLE_KIND kind)
+{
+	size_t res = 0;
+	switch (kind)
+	{
+	case RENOIR_HANDLE_KIND_SWAPCHAIN:
+		res = sizeof(Renoir_Handle::swapchain);
+		break;
+	// passes share the recorder code, so both kinds are the size of the raster pass
+	case RENOIR_HANDLE_KIND_RASTER_PASS:
+	case RENOIR_HANDLE_KIND_COMPUTE_PASS:
+		res = sizeof(Renoir_Handle::raster_pass);
+		break;
+	case RENOIR_HANDLE_KIND_BUFFER:
+		res = sizeof(Renoir_Handle::buffer);
+		break;
+	case RENOIR_HANDLE_KIND_TEXTURE:
+		res = sizeof(Renoir_Handle::texture);
+		break;
+	case RENOIR_HANDLE_KIND_SAMPLER:
+		res = sizeof(Renoir_Handle::sampler);
+		break;
+	case RENOIR_HANDLE_KIND_PROGRAM:
+		res = sizeof(Renoir_Handle::program);
+		break;
+	case RENOIR_HANDLE_KIND_COMPUTE:
+		res = sizeof(Renoir_Handle::compute);
+		break;
+	case RENOIR_HANDLE_KIND_PIPELINE:
+		res = sizeof(Renoir_Handle::pipeline);
+		break;
+	case RENOIR_HANDLE_KIND_TIMER:
+		res = sizeof(Renoir_Handle::timer);
+		break;
+	case RENOIR_HANDLE_KIND_READBACK:
+		res = sizeof(Renoir_Handle::readback);
+		break;
+	case RENOIR_HANDLE_KIND_NONE:
+	default:
+		mn_unreachable();
+		break;
+	}
+
+	// add the header size and keep the handles in the table buckets aligned
+	res += offsetof(Renoir_Handle, swapchain);
+	return (res + alignof(Renoir_Handle) - 1) & ~(alignof(Renoir_Handle) - 1);
+}
+
+// handles of the same kind are packed together in buckets, freed handles are reused but never given back to the os
+// until dispose, so the generation of a freed handle is still readable when a stale handle is used
+struct Renoir_GL450_Handle_Table
+{
+	size_t handle_size;
+	mn::Buf<mn::Block> buckets;
+	mn::Buf<Renoir_Handle*> free_list;
+};
+
+constexpr static size_t RENOIR_GL450_HANDLE_TABLE_BUCKET_SIZE = 128;
+
+inline static Renoir_GL450_Handle_Table
+_renoir_gl450_handle_table_new(RENOIR_HANDLE_KIND kind)
+{
+	Renoir_GL450_Handle_Table self{};
+	self.handle_size = _renoir_gl450_handle_size(kind);
+	self.buckets = mn::buf_new<mn::Block>();
+	self.free_list = mn::buf_new<Renoir_Handle*>();
+	return self;
+}
+
+inline static void
+_renoir_gl450_handle_table_free(Renoir_GL450_Handle_Table& self)
+{
+	for (auto bucket: self.buckets)
+		mn::free(bucket);
+	mn::buf_free(self.buckets);
+	mn::buf_free(self.free_list);
+}
+
+inline static Renoir_Handle*
+_renoir_gl450_handle_table_get(Renoir_GL450_Handle_Table& self)
+{
+	if (self.free_list.count == 0)
+	{
+		auto bucket = mn::alloc(self.handle_size * RENOIR_GL450_HANDLE_TABLE_BUCKET_SIZE, alignof(Renoir_Handle));
+		::memset(bucket.ptr, 0, bucket.size);
+		mn::buf_push(self.buckets, bucket);
+		// pushed in reverse so the handles are given out in address order
+		for (size_t i = RENOIR_GL450_HANDLE_TABLE_BUCKET_SIZE; i > 0; --i)
+			mn::buf_push(self.free_list, (Renoir_Handle*)((char*)bucket.ptr + (i - 1) * self.handle_size));
+	}
+	auto res = mn::buf_top(self.free_list);
+	mn::buf_pop(self.free_list);
+	return res;
+}
+
+inline static void
+_renoir_gl450_handle_table_put(Renoir_GL450_Handle_Table& self, Renoir_Handle* h)
+{
+	mn::buf_push(self.free_list, h);
+}
+
+// public handles carry the generation of their handle, a handle which was freed has moved on to a newer generation,
+// so using a stale handle is caught with a single compare in release builds too
+template<typename T>
+inline static Renoir_Handle*
+_renoir_gl450_handle_get(T handle)
+{
+	auto h = (Renoir_Handle*)handle.handle;
+	if (h != nullptr && h->generation != handle.generation)
+		mn::panic("renoir handle to '{}' is used after it was freed", _renoir_handle_kind_name(h->kind));
+	return h;
+}
+
 struct Renoir_GL450_State
 {
 	// this is a copy from imgui
@@ -1223,35 +1763,428 @@ _renoir_gl450_state_reset(Renoir_GL450_State& state)
 		(GLsizei)state.last_scissor_box[3]);
 }
 
-struct Renoir_Leak_Info
+inline static Renoir_GL450_Pipeline_State
+_renoir_gl450_pipeline_state_bake(const Renoir_Pipeline_Desc& desc)
 {
-	void* callstack[20];
-	size_t callstack_size;
-};
+	Renoir_GL450_Pipeline_State res{};
+	res.cull = desc.rasterizer.cull == RENOIR_SWITCH_ENABLE;
+	res.cull_face = _renoir_face_to_gl(desc.rasterizer.cull_face);
+	res.front_face = _renoir_orientation_to_gl(desc.rasterizer.cull_front);
+	res.scissor = desc.rasterizer.scissor == RENOIR_SWITCH_ENABLE;
+	res.depth = desc.depth_stencil.depth == RENOIR_SWITCH_ENABLE;
+	res.depth_write_mask = desc.depth_stencil.depth_write_mask == RENOIR_SWITCH_ENABLE;
+	res.independent_blend = desc.independent_blend == RENOIR_SWITCH_ENABLE;
+	for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+	{
+		// non independent blend uses the first blend desc for all the attachments
+		const auto& blend = res.independent_blend ? desc.blend[i] : desc.blend[0];
+		auto& gl_blend = res.blend[i];
+		gl_blend.enabled = blend.enabled == RENOIR_SWITCH_ENABLE;
+		gl_blend.src_rgb = _renoir_blend_to_gl(blend.src_rgb);
+		gl_blend.dst_rgb = _renoir_blend_to_gl(blend.dst_rgb);
+		gl_blend.src_alpha = _renoir_blend_to_gl(blend.src_alpha);
+		gl_blend.dst_alpha = _renoir_blend_to_gl(blend.dst_alpha);
+		gl_blend.eq_rgb = _renoir_blend_eq_to_gl(blend.eq_rgb);
+		gl_blend.eq_alpha = _renoir_blend_eq_to_gl(blend.eq_alpha);
+		gl_blend.color_mask[0] = (blend.color_mask & RENOIR_COLOR_MASK_RED) != 0;
+		gl_blend.color_mask[1] = (blend.color_mask & RENOIR_COLOR_MASK_GREEN) != 0;
+		gl_blend.color_mask[2] = (blend.color_mask & RENOIR_COLOR_MASK_BLUE) != 0;
+		gl_blend.color_mask[3] = (blend.color_mask & RENOIR_COLOR_MASK_ALPHA) != 0;
+	}
+	// the program id is read when the pipeline is used, since the program might not be created yet in deferred mode
+	return res;
+}
 
-struct IRenoir
+inline static bool
+_renoir_gl450_blend_func_equal(const Renoir_GL450_Blend_State& a, const Renoir_GL450_Blend_State& b)
 {
-	mn::Mutex mtx;
-	Renoir_GL450_Context* ctx;
-	mn::Pool handle_pool;
-	mn::Pool command_pool;
-	Renoir_Settings settings;
-
-	mn::Str info_description;
-
-	// global command list
-	Renoir_Command *command_list_head;
-	Renoir_Command *command_list_tail;
+	return a.src_rgb == b.src_rgb && a.dst_rgb == b.dst_rgb && a.src_alpha == b.src_alpha && a.dst_alpha == b.dst_alpha;
+}
+
+inline static bool
+_renoir_gl450_blend_eq_equal(const Renoir_GL450_Blend_State& a, const Renoir_GL450_Blend_State& b)
+{
+	return a.eq_rgb == b.eq_rgb && a.eq_alpha == b.eq_alpha;
+}
+
+inline static bool
+_renoir_gl450_color_mask_equal(const Renoir_GL450_Blend_State& a, const Renoir_GL450_Blend_State& b)
+{
+	return ::memcmp(a.color_mask, b.color_mask, sizeof(a.color_mask)) == 0;
+}
+
+inline static void
+_renoir_gl450_enable(GLenum cap, GLboolean value)
+{
+	if (value)
+		glEnable(cap);
+	else
+		glDisable(cap);
+}
+
+inline static void
+_renoir_gl450_enablei(GLenum cap, GLuint index, GLboolean value)
+{
+	if (value)
+		glEnablei(cap, index);
+	else
+		glDisablei(cap, index);
+}
+
+struct Renoir_Leak_Info
+{
+	void* callstack[20];
+	size_t callstack_size;
+};
+
+// every vertex layout has its own vertex array, which also remembers the buffers bound to it
+// so draws using the same layout and buffers issue no vertex setup calls
+struct Renoir_GL450_Vertex_Array
+{
+	GLuint vao;
+	GLuint buffers[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE];
+	GLintptr offsets[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE];
+	GLsizei strides[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE];
+	GLuint index_buffer;
+};
+
+// bytes streamed into a stream buffer during a frame, the fence signals once the gpu is done reading them
+// it's recorded when the frame is submitted and fenced when the executor finishes executing the frame
+struct Renoir_GL450_Stream_Region
+{
+	Renoir_Handle* buffer;
+	GLsync fence;
+	uint64_t frame;
+	size_t begin;
+	size_t size;
+};
+
+// resource bound in the current pass, the executor checks the bindings for pending compute writes before every
+// dispatch/draw, bindings are replaced by their binding point and slot
+struct Renoir_GL450_Binding
+{
+	Renoir_Handle* handle;
+	// barrier bit of the binding point, it's what a use of the binding needs after a compute write
+	GLbitfield barrier;
+	int slot;
+	bool write;
+};
+
+enum RENOIR_GL450_PROGRAM_COMPILE
+{
+	// programs are compiled and linked before program_new/compute_new return
+	RENOIR_GL450_PROGRAM_COMPILE_SYNC,
+	// the driver compiles the programs on its own threads (ARB/KHR_parallel_shader_compile) and they're polled for completion
+	RENOIR_GL450_PROGRAM_COMPILE_PARALLEL,
+	// programs are compiled on the compile thread which has its own context sharing the objects of the main one
+	RENOIR_GL450_PROGRAM_COMPILE_WORKER,
+};
+
+// program waiting for the compile thread, the shader sources are copies which are freed once it's compiled
+struct Renoir_GL450_Compile_Job
+{
+	Renoir_Handle* handle;
+	Renoir_Shader_Blob shaders[3];
+};
+
+// work item of the render thread, it's either a submitted frame or a job which needs the context
+struct Renoir_GL450_Frame
+{
+	Renoir_Command_Stream commands;
+	// swapchain to present after the frame is executed, null for flushed frames
+	Renoir_Handle* swapchain;
+	uint64_t index;
+	void (*job)(IRenoir* self, void* data);
+	void* job_data;
+#if RENOIR_STATS
+	// api lock counters of the frame, the executor publishes them with its own counters at the end of the frame
+	size_t mtx_locks;
+	uint64_t mtx_wait_time_in_nanos;
+	uint64_t mtx_hold_time_in_nanos;
+#endif
+};
+
+struct Renoir_GL450_Profile_Scope
+{
+	size_t name_offset;
+	int depth;
+	GLuint queries[2];
+};
+
+// profile scopes executed during a frame, their timestamps are read once the gpu is done with the frame
+struct Renoir_GL450_Profile_Frame
+{
+	uint64_t index;
+	bool pending;
+	GLuint last_query;
+	mn::Buf<Renoir_GL450_Profile_Scope> scopes;
+	mn::Buf<char> names;
+};
+
+struct Renoir_GL450_Trace_Event
+{
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+// single producer ring of the events recorded by a thread, trace_write reads it while the thread is recording
+struct Renoir_GL450_Trace_Ring
+{
+	std::thread::id thread_id;
+	uint32_t tid;
+	const char* name;
+	std::atomic<uint64_t> head;
+	Renoir_GL450_Trace_Event events[RENOIR_CONSTANT_TRACE_RING_SIZE];
+};
+
+// ids of the renoir instances used by the threads to validate their cached ring
+static std::atomic<uint64_t> _renoir_gl450_trace_ids;
+
+// ring of the current thread, trace_id tells which renoir instance it belongs to
+struct Renoir_GL450_Trace_Thread
+{
+	uint64_t trace_id;
+	Renoir_GL450_Trace_Ring* ring;
+};
+
+// timestamp queries around an executed command batch, they're read once the gpu is done with them
+struct Renoir_GL450_Trace_Gpu_Scope
+{
+	const char* name;
+	GLuint queries[2];
+};
+
+// vertex layout is 4 bits per vertex slot holding its type, slot i is bound to attribute location i
+constexpr int RENOIR_GL450_VERTEX_LAYOUT_BITS = 4;
+static_assert(RENOIR_TYPE_FLOAT_4 < (1 << RENOIR_GL450_VERTEX_LAYOUT_BITS), "vertex type doesn't fit in the layout");
+static_assert(RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE * RENOIR_GL450_VERTEX_LAYOUT_BITS <= 64, "vertex layout doesn't fit in 64 bits");
+
+inline static bool
+operator==(const Renoir_Sampler_Desc& a, const Renoir_Sampler_Desc& b)
+{
+	return (
+		a.filter == b.filter &&
+		a.u == b.u &&
+		a.v == b.v &&
+		a.w == b.w &&
+		a.compare == b.compare &&
+		a.border.r == b.border.r &&
+		a.border.g == b.border.g &&
+		a.border.b == b.border.b &&
+		a.border.a == b.border.a
+	);
+}
+
+// hashes the fields not the struct bytes so the padding doesn't affect the hash
+struct Renoir_GL450_Sampler_Desc_Hasher
+{
+	inline size_t
+	operator()(const Renoir_Sampler_Desc& desc) const
+	{
+		int32_t modes[5] = {desc.filter, desc.u, desc.v, desc.w, desc.compare};
+		return mn::hash_mix(mn::murmur_hash(modes, sizeof(modes)), mn::murmur_hash(&desc.border, sizeof(desc.border)));
+	}
+};
+
+// the part of the pass attachment which affects the framebuffer, load/store actions don't
+struct Renoir_GL450_Framebuffer_Attachment
+{
+	void* texture;
+	int subresource;
+	int level;
+};
+
+// framebuffers are cached by their attachments, unused attachments are all zeros
+struct Renoir_GL450_Framebuffer_Key
+{
+	Renoir_GL450_Framebuffer_Attachment color[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE];
+	Renoir_GL450_Framebuffer_Attachment depth_stencil;
+};
+
+inline static bool
+operator==(const Renoir_GL450_Framebuffer_Attachment& a, const Renoir_GL450_Framebuffer_Attachment& b)
+{
+	return (
+		a.texture == b.texture &&
+		a.subresource == b.subresource &&
+		a.level == b.level
+	);
+}
+
+inline static bool
+operator==(const Renoir_GL450_Framebuffer_Key& a, const Renoir_GL450_Framebuffer_Key& b)
+{
+	for (size_t i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+		if ((a.color[i] == b.color[i]) == false)
+			return false;
+	return a.depth_stencil == b.depth_stencil;
+}
+
+// the key has no padding so its bytes are hashed directly
+static_assert(sizeof(Renoir_GL450_Framebuffer_Attachment) == sizeof(void*) + 2 * sizeof(int), "framebuffer attachment has padding");
+struct Renoir_GL450_Framebuffer_Key_Hasher
+{
+	inline size_t
+	operator()(const Renoir_GL450_Framebuffer_Key& key) const
+	{
+		return mn::murmur_hash(&key, sizeof(key));
+	}
+};
+
+struct IRenoir
+{
+	mn::Mutex mtx;
+	Renoir_GL450_Context* ctx;
+	// handles are freed by the executor which may run on the render thread so the pool has its own lock
+	mn::Mutex handle_mtx;
+	Renoir_GL450_Handle_Table handle_tables[RENOIR_HANDLE_KIND_COUNT];
+	// resource accounting, it's updated with the handles so it's guarded by handle_mtx as well
+	Renoir_Resource_Stats resource_stats;
+	Renoir_Settings settings;
+	// index of the frame being recorded, it's incremented with every present/flush
+	uint64_t frame_index;
+
+	// render thread mode, frames are queued by present/flush and executed in order on the render thread which owns the context
+	mn::Thread render_thread;
+	mn::Mutex queue_mtx;
+	mn::Cond_Var queue_cv;
+	mn::Buf<Renoir_GL450_Frame> queue;
+	// frames queued or executing, present blocks once it reaches settings.frames_in_flight
+	int queue_frames;
+	uint64_t queue_pushed;
+	uint64_t queue_executed;
+	bool queue_quit;
+
+	mn::Str info_description;
+
+	// global command stream, guarded by mtx
+	Renoir_Command_Stream commands;
+	Renoir_Command_Allocator* allocator;
+	// guards the command execution context, present/flush swap the global command stream out under mtx then
+	// execute it under this lock only, so submitting threads never wait for the execution of a frame
+	mn::Mutex exec_mtx;
+
+	// upload payloads are stored inline in the command streams, these track their size per frame
+	std::atomic<size_t> upload_bytes_frame;
+	size_t upload_bytes_last_frame;
+	size_t upload_bytes_high_water;
+
+	// guards the stats and profiler results published by the executor
+	mn::Mutex stats_mtx;
 
 	// command execution context
 	Renoir_Handle* current_pipeline;
 	Renoir_Handle* current_compute;
 	Renoir_Handle* current_pass;
 
+	// shadow of the gl state set by pipelines, only the differences are issued when a new pipeline is used
+	Renoir_GL450_Pipeline_State gl_state;
+	bool gl_state_valid;
+	size_t gl_state_calls_emitted_frame;
+	size_t gl_state_calls_skipped_frame;
+	size_t gl_state_calls_emitted_last_frame;
+	size_t gl_state_calls_skipped_last_frame;
+
+	// consecutive compatible draws merged into a single multi draw, only used when settings.merge_draws is enabled
+	Renoir_Command* draw_batch_first;
+	mn::Buf<GLsizei> draw_batch_counts;
+	mn::Buf<GLint> draw_batch_firsts;
+	mn::Buf<const void*> draw_batch_indices;
+
+	// stream buffers and the fenced regions of the previous frames which the gpu may still be reading, guarded by stream_mtx
+	mn::Mutex stream_mtx;
+	mn::Buf<Renoir_Handle*> stream_buffers;
+	mn::Buf<Renoir_GL450_Stream_Region> stream_regions;
+
+	// bindings of the current pass and the resources written by dispatches which still need barriers before some
+	// of their uses, barriers are only issued when such a use happens unless settings.manual_barriers is enabled
+	mn::Buf<Renoir_GL450_Binding> bindings;
+	mn::Buf<Renoir_Handle*> barrier_resources;
+
+	// executed readbacks which the gpu is still copying, they're resolved at the end of every frame
+	mn::Buf<Renoir_Handle*> pending_readbacks;
+
+	// profiler frames are kept in a ring RENOIR_CONSTANT_PROFILER_FRAME_COUNT deep, and the timestamp queries are recycled
+	Renoir_GL450_Profile_Frame profile_frames[RENOIR_CONSTANT_PROFILER_FRAME_COUNT];
+	uint64_t profile_frame;
+	mn::Buf<size_t> profile_stack;
+	mn::Buf<GLuint> profile_queries;
+	mn::Buf<Renoir_Profile_Scope> profile_results;
+	mn::Buf<char> profile_results_names;
+	uint64_t profile_results_frame;
+	bool profile_results_ready;
+	// copy of the results handed out by profile_results, guarded by mtx
+	mn::Buf<Renoir_Profile_Scope> profile_results_user;
+	mn::Buf<char> profile_results_user_names;
+
+	// tracer, trace_id is unique per instance so the threads know when their cached ring belongs to another instance
+	std::atomic<bool> trace_enabled;
+	uint64_t trace_id;
+	mn::Mutex trace_mtx;
+	mn::Buf<Renoir_GL450_Trace_Ring*> trace_rings;
+	// gpu events are converted to the cpu clock and pushed into trace_gpu_ring by the executor, it's created
+	// under trace_mtx once there are gpu events
+	Renoir_GL450_Trace_Ring* trace_gpu_ring;
+	mn::Buf<Renoir_GL450_Trace_Gpu_Scope> trace_gpu_scopes;
+
 	// caches
-	GLuint vao;
+	mn::Map<uint64_t, Renoir_GL450_Vertex_Array> vertex_arrays;
+	GLuint current_vao;
 	GLuint msaa_resolve_fb;
-	mn::Buf<Renoir_Handle*> sampler_cache;
+	// framebuffers are shared by the offscreen passes with the same attachments, entries are evicted when
+	// one of their textures is freed
+	mn::Map<Renoir_GL450_Framebuffer_Key, GLuint, Renoir_GL450_Framebuffer_Key_Hasher> framebuffers;
+	mn::Buf<Renoir_GL450_Framebuffer_Key> framebuffers_evicted;
+	// samplers are cached by desc, the lru list is threaded through the sampler handles
+	mn::Map<Renoir_Sampler_Desc, Renoir_Handle*, Renoir_GL450_Sampler_Desc_Hasher> sampler_cache;
+	Renoir_Handle* sampler_lru_head;
+	Renoir_Handle* sampler_lru_tail;
+	size_t sampler_cache_hits;
+	size_t sampler_cache_misses;
+	size_t sampler_cache_evictions;
+	// vendor, renderer and version of the driver, it's part of the program cache key, empty if the cache is disabled
+	mn::Str program_cache_driver;
+	// program cache stats, they're updated by the executor and guarded by stats_mtx
+	size_t program_cache_hits;
+	size_t program_cache_misses;
+	uint64_t program_compile_time_in_nanos;
+	uint64_t program_load_time_in_nanos;
+	// buffer range offset alignments queried at init, they're atomics since the recorders check the bind offsets
+	// against them, they're 0 until the init command executes
+	std::atomic<size_t> uniform_buffer_offset_alignment;
+	std::atomic<size_t> storage_buffer_offset_alignment;
+	// draw_indirect_count needs ARB_indirect_parameters, it's queried at init as well and the recorders only check it
+	// once draw_indirect_count_queried is set
+	std::atomic<bool> draw_indirect_count_supported;
+	std::atomic<bool> draw_indirect_count_queried;
+
+	// async programs, the compile mode is decided at init based on settings.async_programs and the driver support
+	RENOIR_GL450_PROGRAM_COMPILE program_compile;
+	// programs the driver is compiling in parallel mode, they're polled at the end of every frame and when they're used
+	mn::Buf<Renoir_Handle*> program_builds;
+	// worker mode, compile_current is the program being compiled by the compile thread, guarded by compile_mtx
+	Renoir_GL450_Context* compile_ctx;
+	mn::Thread compile_thread;
+	mn::Mutex compile_mtx;
+	mn::Cond_Var compile_cv;
+	mn::Buf<Renoir_GL450_Compile_Job> compile_jobs;
+	Renoir_Handle* compile_current;
+	bool compile_quit;
+	// set when the used pipeline/compute is not ready, draws/dispatches are skipped until another one is used
+	bool skip_draws;
+	bool skip_dispatches;
+
+#if RENOIR_STATS
+	// api lock counters of the frame being recorded, guarded by mtx and moved into the frame when it's submitted
+	uint64_t mtx_locked_time;
+	size_t mtx_locks_frame;
+	uint64_t mtx_wait_time_frame;
+	uint64_t mtx_hold_time_frame;
+	// counted by the executor then published into frame_stats_last under stats_mtx at the end of the frame
+	Renoir_Frame_Stats frame_stats;
+	Renoir_Frame_Stats frame_stats_last;
+#endif
 
 	// opengl state used to prevent state leaks in case of external opengl context
 	bool glewInited;
@@ -1264,13 +2197,162 @@ struct IRenoir
 static void
 _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command);
 
+static void
+_renoir_gl450_draw_batch_flush(IRenoir* self);
+
+static bool
+_renoir_gl450_program_poll(IRenoir* self, Renoir_Handle* h);
+
+static GLuint
+_renoir_gl450_trace_gpu_begin(IRenoir* self);
+
+static void
+_renoir_gl450_trace_gpu_end(IRenoir* self, const char* name, GLuint begin_query);
+
+static uint64_t
+_renoir_gl450_time_in_nanos()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+// api lock, it's timed when the frame stats are enabled
+inline static void
+_renoir_gl450_mtx_lock(IRenoir* self)
+{
+#if RENOIR_STATS
+	auto start_time = _renoir_gl450_time_in_nanos();
+	mn::mutex_lock(self->mtx);
+	self->mtx_locked_time = _renoir_gl450_time_in_nanos();
+	self->mtx_wait_time_frame += self->mtx_locked_time - start_time;
+	++self->mtx_locks_frame;
+#else
+	mn::mutex_lock(self->mtx);
+#endif
+}
+
+inline static void
+_renoir_gl450_mtx_unlock(IRenoir* self)
+{
+#if RENOIR_STATS
+	self->mtx_hold_time_frame += _renoir_gl450_time_in_nanos() - self->mtx_locked_time;
+#endif
+	mn::mutex_unlock(self->mtx);
+}
+
+// tracer events are only recorded while it's enabled, begin returns 0 otherwise so end can skip the event
+inline static uint64_t
+_renoir_gl450_trace_begin(IRenoir* self)
+{
+	if (self->trace_enabled.load(std::memory_order_relaxed) == false)
+		return 0;
+	return _renoir_gl450_time_in_nanos();
+}
+
+// every thread gets its own ring the first time it records an event, the thread caches it so only the first
+// event of the thread takes trace_mtx
+static Renoir_GL450_Trace_Ring*
+_renoir_gl450_trace_ring(IRenoir* self, const char* name = nullptr)
+{
+	static thread_local Renoir_GL450_Trace_Thread thread;
+	if (thread.trace_id == self->trace_id && name == nullptr)
+		return thread.ring;
+
+	auto thread_id = std::this_thread::get_id();
+
+	mn::mutex_lock(self->trace_mtx);
+	mn_defer{mn::mutex_unlock(self->trace_mtx);};
+
+	Renoir_GL450_Trace_Ring* ring = nullptr;
+	for (auto it: self->trace_rings)
+	{
+		if (it->thread_id == thread_id)
+		{
+			ring = it;
+			break;
+		}
+	}
+
+	if (ring == nullptr)
+	{
+		ring = mn::alloc_zerod<Renoir_GL450_Trace_Ring>();
+		ring->thread_id = thread_id;
+		// tid 0 is the gpu track
+		ring->tid = uint32_t(self->trace_rings.count + 1);
+		mn::buf_push(self->trace_rings, ring);
+	}
+	if (name != nullptr)
+		ring->name = name;
+
+	thread.trace_id = self->trace_id;
+	thread.ring = ring;
+	return ring;
+}
+
+// only the ring's thread pushes to it, the event is written before the head is published so trace_write can
+// tell which events it copied while they were being overwritten
+inline static void
+_renoir_gl450_trace_ring_push(Renoir_GL450_Trace_Ring* ring, const char* name, uint64_t begin, uint64_t end)
+{
+	auto head = ring->head.load(std::memory_order_relaxed);
+	auto& event = ring->events[head % RENOIR_CONSTANT_TRACE_RING_SIZE];
+	event.name = name;
+	event.begin = begin;
+	event.end = end;
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+// name should be a string literal since it's only written to the json in trace_write
+inline static void
+_renoir_gl450_trace_end(IRenoir* self, const char* name, uint64_t begin)
+{
+	if (begin == 0)
+		return;
+	auto end = _renoir_gl450_time_in_nanos();
+	_renoir_gl450_trace_ring_push(_renoir_gl450_trace_ring(self), name, begin, end);
+}
+
+// buffers and textures add their bytes once their desc is set, the bytes are removed when the handle is freed
+static void
+_renoir_gl450_resource_bytes_add(IRenoir* self, Renoir_Handle* h)
+{
+	mn::mutex_lock(self->handle_mtx);
+	mn_defer{mn::mutex_unlock(self->handle_mtx);};
+
+	auto& stats = self->resource_stats;
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+	{
+		stats.buffer_bytes += h->buffer.size;
+		if (stats.buffer_bytes > stats.buffer_bytes_high_water)
+			stats.buffer_bytes_high_water = stats.buffer_bytes;
+	}
+	else if (h->kind == RENOIR_HANDLE_KIND_TEXTURE)
+	{
+		stats.texture_bytes += _renoir_texture_desc_bytes(h->texture.desc);
+		if (stats.texture_bytes > stats.texture_bytes_high_water)
+			stats.texture_bytes_high_water = stats.texture_bytes;
+	}
+}
+
 static Renoir_Handle*
 _renoir_gl450_handle_new(IRenoir* self, RENOIR_HANDLE_KIND kind)
 {
-	auto handle = (Renoir_Handle*)mn::pool_get(self->handle_pool);
-	memset(handle, 0, sizeof(*handle));
+	mn::mutex_lock(self->handle_mtx);
+	mn_defer{mn::mutex_unlock(self->handle_mtx);};
+
+	auto& table = self->handle_tables[kind];
+	auto handle = _renoir_gl450_handle_table_get(table);
+	uint32_t generation = handle->generation;
+	memset(handle, 0, table.handle_size);
 	handle->kind = kind;
 	handle->rc = 1;
+	handle->generation = generation;
+
+	auto& stats = self->resource_stats;
+	auto resource = _renoir_handle_kind_to_resource(kind);
+	++stats.count[resource];
+	if (stats.count[resource] > stats.count_high_water[resource])
+		stats.count_high_water[resource] = stats.count[resource];
 
 	#ifdef DEBUG
 	if (_renoir_handle_kind_should_track(kind))
@@ -1290,6 +2372,9 @@ _renoir_gl450_handle_new(IRenoir* self, RENOIR_HANDLE_KIND kind)
 static void
 _renoir_gl450_handle_free(IRenoir* self, Renoir_Handle* h)
 {
+	mn::mutex_lock(self->handle_mtx);
+	mn_defer{mn::mutex_unlock(self->handle_mtx);};
+
 	#ifdef DEBUG
 	if (_renoir_handle_kind_should_track(h->kind))
 	{
@@ -1297,7 +2382,15 @@ _renoir_gl450_handle_free(IRenoir* self, Renoir_Handle* h)
 		mn_assert_msg(removed, "free was called with an invalid renoir handle");
 	}
 	#endif
-	mn::pool_put(self->handle_pool, h);
+	auto& stats = self->resource_stats;
+	--stats.count[_renoir_handle_kind_to_resource(h->kind)];
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+		stats.buffer_bytes -= h->buffer.size;
+	else if (h->kind == RENOIR_HANDLE_KIND_TEXTURE)
+		stats.texture_bytes -= _renoir_texture_desc_bytes(h->texture.desc);
+
+	h->generation.fetch_add(1);
+	_renoir_gl450_handle_table_put(self->handle_tables[h->kind], h);
 }
 
 static Renoir_Handle*
@@ -1313,159 +2406,1944 @@ _renoir_gl450_handle_unref(Renoir_Handle* h)
 	return h->rc.fetch_sub(1) == 1;
 }
 
-template<typename T>
+static Renoir_Command_Allocator*
+_renoir_gl450_command_allocator_new()
+{
+	auto self = mn::alloc_zerod<Renoir_Command_Allocator>();
+	self->rc = 1;
+	return self;
+}
+
+static void
+_renoir_gl450_command_allocator_unref(Renoir_Command_Allocator* self)
+{
+	if (self->rc.fetch_sub(1) == 1)
+		mn::free(self);
+}
+
+static Renoir_Command_Chunk*
+_renoir_gl450_command_chunk_new(Renoir_Command_Allocator* allocator, size_t size)
+{
+	// default sized chunks are recycled, bigger chunks are allocated on demand
+	if (size <= RENOIR_GL450_COMMAND_CHUNK_SIZE)
+	{
+		if (allocator->free_chunks == nullptr)
+			allocator->free_chunks = allocator->returned_chunks.exchange(nullptr);
+
+		if (auto chunk = allocator->free_chunks)
+		{
+			allocator->free_chunks = chunk->next;
+			chunk->next = nullptr;
+			chunk->used = 0;
+			return chunk;
+		}
+	}
+
+	auto capacity = size > RENOIR_GL450_COMMAND_CHUNK_SIZE ? size : RENOIR_GL450_COMMAND_CHUNK_SIZE;
+	auto chunk = (Renoir_Command_Chunk*)mn::alloc(sizeof(Renoir_Command_Chunk) + capacity, alignof(Renoir_Command)).ptr;
+	chunk->next = nullptr;
+	chunk->owner = allocator;
+	chunk->used = 0;
+	chunk->capacity = capacity;
+	allocator->rc.fetch_add(1);
+	return chunk;
+}
+
+static void
+_renoir_gl450_command_chunk_free(Renoir_Command_Chunk* chunk)
+{
+	auto owner = chunk->owner;
+	mn::free(mn::Block{chunk, sizeof(Renoir_Command_Chunk) + chunk->capacity});
+	_renoir_gl450_command_allocator_unref(owner);
+}
+
+// called from the executing thread when the commands in the chunk are no longer needed
+static void
+_renoir_gl450_command_chunk_release(Renoir_Command_Chunk* chunk)
+{
+	auto owner = chunk->owner;
+	if (owner->orphaned || chunk->capacity != RENOIR_GL450_COMMAND_CHUNK_SIZE)
+	{
+		_renoir_gl450_command_chunk_free(chunk);
+		return;
+	}
+
+	chunk->next = owner->returned_chunks.load();
+	while (owner->returned_chunks.compare_exchange_weak(chunk->next, chunk) == false)
+		;
+}
+
+// called from the executing thread when the owning pass is freed
+static void
+_renoir_gl450_command_allocator_orphan(Renoir_Command_Allocator* self)
+{
+	self->orphaned = true;
+
+	auto it = self->free_chunks;
+	while (it != nullptr)
+	{
+		auto next = it->next;
+		_renoir_gl450_command_chunk_free(it);
+		it = next;
+	}
+	self->free_chunks = nullptr;
+
+	it = self->returned_chunks.exchange(nullptr);
+	while (it != nullptr)
+	{
+		auto next = it->next;
+		_renoir_gl450_command_chunk_free(it);
+		it = next;
+	}
+
+	// remove the owning pass reference, chunks which are still in flight will keep the allocator alive
+	_renoir_gl450_command_allocator_unref(self);
+}
+
 static Renoir_Command*
-_renoir_gl450_command_new(T* self, RENOIR_COMMAND_KIND kind)
+_renoir_gl450_command_stream_push(Renoir_Command_Allocator* allocator, Renoir_Command_Stream& stream, RENOIR_COMMAND_KIND kind, size_t extra_size)
+{
+	// round up to the command alignment so that the next command is aligned as well
+	constexpr size_t alignment = alignof(Renoir_Command);
+	auto size = (_renoir_gl450_command_size(kind) + extra_size + alignment - 1) & ~(alignment - 1);
+
+	// we never write into chunks owned by other allocators, they might be merged from other threads
+	auto chunk = stream.tail;
+	if (chunk == nullptr || chunk->owner != allocator || chunk->capacity - chunk->used < size)
+	{
+		chunk = _renoir_gl450_command_chunk_new(allocator, size);
+		if (stream.tail == nullptr)
+			stream.head = chunk;
+		else
+			stream.tail->next = chunk;
+		stream.tail = chunk;
+	}
+
+	auto command = (Renoir_Command*)(_renoir_gl450_command_chunk_data(chunk) + chunk->used);
+	::memset(command, 0, size);
+	command->kind = kind;
+	command->size = uint32_t(size);
+	chunk->used += size;
+	return command;
+}
+
+// removes the last command in the stream, used in immediate mode after the command is executed
+static void
+_renoir_gl450_command_stream_pop(Renoir_Command_Stream& stream, Renoir_Command* command)
+{
+	auto chunk = stream.tail;
+	mn_assert(chunk != nullptr);
+	mn_assert((uint8_t*)command + command->size == _renoir_gl450_command_chunk_data(chunk) + chunk->used);
+	chunk->used -= command->size;
+}
+
+// moves all the commands in other to the end of self in O(1)
+static void
+_renoir_gl450_command_stream_append(Renoir_Command_Stream& self, Renoir_Command_Stream& other)
+{
+	if (other.head == nullptr)
+		return;
+
+	if (self.tail == nullptr)
+		self.head = other.head;
+	else
+		self.tail->next = other.head;
+	self.tail = other.tail;
+	other = Renoir_Command_Stream{};
+}
+
+template<typename TFunc>
+inline static void
+_renoir_gl450_command_stream_for_each(Renoir_Command_Stream& stream, TFunc&& func)
+{
+	for (auto chunk = stream.head; chunk != nullptr; chunk = chunk->next)
+	{
+		auto it = _renoir_gl450_command_chunk_data(chunk);
+		auto end = it + chunk->used;
+		while (it < end)
+		{
+			auto command = (Renoir_Command*)it;
+			it += command->size;
+			func(command);
+		}
+	}
+}
+
+// gives the chunks back to their allocators without touching the commands inside them
+static void
+_renoir_gl450_command_stream_release(Renoir_Command_Stream& stream)
+{
+	auto it = stream.head;
+	while (it != nullptr)
+	{
+		auto next = it->next;
+		_renoir_gl450_command_chunk_release(it);
+		it = next;
+	}
+	stream = Renoir_Command_Stream{};
+}
+
+static void
+_renoir_gl450_command_free(IRenoir* self, Renoir_Command* command)
+{
+	switch(command->kind)
+	{
+	case RENOIR_COMMAND_KIND_BUFFER_NEW:
+	{
+		if(command->buffer_new.owns_data)
+			mn::free(mn::Block{(void*)command->buffer_new.desc.data, command->buffer_new.desc.data_size});
+		break;
+	}
+	case RENOIR_COMMAND_KIND_TEXTURE_NEW:
+	{
+		if(command->texture_new.owns_data)
+		{
+			for (int i = 0; i < 6; ++i)
+			{
+				if (command->texture_new.desc.data[i] == nullptr)
+					continue;
+
+				mn::free(mn::Block{(void*)command->texture_new.desc.data[i], command->texture_new.desc.data_size});
+			}
+		}
+		break;
+	}
+	case RENOIR_COMMAND_KIND_PROGRAM_NEW:
+	{
+		if(command->program_new.owns_data)
+		{
+			mn::free(mn::Block{(void*)command->program_new.desc.vertex.bytes, command->program_new.desc.vertex.size});
+			mn::free(mn::Block{(void*)command->program_new.desc.pixel.bytes, command->program_new.desc.pixel.size});
+			if (command->program_new.desc.geometry.bytes != nullptr)
+				mn::free(mn::Block{(void*)command->program_new.desc.geometry.bytes, command->program_new.desc.geometry.size});
+		}
+		break;
+	}
+	case RENOIR_COMMAND_KIND_COMPUTE_NEW:
+	{
+		if(command->compute_new.owns_data)
+		{
+			mn::free(mn::Block{(void*)command->compute_new.desc.compute.bytes, command->compute_new.desc.compute.size});
+		}
+		break;
+	}
+	default:
+		// do nothing
+		break;
+	}
+}
+
+// executes the commands in order then releases the stream
+static void
+_renoir_gl450_command_stream_execute(IRenoir* self, Renoir_Command_Stream& stream)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(self);
+	auto trace_gpu_begin = _renoir_gl450_trace_gpu_begin(self);
+
+	_renoir_gl450_command_stream_for_each(stream, [self](Renoir_Command* command) {
+		_renoir_gl450_command_execute(self, command);
+		_renoir_gl450_command_free(self, command);
+	});
+	// pending merged draws point into the stream memory so they should be issued before releasing it
+	_renoir_gl450_draw_batch_flush(self);
+	_renoir_gl450_command_stream_release(stream);
+
+	_renoir_gl450_trace_gpu_end(self, "execute", trace_gpu_begin);
+	_renoir_gl450_trace_end(self, "execute", trace_begin);
+}
+
+// frees the commands without executing them then releases the stream
+static void
+_renoir_gl450_command_stream_free(IRenoir* self, Renoir_Command_Stream& stream)
+{
+	_renoir_gl450_command_stream_for_each(stream, [self](Renoir_Command* command) {
+		_renoir_gl450_command_free(self, command);
+	});
+	_renoir_gl450_command_stream_release(stream);
+}
+
+// global commands are allocated in the global command stream
+static Renoir_Command*
+_renoir_gl450_command_new(IRenoir* self, RENOIR_COMMAND_KIND kind, size_t extra_size = 0)
+{
+	return _renoir_gl450_command_stream_push(self->allocator, self->commands, kind, extra_size);
+}
+
+// the payload (upload bytes) of the command lives right after it in the same chunk, so it's
+// released with the chunk once the command is executed without any extra heap allocation
+inline static void*
+_renoir_gl450_command_payload(Renoir_Command* command)
+{
+	return (uint8_t*)command + _renoir_gl450_command_size(command->kind);
+}
+
+inline static GLuint
+_renoir_gl450_profile_query_new(IRenoir* self)
+{
+	if (self->profile_queries.count > 0)
+	{
+		auto res = mn::buf_top(self->profile_queries);
+		mn::buf_pop(self->profile_queries);
+		return res;
+	}
+
+	GLuint res = 0;
+	glGenQueries(1, &res);
+	return res;
+}
+
+static void
+_renoir_gl450_profile_scope_begin(IRenoir* self, const char* name, size_t name_size)
+{
+	auto& frame = self->profile_frames[self->profile_frame % RENOIR_CONSTANT_PROFILER_FRAME_COUNT];
+
+	Renoir_GL450_Profile_Scope scope{};
+	scope.name_offset = frame.names.count;
+	scope.depth = int(self->profile_stack.count);
+	scope.queries[0] = _renoir_gl450_profile_query_new(self);
+	glQueryCounter(scope.queries[0], GL_TIMESTAMP);
+
+	mn::buf_resize(frame.names, frame.names.count + name_size + 1);
+	::memcpy(frame.names.ptr + scope.name_offset, name, name_size);
+	frame.names[scope.name_offset + name_size] = '\0';
+
+	mn::buf_push(self->profile_stack, frame.scopes.count);
+	mn::buf_push(frame.scopes, scope);
+}
+
+static void
+_renoir_gl450_profile_scope_end(IRenoir* self)
+{
+	if (self->profile_stack.count == 0)
+	{
+		mn::log_error("profile_end without a matching profile_begin");
+		return;
+	}
+
+	auto& frame = self->profile_frames[self->profile_frame % RENOIR_CONSTANT_PROFILER_FRAME_COUNT];
+	auto& scope = frame.scopes[mn::buf_top(self->profile_stack)];
+	mn::buf_pop(self->profile_stack);
+
+	scope.queries[1] = _renoir_gl450_profile_query_new(self);
+	glQueryCounter(scope.queries[1], GL_TIMESTAMP);
+	frame.last_query = scope.queries[1];
+}
+
+inline static void
+_renoir_gl450_profile_frame_recycle(IRenoir* self, Renoir_GL450_Profile_Frame& frame)
+{
+	for (const auto& scope: frame.scopes)
+	{
+		mn::buf_push(self->profile_queries, scope.queries[0]);
+		mn::buf_push(self->profile_queries, scope.queries[1]);
+	}
+	mn::buf_clear(frame.scopes);
+	mn::buf_clear(frame.names);
+	frame.pending = false;
+}
+
+// reads the timestamps of the finished frames without waiting for the gpu, the newest finished frame becomes the results
+static void
+_renoir_gl450_profile_frame_end(IRenoir* self)
+{
+	auto& frame = self->profile_frames[self->profile_frame % RENOIR_CONSTANT_PROFILER_FRAME_COUNT];
+	bool used = frame.scopes.count > 0;
+	for (const auto& f: self->profile_frames)
+		used |= f.pending;
+	// profiler is not used so there's nothing to resolve
+	if (used == false)
+	{
+		++self->profile_frame;
+		return;
+	}
+
+	renoir_gl450_context_bind(self->ctx);
+
+	if (self->profile_stack.count > 0)
+	{
+		mn::log_warning("{} profile scopes were not ended in the frame they began", self->profile_stack.count);
+		while (self->profile_stack.count > 0)
+			_renoir_gl450_profile_scope_end(self);
+	}
+
+	frame.index = self->profile_frame;
+	frame.pending = frame.scopes.count > 0;
+	++self->profile_frame;
+
+	// go over the frames from the oldest to the newest, timestamps complete in order so we stop at the first unfinished frame
+	for (size_t i = 0; i < RENOIR_CONSTANT_PROFILER_FRAME_COUNT; ++i)
+	{
+		auto& f = self->profile_frames[(self->profile_frame + i) % RENOIR_CONSTANT_PROFILER_FRAME_COUNT];
+		if (f.pending == false)
+			continue;
+
+		GLint available = 0;
+		glGetQueryObjectiv(f.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0)
+			break;
+
+		// names are swapped into the results so that the name pointers stay valid until the next resolve
+		mn::mutex_lock(self->stats_mtx);
+		auto names = self->profile_results_names;
+		self->profile_results_names = f.names;
+		f.names = names;
+
+		mn::buf_clear(self->profile_results);
+		for (const auto& scope: f.scopes)
+		{
+			GLuint64 timepoint[2];
+			glGetQueryObjectui64v(scope.queries[0], GL_QUERY_RESULT, &timepoint[0]);
+			glGetQueryObjectui64v(scope.queries[1], GL_QUERY_RESULT, &timepoint[1]);
+
+			Renoir_Profile_Scope result{};
+			result.name = self->profile_results_names.ptr + scope.name_offset;
+			result.depth = scope.depth;
+			result.elapsed_time_in_nanos = timepoint[1] - timepoint[0];
+			mn::buf_push(self->profile_results, result);
+		}
+		self->profile_results_frame = f.index;
+		self->profile_results_ready = true;
+		mn::mutex_unlock(self->stats_mtx);
+
+		_renoir_gl450_profile_frame_recycle(self, f);
+	}
+
+	// the gpu is more than RENOIR_CONSTANT_PROFILER_FRAME_COUNT frames behind, so drop the oldest frame to reuse its slot
+	auto& next = self->profile_frames[self->profile_frame % RENOIR_CONSTANT_PROFILER_FRAME_COUNT];
+	if (next.pending)
+		_renoir_gl450_profile_frame_recycle(self, next);
+	mn_assert(_renoir_gl450_check());
+}
+
+// the gpu events are only recorded after init since the queries need the context, returns 0 otherwise
+static GLuint
+_renoir_gl450_trace_gpu_begin(IRenoir* self)
+{
+	if (self->glewInited == false || self->trace_enabled.load(std::memory_order_relaxed) == false)
+		return 0;
+
+	auto query = _renoir_gl450_profile_query_new(self);
+	glQueryCounter(query, GL_TIMESTAMP);
+	return query;
+}
+
+static void
+_renoir_gl450_trace_gpu_end(IRenoir* self, const char* name, GLuint begin_query)
+{
+	if (begin_query == 0)
+		return;
+
+	Renoir_GL450_Trace_Gpu_Scope scope{};
+	scope.name = name;
+	scope.queries[0] = begin_query;
+	scope.queries[1] = _renoir_gl450_profile_query_new(self);
+	glQueryCounter(scope.queries[1], GL_TIMESTAMP);
+	mn::buf_push(self->trace_gpu_scopes, scope);
+}
+
+// reads the finished gpu scopes without waiting for the gpu, the timestamps are converted to the cpu clock using
+// the offset between GL_TIMESTAMP and the cpu clock which is measured every time they're resolved
+static void
+_renoir_gl450_trace_gpu_resolve(IRenoir* self)
+{
+	if (self->trace_gpu_scopes.count == 0)
+		return;
+
+	renoir_gl450_context_bind(self->ctx);
+
+	GLint64 gpu_now = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+	auto offset = int64_t(_renoir_gl450_time_in_nanos()) - gpu_now;
+
+	if (self->trace_gpu_ring == nullptr)
+	{
+		mn::mutex_lock(self->trace_mtx);
+		self->trace_gpu_ring = mn::alloc_zerod<Renoir_GL450_Trace_Ring>();
+		self->trace_gpu_ring->name = "gpu";
+		mn::mutex_unlock(self->trace_mtx);
+	}
+
+	// timestamps complete in order so we stop at the first unfinished scope
+	size_t resolved = 0;
+	for (const auto& scope: self->trace_gpu_scopes)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(scope.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0)
+			break;
+
+		GLuint64 timepoint[2];
+		glGetQueryObjectui64v(scope.queries[0], GL_QUERY_RESULT, &timepoint[0]);
+		glGetQueryObjectui64v(scope.queries[1], GL_QUERY_RESULT, &timepoint[1]);
+		_renoir_gl450_trace_ring_push(self->trace_gpu_ring, scope.name, timepoint[0] + offset, timepoint[1] + offset);
+
+		mn::buf_push(self->profile_queries, scope.queries[0]);
+		mn::buf_push(self->profile_queries, scope.queries[1]);
+		++resolved;
+	}
+
+	if (resolved > 0)
+	{
+		auto scopes = self->trace_gpu_scopes.ptr;
+		::memmove(scopes, scopes + resolved, (self->trace_gpu_scopes.count - resolved) * sizeof(*scopes));
+		mn::buf_resize(self->trace_gpu_scopes, self->trace_gpu_scopes.count - resolved);
+	}
+	mn_assert(_renoir_gl450_check());
+}
+
+static void
+_renoir_gl450_fence_wait(GLsync fence)
+{
+	while (true)
+	{
+		auto res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED)
+			break;
+
+		if (res == GL_WAIT_FAILED)
+		{
+			mn::log_error("failed to wait for gl fence");
+			break;
+		}
+	}
+}
+
+// copies the staging buffer into the readback data once the gpu is done with it, returns whether the readback is ready
+static bool
+_renoir_gl450_readback_resolve(IRenoir* self, Renoir_Handle* h, bool wait)
+{
+	if (h->readback.ready)
+		return true;
+
+	// this means that the readback command didn't execute yet
+	if (h->readback.fence == 0)
+		return false;
+
+	renoir_gl450_context_bind(self->ctx);
+	if (wait)
+	{
+		_renoir_gl450_fence_wait(h->readback.fence);
+	}
+	else
+	{
+		auto res = glClientWaitSync(h->readback.fence, 0, 0);
+		if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED)
+			return false;
+	}
+
+	glGetNamedBufferSubData(h->readback.staging, 0, h->readback.size, h->readback.data);
+	mn_assert(_renoir_gl450_check());
+
+	for (size_t i = 0; i < self->pending_readbacks.count; ++i)
+	{
+		if (self->pending_readbacks[i] == h)
+		{
+			mn::buf_remove(self->pending_readbacks, i);
+			break;
+		}
+	}
+
+	h->readback.ready = true;
+	return true;
+}
+
+// called by present/flush under mtx, it moves the global command stream out into the returned frame so the
+// api threads can record the next frame while it's executing
+static Renoir_GL450_Frame
+_renoir_gl450_frame_submit(IRenoir* self, Renoir_Handle* swapchain)
+{
+	auto upload_bytes = self->upload_bytes_frame.exchange(0);
+	self->upload_bytes_last_frame = upload_bytes;
+	if (upload_bytes > self->upload_bytes_high_water)
+		self->upload_bytes_high_water = upload_bytes;
+
+	// record the bytes streamed this frame, the executor fences them once it executes the frame
+	mn::mutex_lock(self->stream_mtx);
+	for (auto h: self->stream_buffers)
+	{
+		if (h->buffer.stream_frame_size == 0)
+			continue;
+
+		Renoir_GL450_Stream_Region region{};
+		region.buffer = h;
+		region.frame = self->frame_index;
+		region.begin = h->buffer.stream_frame_begin;
+		region.size = h->buffer.stream_frame_size;
+		mn::buf_push(self->stream_regions, region);
+
+		h->buffer.stream_frame_begin = h->buffer.stream_head;
+		h->buffer.stream_frame_size = 0;
+	}
+	mn::mutex_unlock(self->stream_mtx);
+
+	Renoir_GL450_Frame frame{};
+	frame.commands = self->commands;
+	frame.swapchain = swapchain;
+	frame.index = self->frame_index++;
+	self->commands = Renoir_Command_Stream{};
+
+#if RENOIR_STATS
+	// the hold time of this lock is counted in the next frame since it's still held
+	frame.mtx_locks = self->mtx_locks_frame;
+	frame.mtx_wait_time_in_nanos = self->mtx_wait_time_frame;
+	frame.mtx_hold_time_in_nanos = self->mtx_hold_time_frame;
+	self->mtx_locks_frame = 0;
+	self->mtx_wait_time_frame = 0;
+	self->mtx_hold_time_frame = 0;
+#endif
+	return frame;
+}
+
+// called by the executor after it executes the frame's commands, which marks the end of the frame
+static void
+_renoir_gl450_frame_end(IRenoir* self, const Renoir_GL450_Frame& frame)
+{
+	auto frame_index = frame.index;
+
+#if RENOIR_STATS
+	self->frame_stats.frame = frame_index;
+	self->frame_stats.mtx_locks = frame.mtx_locks;
+	self->frame_stats.mtx_wait_time_in_nanos = frame.mtx_wait_time_in_nanos;
+	self->frame_stats.mtx_hold_time_in_nanos = frame.mtx_hold_time_in_nanos;
+#endif
+
+	mn::mutex_lock(self->stats_mtx);
+	self->gl_state_calls_emitted_last_frame = self->gl_state_calls_emitted_frame;
+	self->gl_state_calls_skipped_last_frame = self->gl_state_calls_skipped_frame;
+#if RENOIR_STATS
+	self->frame_stats_last = self->frame_stats;
+#endif
+	mn::mutex_unlock(self->stats_mtx);
+	self->gl_state_calls_emitted_frame = 0;
+	self->gl_state_calls_skipped_frame = 0;
+#if RENOIR_STATS
+	self->frame_stats = Renoir_Frame_Stats{};
+#endif
+
+	// fence the bytes streamed this frame so they're not overwritten while the gpu is still reading them
+	mn::mutex_lock(self->stream_mtx);
+	for (auto& region: self->stream_regions)
+	{
+		if (region.frame != frame_index)
+			continue;
+
+		mn_assert(region.fence == 0);
+		renoir_gl450_context_bind(self->ctx);
+		region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	mn::mutex_unlock(self->stream_mtx);
+
+	// resolve removes the readback from the pending list so go over it backwards
+	for (size_t i = self->pending_readbacks.count; i > 0; --i)
+		_renoir_gl450_readback_resolve(self, self->pending_readbacks[i - 1], false);
+
+	// poll removes the program from the builds list so go over it backwards
+	if (self->program_builds.count > 0)
+		renoir_gl450_context_bind(self->ctx);
+	for (size_t i = self->program_builds.count; i > 0; --i)
+		_renoir_gl450_program_poll(self, self->program_builds[i - 1]);
+
+	_renoir_gl450_trace_gpu_resolve(self);
+	_renoir_gl450_profile_frame_end(self);
+}
+
+// region may wrap around the end of the buffer while the range [offset, offset + size) doesn't
+inline static bool
+_renoir_gl450_stream_region_overlaps(const Renoir_GL450_Stream_Region& region, size_t capacity, size_t offset, size_t size)
+{
+	auto overlaps = [](size_t a_begin, size_t a_end, size_t b_begin, size_t b_end) {
+		return a_begin < b_end && b_begin < a_end;
+	};
+
+	auto region_end = region.begin + region.size;
+	if (region_end <= capacity)
+		return overlaps(region.begin, region_end, offset, offset + size);
+
+	return overlaps(region.begin, capacity, offset, offset + size) ||
+		overlaps(0, region_end - capacity, offset, offset + size);
+}
+
+// waits for the regions of the previous frames which overlap the range, the range is passed as a region of the same buffer
+static void
+_renoir_gl450_stream_wait_job(IRenoir* self, void* data)
+{
+	auto range = (Renoir_GL450_Stream_Region*)data;
+	auto h = range->buffer;
+
+	mn::mutex_lock(self->stream_mtx);
+	mn_defer{mn::mutex_unlock(self->stream_mtx);};
+
+	for (size_t i = 0; i < self->stream_regions.count;)
+	{
+		auto& region = self->stream_regions[i];
+		if (region.buffer == h && _renoir_gl450_stream_region_overlaps(region, h->buffer.size, range->begin, range->size))
+		{
+			// jobs run after the frames submitted before them so the region's frame was executed
+			mn_assert(region.fence != 0);
+			renoir_gl450_context_bind(self->ctx);
+			_renoir_gl450_fence_wait(region.fence);
+			glDeleteSync(region.fence);
+			mn::buf_remove_ordered(self->stream_regions, i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+static void
+_renoir_gl450_readback_wait_job(IRenoir* self, void* data)
+{
+	_renoir_gl450_readback_resolve(self, (Renoir_Handle*)data, true);
+}
+
+// blocking reads run on the thread which owns the context, a resource which wasn't created yet reads as zeros
+static void
+_renoir_gl450_read_job(IRenoir* self, void* data)
+{
+	auto command = (Renoir_Command*)data;
+	if (command->kind == RENOIR_COMMAND_KIND_BUFFER_READ && command->buffer_read.handle->buffer.id == 0)
+	{
+		::memset(command->buffer_read.bytes, 0, command->buffer_read.bytes_size);
+		return;
+	}
+
+	if (command->kind == RENOIR_COMMAND_KIND_TEXTURE_READ && command->texture_read.handle->texture.id == 0)
+	{
+		::memset(command->texture_read.desc.bytes, 0, command->texture_read.desc.bytes_size);
+		return;
+	}
+
+	_renoir_gl450_command_execute(self, command);
+}
+
+static void
+_renoir_gl450_command_execute_job(IRenoir* self, void* data)
+{
+	_renoir_gl450_command_execute(self, (Renoir_Command*)data);
+}
+
+// queues a frame or a job to the render thread and returns its ticket, frames block while settings.frames_in_flight
+// frames are queued so the api threads can't get too far ahead of the gpu
+static uint64_t
+_renoir_gl450_render_thread_push(IRenoir* self, const Renoir_GL450_Frame& frame)
+{
+	mn::mutex_lock(self->queue_mtx);
+	mn_defer{mn::mutex_unlock(self->queue_mtx);};
+
+	if (frame.job == nullptr)
+	{
+		while (self->queue_frames >= self->settings.frames_in_flight)
+			mn::cond_var_wait(self->queue_cv, self->queue_mtx);
+		++self->queue_frames;
+	}
+
+	mn::buf_push(self->queue, frame);
+	auto ticket = ++self->queue_pushed;
+	mn::cond_var_notify_all(self->queue_cv);
+	return ticket;
+}
+
+// blocks until the render thread executes everything up to the ticket
+static void
+_renoir_gl450_render_thread_wait(IRenoir* self, uint64_t ticket)
+{
+	mn::mutex_lock(self->queue_mtx);
+	while (self->queue_executed < ticket)
+		mn::cond_var_wait(self->queue_cv, self->queue_mtx);
+	mn::mutex_unlock(self->queue_mtx);
+}
+
+static void
+_renoir_gl450_render_thread_main(void* arg)
+{
+	auto self = (IRenoir*)arg;
+
+	if (self->settings.trace)
+		_renoir_gl450_trace_ring(self, "render thread");
+
+	renoir_gl450_context_bind(self->ctx);
+	while (true)
+	{
+		mn::mutex_lock(self->queue_mtx);
+		while (self->queue.count == 0 && self->queue_quit == false)
+			mn::cond_var_wait(self->queue_cv, self->queue_mtx);
+
+		// the queued frames are executed before quitting
+		if (self->queue.count == 0)
+		{
+			mn::mutex_unlock(self->queue_mtx);
+			break;
+		}
+
+		auto frame = self->queue[0];
+		mn::buf_remove_ordered(self->queue, 0);
+		mn::mutex_unlock(self->queue_mtx);
+
+		if (frame.job)
+		{
+			frame.job(self, frame.job_data);
+		}
+		else
+		{
+			_renoir_gl450_command_stream_execute(self, frame.commands);
+			_renoir_gl450_frame_end(self, frame);
+			if (frame.swapchain)
+				renoir_gl450_context_window_present(self->ctx, frame.swapchain);
+		}
+
+		mn::mutex_lock(self->queue_mtx);
+		++self->queue_executed;
+		if (frame.job == nullptr)
+			--self->queue_frames;
+		mn::cond_var_notify_all(self->queue_cv);
+		mn::mutex_unlock(self->queue_mtx);
+	}
+	renoir_gl450_context_unbind(self->ctx);
+}
+
+// runs fn on the thread which owns the context and waits for it, in render thread mode it runs on the render thread
+// after the frames submitted so far, otherwise it runs on the calling thread, it should be called with mtx locked
+static void
+_renoir_gl450_sync_run(IRenoir* self, void (*fn)(IRenoir*, void*), void* data)
+{
+	if (self->settings.render_thread == false)
+	{
+		mn::mutex_lock(self->exec_mtx);
+		fn(self, data);
+		mn::mutex_unlock(self->exec_mtx);
+		return;
+	}
+
+	Renoir_GL450_Frame frame{};
+	frame.job = fn;
+	frame.job_data = data;
+	auto ticket = _renoir_gl450_render_thread_push(self, frame);
+	_renoir_gl450_render_thread_wait(self, ticket);
+}
+
+static void
+_renoir_gl450_command_process(IRenoir* self, Renoir_Command* command)
+{
+	// in deferred mode the command is already in the global stream waiting for flush/present
+	if (self->settings.defer_api_calls)
+		return;
+
+	mn::mutex_lock(self->exec_mtx);
+	_renoir_gl450_command_execute(self, command);
+	mn::mutex_unlock(self->exec_mtx);
+	_renoir_gl450_command_free(self, command);
+	_renoir_gl450_command_stream_pop(self->commands, command);
+}
+
+inline static Renoir_Pass_Recorder&
+_renoir_gl450_pass_recorder(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		return h->raster_pass.recorder;
+	mn_assert_msg(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS, "invalid pass");
+	return h->compute_pass.recorder;
+}
+
+// returns the pass the commands will execute in, which is the parent in case of secondary passes
+inline static Renoir_Handle*
+_renoir_gl450_pass_primary(Renoir_Handle* h)
+{
+	auto parent = _renoir_gl450_pass_recorder(h).parent;
+	return parent ? parent : h;
+}
+
+// pass commands are allocated in the pass command stream without taking any lock, so every pass
+// should only be recorded from one thread at a time, extra_size is used by commands with trailing data
+static Renoir_Command*
+_renoir_gl450_pass_command_new(Renoir_Handle* h, RENOIR_COMMAND_KIND kind, size_t extra_size = 0)
+{
+	auto& recorder = _renoir_gl450_pass_recorder(h);
+
+	// the first command in the pass stream is always the pass begin command, secondary passes
+	// don't have one since they're merged into their parent's stream
+	if (recorder.commands.head == nullptr && recorder.parent == nullptr)
+	{
+		auto command = _renoir_gl450_command_stream_push(recorder.allocator, recorder.commands, RENOIR_COMMAND_KIND_PASS_BEGIN, 0);
+		command->pass_begin.handle = h;
+	}
+
+	return _renoir_gl450_command_stream_push(recorder.allocator, recorder.commands, kind, extra_size);
+}
+
+// whether the pass begin command has to execute even if nothing was recorded to apply the clear load actions
+inline static bool
+_renoir_gl450_pass_load_clears(Renoir_Handle* h)
+{
+	if (h->kind != RENOIR_HANDLE_KIND_RASTER_PASS || h->raster_pass.swapchain != nullptr)
+		return false;
+
+	const auto& offscreen = h->raster_pass.offscreen;
+	for (const auto& attachment: offscreen.color)
+		if (attachment.texture.handle != nullptr && attachment.load == RENOIR_LOAD_ACTION_CLEAR)
+			return true;
+	return offscreen.depth_stencil.texture.handle != nullptr && offscreen.depth_stencil.load == RENOIR_LOAD_ACTION_CLEAR;
+}
+
+inline static uint64_t
+_renoir_gl450_vertex_layout(const Renoir_Vertex_Desc* vertex_buffers, int vertex_buffers_count)
+{
+	uint64_t res = 0;
+	for (int i = 0; i < vertex_buffers_count; ++i)
+	{
+		if (vertex_buffers[i].buffer.handle == nullptr)
+			continue;
+		res |= uint64_t(vertex_buffers[i].type) << (i * RENOIR_GL450_VERTEX_LAYOUT_BITS);
+	}
+	return res;
+}
+
+static Renoir_GL450_Vertex_Array*
+_renoir_gl450_vertex_array_get(IRenoir* self, uint64_t layout)
+{
+	if (auto it = mn::map_lookup(self->vertex_arrays, layout))
+		return &it->value;
+
+	Renoir_GL450_Vertex_Array vertex_array{};
+	glCreateVertexArrays(1, &vertex_array.vao);
+	for (GLuint i = 0; i < RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE; ++i)
+	{
+		auto type = RENOIR_TYPE((layout >> (i * RENOIR_GL450_VERTEX_LAYOUT_BITS)) & ((1 << RENOIR_GL450_VERTEX_LAYOUT_BITS) - 1));
+		if (type == RENOIR_TYPE_NONE)
+			continue;
+
+		GLint gl_size = _renoir_type_to_gl_element_count(type);
+		GLenum gl_type = _renoir_type_to_gl(type);
+		if (_renoir_type_is_int(type))
+			glVertexArrayAttribIFormat(vertex_array.vao, i, gl_size, gl_type, 0);
+		else
+			glVertexArrayAttribFormat(vertex_array.vao, i, gl_size, gl_type, _renoir_type_normalized(type), 0);
+		glVertexArrayAttribBinding(vertex_array.vao, i, i);
+		glEnableVertexArrayAttrib(vertex_array.vao, i);
+	}
+	return &mn::map_insert(self->vertex_arrays, layout, vertex_array)->value;
+}
+
+// binds the vertex array of the layout and (re)binds the vertex/index buffers if they changed
+static void
+_renoir_gl450_vertex_array_bind(IRenoir* self, uint64_t layout, const Renoir_Vertex_Desc* vertex_buffers, int vertex_buffers_count, Renoir_Buffer index_buffer)
+{
+	auto vertex_array = _renoir_gl450_vertex_array_get(self, layout);
+	if (self->current_vao != vertex_array->vao)
+	{
+		glBindVertexArray(vertex_array->vao);
+		self->current_vao = vertex_array->vao;
+	}
+
+	GLuint buffers[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE]{};
+	GLintptr offsets[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE]{};
+	GLsizei strides[RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE]{};
+	for (int i = 0; i < vertex_buffers_count; ++i)
+	{
+		auto& vertex = vertex_buffers[i];
+		if (vertex.buffer.handle == nullptr)
+			continue;
+
+		auto h = (Renoir_Handle*)vertex.buffer.handle;
+		buffers[i] = h->buffer.id;
+		offsets[i] = vertex.offset;
+		strides[i] = vertex.stride;
+	}
+
+	// only rebind the vertex buffers if they differ from the ones already bound to this vertex array
+	if (::memcmp(buffers, vertex_array->buffers, sizeof(buffers)) != 0 ||
+		::memcmp(offsets, vertex_array->offsets, sizeof(offsets)) != 0 ||
+		::memcmp(strides, vertex_array->strides, sizeof(strides)) != 0)
+	{
+		glVertexArrayVertexBuffers(vertex_array->vao, 0, RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE, buffers, offsets, strides);
+		::memcpy(vertex_array->buffers, buffers, sizeof(buffers));
+		::memcpy(vertex_array->offsets, offsets, sizeof(offsets));
+		::memcpy(vertex_array->strides, strides, sizeof(strides));
+	}
+
+	if (auto h = (Renoir_Handle*)index_buffer.handle)
+	{
+		if (vertex_array->index_buffer != h->buffer.id)
+		{
+			glVertexArrayElementBuffer(vertex_array->vao, h->buffer.id);
+			vertex_array->index_buffer = h->buffer.id;
+		}
+	}
+}
+
+// copies the used prefix of the vertex slots, fills in the default strides, and returns the vertex layout
+static uint64_t
+_renoir_gl450_vertex_buffers_copy(Renoir_Vertex_Desc* dst, const Renoir_Vertex_Desc* src, int vertex_buffers_count)
+{
+	::memcpy(dst, src, vertex_buffers_count * sizeof(Renoir_Vertex_Desc));
+	for (int i = 0; i < vertex_buffers_count; ++i)
+	{
+		// calculate the default stride for the vertex buffer
+		auto& vertex = dst[i];
+		_renoir_gl450_handle_get(vertex.buffer);
+		if (vertex.buffer.handle != nullptr && vertex.stride == 0)
+			vertex.stride = _renoir_type_to_size(vertex.type);
+	}
+	return _renoir_gl450_vertex_layout(dst, vertex_buffers_count);
+}
+
+// we only store the vertex slots up to the last used one
+inline static int
+_renoir_gl450_vertex_buffers_count(const Renoir_Vertex_Desc* vertex_buffers)
+{
+	int res = 0;
+	for (int i = 0; i < RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE; ++i)
+	{
+		if (vertex_buffers[i].buffer.handle != nullptr)
+			res = i + 1;
+	}
+	return res;
+}
+
+static void
+_renoir_gl450_draw_execute(IRenoir* self, Renoir_Command* command)
+{
+	auto& desc = command->draw;
+	_renoir_gl450_vertex_array_bind(self, desc.layout, desc.vertex_buffers, desc.vertex_buffers_count, desc.index_buffer);
+
+	auto gl_primitive = _renoir_primitive_to_gl(desc.primitive);
+	if (desc.index_buffer.handle != nullptr)
+	{
+		auto gl_index_type = _renoir_type_to_gl(desc.index_type);
+		auto gl_index_type_size = _renoir_type_to_size(desc.index_type);
+
+		if (desc.instances_count > 1)
+		{
+			glDrawElementsInstanced(
+				gl_primitive,
+				desc.elements_count,
+				gl_index_type,
+				(void*)(desc.base_element * gl_index_type_size),
+				desc.instances_count
+			);
+		}
+		else
+		{
+			glDrawElements(
+				gl_primitive,
+				desc.elements_count,
+				gl_index_type,
+				(void*)(desc.base_element * gl_index_type_size)
+			);
+		}
+	}
+	else
+	{
+		if (desc.instances_count > 1)
+			glDrawArraysInstanced(gl_primitive, desc.base_element, desc.elements_count, desc.instances_count);
+		else
+			glDrawArrays(gl_primitive, desc.base_element, desc.elements_count);
+	}
+}
+
+// draws can be merged if they only differ in their base element and elements count
+inline static bool
+_renoir_gl450_draw_mergeable(const Renoir_Command* a, const Renoir_Command* b)
+{
+	auto& da = a->draw;
+	auto& db = b->draw;
+	return da.instances_count <= 1 &&
+		db.instances_count <= 1 &&
+		da.primitive == db.primitive &&
+		da.index_buffer.handle == db.index_buffer.handle &&
+		da.index_type == db.index_type &&
+		da.layout == db.layout &&
+		da.vertex_buffers_count == db.vertex_buffers_count &&
+		::memcmp(da.vertex_buffers, db.vertex_buffers, da.vertex_buffers_count * sizeof(Renoir_Vertex_Desc)) == 0;
+}
+
+static void
+_renoir_gl450_draw_batch_flush(IRenoir* self)
+{
+	auto first = self->draw_batch_first;
+	if (first == nullptr)
+		return;
+
+	if (self->draw_batch_counts.count == 1)
+	{
+		_renoir_gl450_draw_execute(self, first);
+	}
+	else
+	{
+		auto& desc = first->draw;
+		_renoir_gl450_vertex_array_bind(self, desc.layout, desc.vertex_buffers, desc.vertex_buffers_count, desc.index_buffer);
+
+		auto gl_primitive = _renoir_primitive_to_gl(desc.primitive);
+		if (desc.index_buffer.handle != nullptr)
+		{
+			glMultiDrawElements(
+				gl_primitive,
+				self->draw_batch_counts.ptr,
+				_renoir_type_to_gl(desc.index_type),
+				self->draw_batch_indices.ptr,
+				GLsizei(self->draw_batch_counts.count)
+			);
+		}
+		else
+		{
+			glMultiDrawArrays(
+				gl_primitive,
+				self->draw_batch_firsts.ptr,
+				self->draw_batch_counts.ptr,
+				GLsizei(self->draw_batch_counts.count)
+			);
+		}
+	}
+
+	self->draw_batch_first = nullptr;
+	mn::buf_clear(self->draw_batch_counts);
+	mn::buf_clear(self->draw_batch_firsts);
+	mn::buf_clear(self->draw_batch_indices);
+	mn_assert(_renoir_gl450_check());
+}
+
+static void
+_renoir_gl450_draw_batch_push(IRenoir* self, Renoir_Command* command)
+{
+	if (self->draw_batch_first && _renoir_gl450_draw_mergeable(self->draw_batch_first, command) == false)
+		_renoir_gl450_draw_batch_flush(self);
+
+	if (self->draw_batch_first == nullptr)
+		self->draw_batch_first = command;
+
+	auto& desc = command->draw;
+	mn::buf_push(self->draw_batch_counts, GLsizei(desc.elements_count));
+	if (desc.index_buffer.handle != nullptr)
+		mn::buf_push(self->draw_batch_indices, (const void*)(desc.base_element * _renoir_type_to_size(desc.index_type)));
+	else
+		mn::buf_push(self->draw_batch_firsts, GLint(desc.base_element));
+
+	// instanced draws can't be merged
+	if (desc.instances_count > 1)
+		_renoir_gl450_draw_batch_flush(self);
+}
+
+static GLuint
+_renoir_gl450_framebuffer_new(const Renoir_Pass_Offscreen_Desc& desc)
+{
+	int msaa = -1;
+
+	GLuint fb = 0;
+	glCreateFramebuffers(1, &fb);
+	// we want to initialize this to GL_NONE which is 0 so this initialization is safe
+	GLenum attachments[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE] = {};
+	for (size_t i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+	{
+		auto color = (Renoir_Handle*)desc.color[i].texture.handle;
+		if (color == nullptr)
+			continue;
+		attachments[i] = GL_COLOR_ATTACHMENT0 + i;
+
+		if (color->texture.desc.cube_map == false)
+		{
+			if (color->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+			{
+				mn_assert_msg(desc.color[i].level == 0, "multisampled textures does not support mipmaps");
+				glNamedFramebufferRenderbuffer(fb, GL_COLOR_ATTACHMENT0+i,  GL_RENDERBUFFER, color->texture.render_buffer[0]);
+			}
+			else
+			{
+				mn_assert_msg(desc.color[i].level < color->texture.desc.mipmaps, "out of range mip level");
+				glNamedFramebufferTexture(fb, GL_COLOR_ATTACHMENT0+i, color->texture.id, desc.color[i].level);
+			}
+		}
+		else
+		{
+			if (color->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+			{
+				mn_assert_msg(desc.color[i].level == 0, "multisampled textures does not support mipmaps");
+				glNamedFramebufferRenderbuffer(fb, GL_COLOR_ATTACHMENT0+i,  GL_RENDERBUFFER, color->texture.render_buffer[desc.color[i].subresource]);
+			}
+			else
+			{
+				mn_assert_msg(desc.color[i].level < color->texture.desc.mipmaps, "out of range mip level");
+				mn_assert(_renoir_gl450_check());
+				glBindFramebuffer(GL_FRAMEBUFFER, fb);
+				glFramebufferTexture2D(
+					GL_FRAMEBUFFER,
+					GL_COLOR_ATTACHMENT0 + i,
+					GL_TEXTURE_CUBE_MAP_POSITIVE_X + desc.color[i].subresource,
+					color->texture.id,
+					desc.color[i].level
+				);
+				mn_assert(_renoir_gl450_check());
+			}
+		}
+
+		// check that all of them has the same msaa
+		if (msaa == -1)
+		{
+			msaa = color->texture.desc.msaa;
+		}
+		else
+		{
+			mn_assert(msaa == color->texture.desc.msaa);
+		}
+	}
+	glNamedFramebufferDrawBuffers(fb, RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE, attachments);
+	mn_assert(_renoir_gl450_check());
+
+	auto depth = (Renoir_Handle*)desc.depth_stencil.texture.handle;
+	if (depth)
+	{
+		auto attachment = _renoir_pixelformat_to_depth_attachment(depth->texture.desc.pixel_format);
+
+		if (depth->texture.desc.cube_map == false)
+		{
+			if (depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+			{
+				mn_assert_msg(desc.depth_stencil.level == 0, "multisampled textures does not support mipmaps");
+				glNamedFramebufferRenderbuffer(fb, attachment,  GL_RENDERBUFFER, depth->texture.render_buffer[0]);
+			}
+			else
+			{
+				mn_assert_msg(desc.depth_stencil.level < depth->texture.desc.mipmaps, "out of range mip level");
+				glNamedFramebufferTexture(fb, attachment, depth->texture.id, desc.depth_stencil.level);
+			}
+		}
+		else
+		{
+			if (depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+			{
+				mn_assert_msg(desc.depth_stencil.level == 0, "multisampled textures does not support mipmaps");
+				glNamedFramebufferRenderbuffer(fb, attachment,  GL_RENDERBUFFER, depth->texture.render_buffer[desc.depth_stencil.subresource]);
+			}
+			else
+			{
+				mn_assert_msg(desc.depth_stencil.level < depth->texture.desc.mipmaps, "out of range mip level");
+				glBindFramebuffer(GL_FRAMEBUFFER, fb);
+				glFramebufferTexture2D(
+					GL_FRAMEBUFFER,
+					attachment,
+					GL_TEXTURE_CUBE_MAP_POSITIVE_X + desc.depth_stencil.subresource,
+					depth->texture.id,
+					desc.depth_stencil.level
+				);
+			}
+		}
+
+		// check that all of them has the same msaa
+		if (msaa == -1)
+		{
+			msaa = depth->texture.desc.msaa;
+		}
+		else
+		{
+			mn_assert(msaa == depth->texture.desc.msaa);
+		}
+	}
+	mn_assert(_renoir_gl450_check());
+	mn_assert(glCheckNamedFramebufferStatus(fb, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	return fb;
+}
+
+// offscreen passes with the same attachments share the same framebuffer
+static GLuint
+_renoir_gl450_framebuffer_get(IRenoir* self, const Renoir_Pass_Offscreen_Desc& desc)
+{
+	// unused attachments should have the same key regardless of their level and subresource
+	auto key_attachment = [](const Renoir_Pass_Attachment& attachment) {
+		Renoir_GL450_Framebuffer_Attachment res{};
+		if (attachment.texture.handle == nullptr)
+			return res;
+		res.texture = attachment.texture.handle;
+		res.subresource = attachment.subresource;
+		res.level = attachment.level;
+		return res;
+	};
+
+	Renoir_GL450_Framebuffer_Key key{};
+	for (size_t i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+		key.color[i] = key_attachment(desc.color[i]);
+	key.depth_stencil = key_attachment(desc.depth_stencil);
+
+	if (auto it = mn::map_lookup(self->framebuffers, key))
+		return it->value;
+
+	auto fb = _renoir_gl450_framebuffer_new(desc);
+	mn::map_insert(self->framebuffers, key, fb);
+	return fb;
+}
+
+// deletes the cached framebuffers which have the texture attached, should be called before freeing the texture
+static void
+_renoir_gl450_framebuffer_evict(IRenoir* self, Renoir_Handle* texture)
+{
+	mn::buf_clear(self->framebuffers_evicted);
+	for (const auto& [key, fb]: self->framebuffers)
+	{
+		bool attached = key.depth_stencil.texture == texture;
+		for (const auto& color: key.color)
+			attached |= color.texture == texture;
+
+		if (attached)
+			mn::buf_push(self->framebuffers_evicted, key);
+	}
+
+	for (const auto& key: self->framebuffers_evicted)
+	{
+		auto it = mn::map_lookup(self->framebuffers, key);
+		glDeleteFramebuffers(1, &it->value);
+		mn::map_remove(self->framebuffers, key);
+	}
+}
+
+static GLbitfield
+_renoir_barrier_to_gl(int barriers)
+{
+	GLbitfield res = 0;
+	if (barriers & RENOIR_BARRIER_STORAGE)
+		res |= GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT;
+	if (barriers & RENOIR_BARRIER_TEXTURE)
+		res |= GL_TEXTURE_FETCH_BARRIER_BIT;
+	if (barriers & RENOIR_BARRIER_VERTEX)
+		res |= GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT;
+	if (barriers & RENOIR_BARRIER_UNIFORM)
+		res |= GL_UNIFORM_BARRIER_BIT;
+	if (barriers & RENOIR_BARRIER_INDIRECT)
+		res |= GL_COMMAND_BARRIER_BIT;
+	if (barriers & RENOIR_BARRIER_RENDER_TARGET)
+		res |= GL_FRAMEBUFFER_BARRIER_BIT;
+	if (barriers & RENOIR_BARRIER_TRANSFER)
+		res |= GL_BUFFER_UPDATE_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT;
+	return res;
+}
+
+static GLbitfield&
+_renoir_gl450_barrier_bits(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+		return h->buffer.barrier_bits;
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_TEXTURE);
+	return h->texture.barrier_bits;
+}
+
+// a barrier covers all the writes issued before it, so its bits are resolved for every written resource
+static void
+_renoir_gl450_barrier_issue(IRenoir* self, GLbitfield bits)
+{
+	glMemoryBarrier(bits);
+	for (size_t i = 0; i < self->barrier_resources.count;)
+	{
+		auto& resource_bits = _renoir_gl450_barrier_bits(self->barrier_resources[i]);
+		resource_bits &= ~bits;
+		if (resource_bits == 0)
+			mn::buf_remove(self->barrier_resources, i);
+		else
+			++i;
+	}
+}
+
+// issues a barrier before the given use of the resource if it's needed to see the last compute write
+static void
+_renoir_gl450_barrier_use(IRenoir* self, Renoir_Handle* h, GLbitfield use)
+{
+	if (h == nullptr || self->barrier_resources.count == 0)
+		return;
+
+	auto bits = _renoir_gl450_barrier_bits(h) & use;
+	if (bits != 0)
+		_renoir_gl450_barrier_issue(self, bits);
+}
+
+static void
+_renoir_gl450_barrier_written(IRenoir* self, Renoir_Handle* h)
+{
+	auto& bits = _renoir_gl450_barrier_bits(h);
+	if (bits == 0)
+		mn::buf_push(self->barrier_resources, h);
+	bits = GL_ALL_BARRIER_BITS;
+}
+
+static void
+_renoir_gl450_barrier_forget(IRenoir* self, Renoir_Handle* h)
+{
+	if (_renoir_gl450_barrier_bits(h) == 0)
+		return;
+
+	for (size_t i = 0; i < self->barrier_resources.count; ++i)
+	{
+		if (self->barrier_resources[i] == h)
+		{
+			mn::buf_remove(self->barrier_resources, i);
+			break;
+		}
+	}
+}
+
+// checks the bind offset at record time so the error points at the caller, in deferred mode the alignment is only known
+// after the init command executes so the binds recorded before that aren't checked
+inline static void
+_renoir_gl450_buffer_range_check(IRenoir* self, GLenum gl_type, size_t offset)
+{
+	auto alignment = gl_type == GL_UNIFORM_BUFFER ?
+		self->uniform_buffer_offset_alignment.load(std::memory_order_relaxed) :
+		self->storage_buffer_offset_alignment.load(std::memory_order_relaxed);
+	mn_assert_msg(alignment == 0 || offset % alignment == 0, "buffer bind offset should be a multiple of the buffer offset alignment");
+}
+
+// binds the whole buffer if offset and size are 0, otherwise binds the range, size 0 binds the rest of the buffer
+static void
+_renoir_gl450_buffer_range_bind(GLenum gl_type, GLuint slot, Renoir_Handle* h, size_t offset, size_t size)
+{
+	if (offset == 0 && size == 0)
+	{
+		glBindBufferBase(gl_type, slot, h->buffer.id);
+		return;
+	}
+
+	if (size == 0)
+		size = h->buffer.size - offset;
+	mn_assert_msg(offset + size <= h->buffer.size, "buffer bind range is out of the buffer bounds");
+	glBindBufferRange(gl_type, slot, h->buffer.id, (GLintptr)offset, (GLsizeiptr)size);
+}
+
+static void
+_renoir_gl450_binding_set(IRenoir* self, Renoir_Handle* h, GLbitfield barrier, int slot, RENOIR_ACCESS gpu_access)
+{
+	Renoir_GL450_Binding binding{};
+	binding.handle = h;
+	binding.barrier = barrier;
+	binding.slot = slot;
+	binding.write = gpu_access == RENOIR_ACCESS_WRITE || gpu_access == RENOIR_ACCESS_READ_WRITE;
+
+	for (auto& other: self->bindings)
+	{
+		if (other.barrier == barrier && other.slot == slot)
+		{
+			other = binding;
+			return;
+		}
+	}
+	mn::buf_push(self->bindings, binding);
+}
+
+// issues the barriers needed by the bindings of the current pass before a dispatch/draw uses them
+static void
+_renoir_gl450_bindings_barrier(IRenoir* self)
+{
+	if (self->barrier_resources.count == 0)
+		return;
+
+	GLbitfield bits = 0;
+	for (const auto& binding: self->bindings)
+		bits |= _renoir_gl450_barrier_bits(binding.handle) & binding.barrier;
+
+	if (bits != 0)
+		_renoir_gl450_barrier_issue(self, bits);
+}
+
+// instead of a full barrier after every dispatch, the resources it writes are tracked and only the uses which
+// need to see the writes issue a barrier
+static void
+_renoir_gl450_bindings_written(IRenoir* self)
+{
+	if (self->settings.manual_barriers)
+		return;
+
+	for (const auto& binding: self->bindings)
+		if (binding.write)
+			_renoir_gl450_barrier_written(self, binding.handle);
+}
+
+// issues the barriers needed by the vertex and index buffers of a draw
+static void
+_renoir_gl450_draw_barrier(IRenoir* self, const Renoir_Vertex_Desc* vertex_buffers, int vertex_buffers_count, Renoir_Buffer index_buffer)
+{
+	if (self->barrier_resources.count == 0)
+		return;
+
+	for (int i = 0; i < vertex_buffers_count; ++i)
+		_renoir_gl450_barrier_use(self, (Renoir_Handle*)vertex_buffers[i].buffer.handle, GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	_renoir_gl450_barrier_use(self, (Renoir_Handle*)index_buffer.handle, GL_ELEMENT_ARRAY_BARRIER_BIT);
+}
+
+// header of the program binaries in the program cache, the binary data follows it
+struct Renoir_GL450_Program_Cache_Header
+{
+	uint32_t magic;
+	GLenum format;
+	uint64_t key;
+	uint64_t size;
+};
+
+constexpr uint32_t RENOIR_GL450_PROGRAM_CACHE_MAGIC = 0x4E524750; // "PGRN"
+
+// returns 0 if the program cache is disabled
+static uint64_t
+_renoir_gl450_program_cache_key(IRenoir* self, const Renoir_Shader_Blob* shaders, size_t shaders_count)
+{
+	if (self->program_cache_driver.count == 0)
+		return 0;
+
+	auto res = mn::murmur_hash(self->program_cache_driver.ptr, self->program_cache_driver.count);
+	for (size_t i = 0; i < shaders_count; ++i)
+	{
+		res = mn::hash_mix(res, mn::murmur_hash(&shaders[i].size, sizeof(shaders[i].size)));
+		if (shaders[i].bytes != nullptr)
+			res = mn::hash_mix(res, mn::murmur_hash(shaders[i].bytes, shaders[i].size));
+	}
+	// 0 is reserved for the disabled cache
+	return res != 0 ? res : 1;
+}
+
+static mn::Str
+_renoir_gl450_program_cache_file(IRenoir* self, uint64_t key)
+{
+	return mn::strf("{}/{:016x}.glprogram", self->settings.program_cache_path, key);
+}
+
+// loads the cached binary into program, returns false if it's not in the cache or the driver rejected it
+static bool
+_renoir_gl450_program_cache_load(IRenoir* self, uint64_t key, GLuint program)
+{
+	if (key == 0)
+		return false;
+
+	auto filename = _renoir_gl450_program_cache_file(self, key);
+	mn_defer{mn::str_free(filename);};
+
+	auto file = fopen(filename.ptr, "rb");
+	if (file == nullptr)
+		return false;
+	mn_defer{fclose(file);};
+
+	Renoir_GL450_Program_Cache_Header header{};
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+		header.magic != RENOIR_GL450_PROGRAM_CACHE_MAGIC ||
+		header.key != key ||
+		header.size == 0)
+	{
+		return false;
+	}
+
+	// a truncated file shouldn't be handed to the driver even if its header looks valid
+	if (fseek(file, 0, SEEK_END) != 0 || uint64_t(ftell(file)) != sizeof(header) + header.size ||
+		fseek(file, sizeof(header), SEEK_SET) != 0)
+	{
+		mn::log_warning("gl450: program cache file '{}' is truncated, compiling it instead", filename);
+		return false;
+	}
+
+	auto binary = mn::alloc(header.size, alignof(char));
+	mn_defer{mn::free(binary);};
+	if (fread(binary.ptr, 1, header.size, file) != header.size)
+		return false;
+
+	glProgramBinary(program, header.format, binary.ptr, GLsizei(header.size));
+	GLint success = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (success == GL_FALSE)
+	{
+		mn::log_warning("gl450: driver rejected the cached program '{}', compiling it instead", filename);
+		// clear the error generated by the rejected binary if any
+		glGetError();
+		return false;
+	}
+	return true;
+}
+
+static void
+_renoir_gl450_program_cache_save(IRenoir* self, uint64_t key, GLuint program)
+{
+	if (key == 0)
+		return;
+
+	GLint size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+	if (size <= 0)
+		return;
+
+	Renoir_GL450_Program_Cache_Header header{};
+	header.magic = RENOIR_GL450_PROGRAM_CACHE_MAGIC;
+	header.key = key;
+	auto binary = mn::alloc(size, alignof(char));
+	mn_defer{mn::free(binary);};
+	GLsizei length = 0;
+	glGetProgramBinary(program, size, &length, &header.format, binary.ptr);
+	header.size = length;
+
+	auto filename = _renoir_gl450_program_cache_file(self, key);
+	mn_defer{mn::str_free(filename);};
+
+	// the binary is written to a temp file then renamed into place, so a crash, a full disk, or another process
+	// sharing the cache directory never leaves a partially written file behind
+	auto thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+	auto temp_filename = mn::strf("{}.{:x}.tmp", filename, _renoir_gl450_time_in_nanos() ^ thread_id);
+	mn_defer{mn::str_free(temp_filename);};
+
+	auto file = fopen(temp_filename.ptr, "wb");
+	if (file == nullptr)
+	{
+		mn::log_error("gl450: failed to write the program cache file '{}'", filename);
+		return;
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(binary.ptr, 1, header.size, file) == header.size;
+	ok = fclose(file) == 0 && ok;
+	if (ok == false)
+	{
+		mn::log_error("gl450: failed to write the program cache file '{}'", filename);
+		::remove(temp_filename.ptr);
+		return;
+	}
+
+	// rename fails on windows if another process saved the same program first, which is fine since it's the same binary
+	if (::rename(temp_filename.ptr, filename.ptr) != 0)
+		::remove(temp_filename.ptr);
+}
+
+static void
+_renoir_gl450_program_cache_stats(IRenoir* self, uint64_t key, bool loaded, uint64_t start_time)
+{
+	auto elapsed = _renoir_gl450_time_in_nanos() - start_time;
+
+	mn::mutex_lock(self->stats_mtx);
+	if (loaded)
+		self->program_load_time_in_nanos += elapsed;
+	else
+		self->program_compile_time_in_nanos += elapsed;
+
+	if (key != 0)
+	{
+		if (loaded)
+			++self->program_cache_hits;
+		else
+			++self->program_cache_misses;
+	}
+	mn::mutex_unlock(self->stats_mtx);
+}
+
+static GLuint&
+_renoir_gl450_program_id(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_PROGRAM)
+		return h->program.id;
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE);
+	return h->compute.id;
+}
+
+static Renoir_GL450_Program_Build&
+_renoir_gl450_program_build_of(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_PROGRAM)
+		return h->program.build;
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE);
+	return h->compute.build;
+}
+
+static std::atomic<bool>&
+_renoir_gl450_program_ready_flag(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_PROGRAM)
+		return h->program.ready;
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE);
+	return h->compute.ready;
+}
+
+static size_t
+_renoir_gl450_program_shaders_count(Renoir_Handle* h)
+{
+	return h->kind == RENOIR_HANDLE_KIND_PROGRAM ? 3 : 1;
+}
+
+// compiles and links the program without checking the results, so it doesn't wait for the driver threads in parallel mode
+static void
+_renoir_gl450_program_build_begin(Renoir_Handle* h, const Renoir_Shader_Blob* shaders)
+{
+	constexpr GLenum program_types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER};
+	constexpr GLenum compute_types[] = {GL_COMPUTE_SHADER};
+	auto types = h->kind == RENOIR_HANDLE_KIND_PROGRAM ? program_types : compute_types;
+
+	auto id = _renoir_gl450_program_id(h);
+	auto& build = _renoir_gl450_program_build_of(h);
+	for (size_t i = 0; i < _renoir_gl450_program_shaders_count(h); ++i)
+	{
+		if (shaders[i].bytes == nullptr)
+			continue;
+
+		auto shader = glCreateShader(types[i]);
+		GLint size = GLint(shaders[i].size);
+		glShaderSource(shader, 1, &shaders[i].bytes, &size);
+		glCompileShader(shader);
+		glAttachShader(id, shader);
+		build.shaders[i] = shader;
+	}
+
+	if (build.cache_key != 0)
+		glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(id);
+}
+
+// checks the compile and link results, frees the shaders, and saves the program into the program cache
+static void
+_renoir_gl450_program_build_end(IRenoir* self, Renoir_Handle* h)
+{
+	constexpr const char* names[] = {"vertex", "pixel", "geometry"};
+	constexpr size_t error_length = 1024;
+	char error[error_length];
+	GLint size = 0;
+	GLint success = 0;
+
+	auto id = _renoir_gl450_program_id(h);
+	auto& build = _renoir_gl450_program_build_of(h);
+
+	bool compiled = true;
+	for (size_t i = 0; i < _renoir_gl450_program_shaders_count(h); ++i)
+	{
+		if (build.shaders[i] == 0)
+			continue;
+
+		glGetShaderiv(build.shaders[i], GL_COMPILE_STATUS, &success);
+		if (success == GL_FALSE)
+		{
+			::memset(error, 0, sizeof(error));
+			glGetShaderInfoLog(build.shaders[i], error_length, &size, error);
+			if (h->kind == RENOIR_HANDLE_KIND_COMPUTE)
+				mn::panic("compute shader compile error\n{}", error);
+			mn::log_error("{} shader compile error\n{}", names[i], error);
+			compiled = false;
+		}
+	}
+
+	if (compiled)
+	{
+		glGetProgramiv(id, GL_LINK_STATUS, &success);
+		if (success == GL_FALSE)
+		{
+			glGetProgramiv(id, GL_INFO_LOG_LENGTH, &size);
+			size = size > error_length ? error_length : size;
+			glGetProgramInfoLog(id, size, &size, error);
+			if (h->kind == RENOIR_HANDLE_KIND_COMPUTE)
+				mn::panic("compute program linking error\n{}", error);
+			else
+				mn::panic("program linking error\n{}", error);
+		}
+	}
+
+	for (auto& shader: build.shaders)
+	{
+		if (shader == 0)
+			continue;
+		glDetachShader(id, shader);
+		glDeleteShader(shader);
+		shader = 0;
+	}
+
+	if (compiled)
+	{
+		_renoir_gl450_program_cache_save(self, build.cache_key, id);
+		_renoir_gl450_program_cache_stats(self, build.cache_key, false, build.start_time);
+	}
+}
+
+// creates the program from the cache or starts compiling it based on the compile mode
+static void
+_renoir_gl450_program_build(IRenoir* self, Renoir_Handle* h, const Renoir_Shader_Blob* shaders)
+{
+	auto& id = _renoir_gl450_program_id(h);
+	auto& build = _renoir_gl450_program_build_of(h);
+	auto& ready = _renoir_gl450_program_ready_flag(h);
+	auto shaders_count = _renoir_gl450_program_shaders_count(h);
+
+	build.start_time = _renoir_gl450_time_in_nanos();
+	id = glCreateProgram();
+	build.cache_key = _renoir_gl450_program_cache_key(self, shaders, shaders_count);
+	if (_renoir_gl450_program_cache_load(self, build.cache_key, id))
+	{
+		_renoir_gl450_program_cache_stats(self, build.cache_key, true, build.start_time);
+		ready = true;
+		return;
+	}
+
+	switch (self->program_compile)
+	{
+	case RENOIR_GL450_PROGRAM_COMPILE_SYNC:
+		_renoir_gl450_program_build_begin(h, shaders);
+		_renoir_gl450_program_build_end(self, h);
+		ready = true;
+		break;
+	case RENOIR_GL450_PROGRAM_COMPILE_PARALLEL:
+		_renoir_gl450_program_build_begin(h, shaders);
+		mn::buf_push(self->program_builds, h);
+		break;
+	case RENOIR_GL450_PROGRAM_COMPILE_WORKER:
+	{
+		Renoir_GL450_Compile_Job job{};
+		job.handle = h;
+		for (size_t i = 0; i < shaders_count; ++i)
+		{
+			if (shaders[i].bytes == nullptr)
+				continue;
+			job.shaders[i].bytes = (char*)mn::alloc(shaders[i].size, alignof(char)).ptr;
+			job.shaders[i].size = shaders[i].size;
+			::memcpy((char*)job.shaders[i].bytes, shaders[i].bytes, shaders[i].size);
+		}
+
+		// the program is created on this context so flush it before the compile thread uses it
+		glFlush();
+		mn::mutex_lock(self->compile_mtx);
+		mn::buf_push(self->compile_jobs, job);
+		mn::cond_var_notify_all(self->compile_cv);
+		mn::mutex_unlock(self->compile_mtx);
+		break;
+	}
+	default:
+		mn_unreachable();
+		break;
+	}
+}
+
+// returns whether the program is ready, in parallel mode it checks whether the driver is done without waiting
+static bool
+_renoir_gl450_program_poll(IRenoir* self, Renoir_Handle* h)
+{
+	auto& ready = _renoir_gl450_program_ready_flag(h);
+	if (ready)
+		return true;
+
+	if (self->program_compile != RENOIR_GL450_PROGRAM_COMPILE_PARALLEL)
+		return false;
+
+	GLint done = GL_FALSE;
+	glGetProgramiv(_renoir_gl450_program_id(h), GL_COMPLETION_STATUS_ARB, &done);
+	if (done == GL_FALSE)
+		return false;
+
+	_renoir_gl450_program_build_end(self, h);
+	for (size_t i = 0; i < self->program_builds.count; ++i)
+	{
+		if (self->program_builds[i] == h)
+		{
+			mn::buf_remove(self->program_builds, i);
+			break;
+		}
+	}
+	ready = true;
+	return true;
+}
+
+static void
+_renoir_gl450_job_free(Renoir_GL450_Compile_Job& job)
 {
-	auto command = (Renoir_Command*)mn::pool_get(self->command_pool);
-	memset(command, 0, sizeof(*command));
-	command->kind = kind;
-	return command;
+	for (const auto& shader: job.shaders)
+		if (shader.bytes != nullptr)
+			mn::free(mn::Block{(void*)shader.bytes, shader.size});
 }
 
-template<typename T>
+// stops the build of a program which is about to be deleted
 static void
-_renoir_gl450_command_free(T* self, Renoir_Command* command)
+_renoir_gl450_program_build_cancel(IRenoir* self, Renoir_Handle* h)
 {
-	switch(command->kind)
-	{
-	case RENOIR_COMMAND_KIND_BUFFER_NEW:
-	{
-		if(command->buffer_new.owns_data)
-			mn::free(mn::Block{(void*)command->buffer_new.desc.data, command->buffer_new.desc.data_size});
-		break;
-	}
-	case RENOIR_COMMAND_KIND_TEXTURE_NEW:
+	if (_renoir_gl450_program_ready_flag(h))
+		return;
+
+	if (self->program_compile == RENOIR_GL450_PROGRAM_COMPILE_PARALLEL)
 	{
-		if(command->texture_new.owns_data)
+		for (size_t i = 0; i < self->program_builds.count; ++i)
 		{
-			for (int i = 0; i < 6; ++i)
+			if (self->program_builds[i] == h)
 			{
-				if (command->texture_new.desc.data[i] == nullptr)
-					continue;
-
-				mn::free(mn::Block{(void*)command->texture_new.desc.data[i], command->texture_new.desc.data_size});
+				mn::buf_remove(self->program_builds, i);
+				break;
 			}
 		}
-		break;
-	}
-	case RENOIR_COMMAND_KIND_PROGRAM_NEW:
-	{
-		if(command->program_new.owns_data)
+
+		// deleting the program detaches the shaders
+		for (auto& shader: _renoir_gl450_program_build_of(h).shaders)
 		{
-			mn::free(mn::Block{(void*)command->program_new.desc.vertex.bytes, command->program_new.desc.vertex.size});
-			mn::free(mn::Block{(void*)command->program_new.desc.pixel.bytes, command->program_new.desc.pixel.size});
-			if (command->program_new.desc.geometry.bytes != nullptr)
-				mn::free(mn::Block{(void*)command->program_new.desc.geometry.bytes, command->program_new.desc.geometry.size});
+			if (shader != 0)
+				glDeleteShader(shader);
+			shader = 0;
 		}
-		break;
 	}
-	case RENOIR_COMMAND_KIND_COMPUTE_NEW:
+	else if (self->program_compile == RENOIR_GL450_PROGRAM_COMPILE_WORKER)
 	{
-		if(command->compute_new.owns_data)
+		mn::mutex_lock(self->compile_mtx);
+		bool queued = false;
+		for (size_t i = 0; i < self->compile_jobs.count; ++i)
 		{
-			mn::free(mn::Block{(void*)command->compute_new.desc.compute.bytes, command->compute_new.desc.compute.size});
+			if (self->compile_jobs[i].handle == h)
+			{
+				_renoir_gl450_job_free(self->compile_jobs[i]);
+				mn::buf_remove_ordered(self->compile_jobs, i);
+				queued = true;
+				break;
+			}
 		}
-		break;
-	}
-	case RENOIR_COMMAND_KIND_BUFFER_WRITE:
-	{
-		mn::free(mn::Block{(void*)command->buffer_write.bytes, command->buffer_write.bytes_size});
-		break;
-	}
-	case RENOIR_COMMAND_KIND_TEXTURE_WRITE:
-	{
-		mn::free(mn::Block{(void*)command->texture_write.desc.bytes, command->texture_write.desc.bytes_size});
-		break;
-	}
-	case RENOIR_COMMAND_KIND_NONE:
-	case RENOIR_COMMAND_KIND_INIT:
-	case RENOIR_COMMAND_KIND_SWAPCHAIN_NEW:
-	case RENOIR_COMMAND_KIND_SWAPCHAIN_FREE:
-	case RENOIR_COMMAND_KIND_PASS_SWAPCHAIN_NEW:
-	case RENOIR_COMMAND_KIND_PASS_OFFSCREEN_NEW:
-	case RENOIR_COMMAND_KIND_PASS_FREE:
-	case RENOIR_COMMAND_KIND_BUFFER_FREE:
-	case RENOIR_COMMAND_KIND_TEXTURE_FREE:
-	case RENOIR_COMMAND_KIND_SAMPLER_NEW:
-	case RENOIR_COMMAND_KIND_SAMPLER_FREE:
-	case RENOIR_COMMAND_KIND_PROGRAM_FREE:
-	case RENOIR_COMMAND_KIND_COMPUTE_FREE:
-	case RENOIR_COMMAND_KIND_TIMER_NEW:
-	case RENOIR_COMMAND_KIND_TIMER_FREE:
-	case RENOIR_COMMAND_KIND_TIMER_ELAPSED:
-	case RENOIR_COMMAND_KIND_PASS_BEGIN:
-	case RENOIR_COMMAND_KIND_PASS_END:
-	case RENOIR_COMMAND_KIND_PASS_CLEAR:
-	case RENOIR_COMMAND_KIND_USE_PIPELINE:
-	case RENOIR_COMMAND_KIND_USE_COMPUTE:
-	case RENOIR_COMMAND_KIND_SCISSOR:
-	case RENOIR_COMMAND_KIND_BUFFER_READ:
-	case RENOIR_COMMAND_KIND_TEXTURE_READ:
-	case RENOIR_COMMAND_KIND_BUFFER_CLEAR:
-	case RENOIR_COMMAND_KIND_BUFFER_BIND:
-	case RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND:
-	case RENOIR_COMMAND_KIND_TEXTURE_BIND:
-	case RENOIR_COMMAND_KIND_DRAW:
-	case RENOIR_COMMAND_KIND_DISPATCH:
-	case RENOIR_COMMAND_KIND_TIMER_BEGIN:
-	case RENOIR_COMMAND_KIND_TIMER_END:
-	default:
-		// do nothing
-		break;
+
+		// the compile thread is using the program, so wait for it
+		while (queued == false && self->compile_current == h)
+			mn::cond_var_wait(self->compile_cv, self->compile_mtx);
+		mn::mutex_unlock(self->compile_mtx);
 	}
-	mn::pool_put(self->command_pool, command);
 }
 
-template<typename T>
 static void
-_renoir_gl450_command_push_back(T* self, Renoir_Command* command)
+_renoir_gl450_compile_thread_main(void* data)
 {
-	if(self->command_list_tail == nullptr)
+	auto self = (IRenoir*)data;
+	renoir_gl450_context_bind(self->compile_ctx);
+
+	mn::mutex_lock(self->compile_mtx);
+	while (true)
 	{
-		self->command_list_tail = command;
-		self->command_list_head = command;
-		return;
-	}
+		while (self->compile_jobs.count == 0 && self->compile_quit == false)
+			mn::cond_var_wait(self->compile_cv, self->compile_mtx);
 
-	self->command_list_tail->next = command;
-	command->prev = self->command_list_tail;
-	self->command_list_tail = command;
-}
+		if (self->compile_quit)
+			break;
 
-template<typename T>
-static void
-_renoir_gl450_command_push_front(T* self, Renoir_Command* command)
-{
-	if(self->command_list_head == nullptr)
-	{
-		self->command_list_head = command;
-		self->command_list_tail = command;
-		return;
+		auto job = self->compile_jobs[0];
+		mn::buf_remove_ordered(self->compile_jobs, 0);
+		self->compile_current = job.handle;
+		mn::mutex_unlock(self->compile_mtx);
+
+		_renoir_gl450_program_build_begin(job.handle, job.shaders);
+		_renoir_gl450_program_build_end(self, job.handle);
+		// the program should be complete before the main context uses it
+		glFinish();
+		_renoir_gl450_job_free(job);
+		_renoir_gl450_program_ready_flag(job.handle) = true;
+
+		mn::mutex_lock(self->compile_mtx);
+		self->compile_current = nullptr;
+		mn::cond_var_notify_all(self->compile_cv);
 	}
+	mn::mutex_unlock(self->compile_mtx);
 
-	self->command_list_head->prev = command;
-	command->next = self->command_list_head;
-	self->command_list_head = command;
+	renoir_gl450_context_unbind(self->compile_ctx);
 }
 
+// frees the recorded but not submitted commands and orphans the pass command allocator
 static void
-_renoir_gl450_command_process(IRenoir* self, Renoir_Command* command)
+_renoir_gl450_pass_recorder_free(IRenoir* self, Renoir_Handle* h)
 {
-	if (self->settings.defer_api_calls)
-	{
-		_renoir_gl450_command_push_back(self, command);
-	}
-	else
-	{
-		_renoir_gl450_command_execute(self, command);
-		_renoir_gl450_command_free(self, command);
-	}
+	auto& recorder = _renoir_gl450_pass_recorder(h);
+	_renoir_gl450_command_stream_free(self, recorder.commands);
+	_renoir_gl450_command_allocator_orphan(recorder.allocator);
+	recorder.allocator = nullptr;
 }
 
 static void
 _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 {
+	// any other command could change the state the merged draws depend on
+	if (self->draw_batch_first != nullptr && command->kind != RENOIR_COMMAND_KIND_DRAW)
+		_renoir_gl450_draw_batch_flush(self);
+
+#if RENOIR_STATS
+	++self->frame_stats.commands_count;
+	++self->frame_stats.commands[command->kind];
+#endif
+
 	switch(command->kind)
 	{
 	case RENOIR_COMMAND_KIND_INIT:
@@ -1498,7 +4376,6 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		glDebugMessageCallback(_renoir_gl450_error_log, nullptr);
 		#endif
 
-		glCreateVertexArrays(1, &self->vao);
 		glCreateFramebuffers(1, &self->msaa_resolve_fb);
 		GLint max_samplers = 0;
 		glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_samplers);
@@ -1506,6 +4383,46 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		mn_assert(_renoir_gl450_check());
 
 		self->info_description = mn::strf("Renderer: {}, Version: {}, GLSL Version: {}", renderer, version, shader);
+
+		if (self->settings.program_cache_path != nullptr)
+		{
+			GLint binary_formats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_formats);
+			if (binary_formats > 0)
+				self->program_cache_driver = mn::strf("{}, Vendor: {}", self->info_description, glGetString(GL_VENDOR));
+			else
+				mn::log_warning("gl450: driver has no program binary formats, program cache is disabled");
+		}
+
+		GLint uniform_alignment = 0, storage_alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+		self->uniform_buffer_offset_alignment.store(uniform_alignment);
+		self->storage_buffer_offset_alignment.store(storage_alignment);
+		self->draw_indirect_count_supported.store(GLEW_ARB_indirect_parameters != false);
+		self->draw_indirect_count_queried.store(true);
+
+		if (self->settings.async_programs)
+		{
+			if (GLEW_ARB_parallel_shader_compile || glewIsSupported("GL_KHR_parallel_shader_compile"))
+			{
+				// let the driver pick the number of compiler threads
+				if (glMaxShaderCompilerThreadsARB != nullptr)
+					glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+				self->program_compile = RENOIR_GL450_PROGRAM_COMPILE_PARALLEL;
+			}
+			else if (self->ctx != nullptr && (self->compile_ctx = renoir_gl450_context_worker_new(self->ctx)) != nullptr)
+			{
+				self->compile_mtx = mn_mutex_new_with_srcloc("renoir gl450 compile");
+				self->compile_cv = mn::cond_var_new();
+				self->compile_thread = mn::thread_new(_renoir_gl450_compile_thread_main, self, "renoir gl450 compile thread");
+				self->program_compile = RENOIR_GL450_PROGRAM_COMPILE_WORKER;
+			}
+			else
+			{
+				mn::log_warning("gl450: driver has no parallel shader compile and can't create a worker context, programs are compiled synchronously");
+			}
+		}
 		break;
 	}
 	case RENOIR_COMMAND_KIND_SWAPCHAIN_NEW:
@@ -1535,123 +4452,24 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		auto h = command->pass_offscreen_new.handle;
 		auto& desc = command->pass_offscreen_new.desc;
 
-		int msaa = -1;
-
-		glCreateFramebuffers(1, &h->raster_pass.fb);
-		// we want to initialize this to GL_NONE which is 0 so this initialization is safe
-		GLenum attachments[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE] = {};
+		// the pass holds a reference to its textures so the cached framebuffer outlives it
 		for (size_t i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
 		{
 			auto color = (Renoir_Handle*)desc.color[i].texture.handle;
 			if (color == nullptr)
 				continue;
 			mn_assert(color->texture.desc.render_target);
-			attachments[i] = GL_COLOR_ATTACHMENT0 + i;
-
 			_renoir_gl450_handle_ref(color);
-			if (color->texture.desc.cube_map == false)
-			{
-				if (color->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
-				{
-					mn_assert_msg(desc.color[i].level == 0, "multisampled textures does not support mipmaps");
-					glNamedFramebufferRenderbuffer(h->raster_pass.fb, GL_COLOR_ATTACHMENT0+i,  GL_RENDERBUFFER, color->texture.render_buffer[0]);
-				}
-				else
-				{
-					mn_assert_msg(desc.color[i].level < color->texture.desc.mipmaps, "out of range mip level");
-					glNamedFramebufferTexture(h->raster_pass.fb, GL_COLOR_ATTACHMENT0+i, color->texture.id, desc.color[i].level);
-				}
-			}
-			else
-			{
-				if (color->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
-				{
-					mn_assert_msg(desc.color[i].level == 0, "multisampled textures does not support mipmaps");
-					glNamedFramebufferRenderbuffer(h->raster_pass.fb, GL_COLOR_ATTACHMENT0+i,  GL_RENDERBUFFER, color->texture.render_buffer[desc.color[i].subresource]);
-				}
-				else
-				{
-					mn_assert_msg(desc.color[i].level < color->texture.desc.mipmaps, "out of range mip level");
-					mn_assert(_renoir_gl450_check());
-					glBindFramebuffer(GL_FRAMEBUFFER, h->raster_pass.fb);
-					glFramebufferTexture2D(
-						GL_FRAMEBUFFER,
-						GL_COLOR_ATTACHMENT0 + i,
-						GL_TEXTURE_CUBE_MAP_POSITIVE_X + desc.color[i].subresource,
-						color->texture.id,
-						desc.color[i].level
-					);
-					mn_assert(_renoir_gl450_check());
-				}
-			}
-
-			// check that all of them has the same msaa
-			if (msaa == -1)
-			{
-				msaa = color->texture.desc.msaa;
-			}
-			else
-			{
-				mn_assert(msaa == color->texture.desc.msaa);
-			}
 		}
-		glNamedFramebufferDrawBuffers(h->raster_pass.fb, RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE, attachments);
-		mn_assert(_renoir_gl450_check());
 
 		auto depth = (Renoir_Handle*)desc.depth_stencil.texture.handle;
 		if (depth)
 		{
 			mn_assert(depth->texture.desc.render_target);
 			_renoir_gl450_handle_ref(depth);
-
-			auto attachment = _renoir_pixelformat_to_depth_attachment(depth->texture.desc.pixel_format);
-
-			if (depth->texture.desc.cube_map == false)
-			{
-				if (depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
-				{
-					mn_assert_msg(desc.depth_stencil.level == 0, "multisampled textures does not support mipmaps");
-					glNamedFramebufferRenderbuffer(h->raster_pass.fb, attachment,  GL_RENDERBUFFER, depth->texture.render_buffer[0]);
-				}
-				else
-				{
-					mn_assert_msg(desc.depth_stencil.level < depth->texture.desc.mipmaps, "out of range mip level");
-					glNamedFramebufferTexture(h->raster_pass.fb, attachment, depth->texture.id, desc.depth_stencil.level);
-				}
-			}
-			else
-			{
-				if (depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
-				{
-					mn_assert_msg(desc.depth_stencil.level == 0, "multisampled textures does not support mipmaps");
-					glNamedFramebufferRenderbuffer(h->raster_pass.fb, attachment,  GL_RENDERBUFFER, depth->texture.render_buffer[desc.depth_stencil.subresource]);
-				}
-				else
-				{
-					mn_assert_msg(desc.depth_stencil.level < depth->texture.desc.mipmaps, "out of range mip level");
-					glBindFramebuffer(GL_FRAMEBUFFER, h->raster_pass.fb);
-					glFramebufferTexture2D(
-						GL_FRAMEBUFFER,
-						attachment,
-						GL_TEXTURE_CUBE_MAP_POSITIVE_X + desc.depth_stencil.subresource,
-						depth->texture.id,
-						desc.depth_stencil.level
-					);
-				}
-			}
-
-			// check that all of them has the same msaa
-			if (msaa == -1)
-			{
-				msaa = depth->texture.desc.msaa;
-			}
-			else
-			{
-				mn_assert(msaa == depth->texture.desc.msaa);
-			}
 		}
-		mn_assert(_renoir_gl450_check());
-		mn_assert(glCheckNamedFramebufferStatus(h->raster_pass.fb, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+		h->raster_pass.fb = _renoir_gl450_framebuffer_get(self, desc);
 		break;
 	}
 	case RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW:
@@ -1665,11 +4483,20 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
 
-		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		// free the recorded but not submitted commands
+		_renoir_gl450_pass_recorder_free(self, h);
+
+		// secondary passes hold a reference to their parent
+		if (auto parent = _renoir_gl450_pass_recorder(h).parent)
 		{
-			for(auto it = h->raster_pass.command_list_head; it != NULL; it = it->next)
-				_renoir_gl450_command_free(self, command);
+			Renoir_Command command{};
+			command.kind = RENOIR_COMMAND_KIND_PASS_FREE;
+			command.pass_free.handle = parent;
+			_renoir_gl450_command_execute(self, &command);
+		}
 
+		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		{
 			// free all the bound textures if it's a framebuffer pass
 			if (h->raster_pass.fb != 0)
 			{
@@ -1679,30 +4506,25 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 					if (color == nullptr)
 						continue;
 
-					// issue command to free the color texture
-					auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
-					command->texture_free.handle = color;
-					_renoir_gl450_command_process(self, command);
+					// execute command to free the color texture
+					Renoir_Command command{};
+					command.kind = RENOIR_COMMAND_KIND_TEXTURE_FREE;
+					command.texture_free.handle = color;
+					_renoir_gl450_command_execute(self, &command);
 				}
 
 				auto depth = (Renoir_Handle*)h->raster_pass.offscreen.depth_stencil.texture.handle;
 				if (depth)
 				{
-					// issue command to free the depth texture
-					auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
-					command->texture_free.handle = depth;
-					_renoir_gl450_command_process(self, command);
+					// execute command to free the depth texture
+					Renoir_Command command{};
+					command.kind = RENOIR_COMMAND_KIND_TEXTURE_FREE;
+					command.texture_free.handle = depth;
+					_renoir_gl450_command_execute(self, &command);
 				}
-
-				glDeleteFramebuffers(1, &h->raster_pass.fb);
 			}
 		}
-		else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
-		{
-			for(auto it = h->compute_pass.command_list_head; it != NULL; it = it->next)
-				_renoir_gl450_command_free(self, command);
-		}
-		else
+		else if (h->kind != RENOIR_HANDLE_KIND_COMPUTE_PASS)
 		{
 			mn_unreachable_msg("invalid pass");
 		}
@@ -1724,6 +4546,21 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 			);
 		}
 
+		if (desc.usage == RENOIR_USAGE_STREAM)
+		{
+			GLbitfield gl_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+			renoir_gl450_context_bind(self->ctx);
+			glCreateBuffers(1, &h->buffer.id);
+			glNamedBufferStorage(h->buffer.id, desc.data_size, desc.data, gl_flags);
+			h->buffer.stream_ptr = (uint8_t*)glMapNamedBufferRange(h->buffer.id, 0, desc.data_size, gl_flags);
+			mn::mutex_lock(self->stream_mtx);
+			mn::buf_push(self->stream_buffers, h);
+			mn::mutex_unlock(self->stream_mtx);
+			mn_assert(_renoir_gl450_check());
+			break;
+		}
+
 		auto gl_usage = _renoir_usage_to_gl(desc.usage);
 
 		renoir_gl450_context_bind(self->ctx);
@@ -1737,6 +4574,48 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		auto h = command->buffer_free.handle;
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
+
+		// the buffer name can be reused by a new buffer, so forget it in the cached vertex arrays
+		for (auto& [layout, vertex_array]: self->vertex_arrays)
+		{
+			for (auto& buffer: vertex_array.buffers)
+				if (buffer == h->buffer.id)
+					buffer = 0;
+			if (vertex_array.index_buffer == h->buffer.id)
+				vertex_array.index_buffer = 0;
+		}
+
+		if (h->buffer.usage == RENOIR_USAGE_STREAM)
+		{
+			// deleting the buffer is deferred by the driver until the gpu is done with it, so no need to wait
+			mn::mutex_lock(self->stream_mtx);
+			for (size_t i = 0; i < self->stream_regions.count;)
+			{
+				if (self->stream_regions[i].buffer == h)
+				{
+					glDeleteSync(self->stream_regions[i].fence);
+					mn::buf_remove_ordered(self->stream_regions, i);
+				}
+				else
+				{
+					++i;
+				}
+			}
+
+			for (size_t i = 0; i < self->stream_buffers.count; ++i)
+			{
+				if (self->stream_buffers[i] == h)
+				{
+					mn::buf_remove(self->stream_buffers, i);
+					break;
+				}
+			}
+			mn::mutex_unlock(self->stream_mtx);
+
+			glUnmapNamedBuffer(h->buffer.id);
+		}
+
+		_renoir_gl450_barrier_forget(self, h);
 		glDeleteBuffers(1, &h->buffer.id);
 		_renoir_gl450_handle_free(self, h);
 		mn_assert(_renoir_gl450_check());
@@ -1893,6 +4772,9 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		auto h = command->texture_free.handle;
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
+		if (h->texture.desc.render_target)
+			_renoir_gl450_framebuffer_evict(self, h);
+		_renoir_gl450_barrier_forget(self, h);
 		glDeleteTextures(1, &h->texture.id);
 		for (int i = 0; i < 6; ++i)
 		{
@@ -1939,90 +4821,18 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	{
 		auto h = command->sampler_free.handle;
 		if (_renoir_gl450_handle_unref(h) == false)
-			break;
-		glDeleteSamplers(1, &h->sampler.id);
-		_renoir_gl450_handle_free(self, h);
-		mn_assert(_renoir_gl450_check());
-		break;
-	}
-	case RENOIR_COMMAND_KIND_PROGRAM_NEW:
-	{
-		auto& desc = command->program_new.desc;
-		auto h = command->program_new.handle;
-		constexpr size_t error_length = 1024;
-		char error[error_length];
-		GLint size = 0;
-		GLint success = 0;
-
-		auto vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-		size = desc.vertex.size;
-		glShaderSource(vertex_shader, 1, &desc.vertex.bytes, &size);
-		glCompileShader(vertex_shader);
-		glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
-		if (success == GL_FALSE)
-		{
-			::memset(error, 0, sizeof(error));
-			glGetShaderInfoLog(vertex_shader, error_length, &size, error);
-			mn::log_error("vertex shader compile error\n{}", error);
-			break;
-		}
-
-		auto pixel_shader = glCreateShader(GL_FRAGMENT_SHADER);
-		size = desc.pixel.size;
-		glShaderSource(pixel_shader, 1, &desc.pixel.bytes, &size);
-		glCompileShader(pixel_shader);
-		glGetShaderiv(pixel_shader, GL_COMPILE_STATUS, &success);
-		if (success == GL_FALSE)
-		{
-			::memset(error, 0, sizeof(error));
-			glGetShaderInfoLog(pixel_shader, error_length, &size, error);
-			mn::log_error("pixel shader compile error\n{}", error);
-			break;
-		}
-
-		GLuint geometry_shader = 0;
-		if (desc.geometry.bytes != nullptr)
-		{
-			geometry_shader = glCreateShader(GL_GEOMETRY_SHADER);
-			size = desc.geometry.size;
-			glShaderSource(geometry_shader, 1, &desc.geometry.bytes, &size);
-			glCompileShader(geometry_shader);
-			glGetShaderiv(geometry_shader, GL_COMPILE_STATUS, &success);
-			if (success == GL_FALSE)
-			{
-				::memset(error, 0, sizeof(error));
-				glGetShaderInfoLog(geometry_shader, error_length, &size, error);
-				mn::log_error("pixel shader compile error\n{}", error);
-				break;
-			}
-		}
-
-		h->program.id = glCreateProgram();
-		glAttachShader(h->program.id, vertex_shader);
-		glAttachShader(h->program.id, pixel_shader);
-		if(desc.geometry.bytes != nullptr)
-			glAttachShader(h->program.id, geometry_shader);
-
-		glLinkProgram(h->program.id);
-		glGetProgramiv(h->program.id, GL_LINK_STATUS, &success);
-		if (success == GL_FALSE)
-		{
-			glGetProgramiv(h->program.id, GL_INFO_LOG_LENGTH, &size);
-			size = size > error_length ? error_length : size;
-			glGetProgramInfoLog(h->program.id, size, &size, error);
-			mn::panic("program linking error\n{}", error);
-		}
-
-		glDetachShader(h->program.id, vertex_shader);
-		glDeleteShader(vertex_shader);
-		glDetachShader(h->program.id, pixel_shader);
-		glDeleteShader(pixel_shader);
-		if (desc.geometry.bytes != nullptr)
-		{
-			glDetachShader(h->program.id, geometry_shader);
-			glDeleteShader(geometry_shader);
-		}
-
+			break;
+		glDeleteSamplers(1, &h->sampler.id);
+		_renoir_gl450_handle_free(self, h);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_PROGRAM_NEW:
+	{
+		auto& desc = command->program_new.desc;
+		auto h = command->program_new.handle;
+		Renoir_Shader_Blob shaders[] = {desc.vertex, desc.pixel, desc.geometry};
+		_renoir_gl450_program_build(self, h, shaders);
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2031,6 +4841,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		auto h = command->program_free.handle;
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
+		_renoir_gl450_program_build_cancel(self, h);
 		glDeleteProgram(h->program.id);
 		_renoir_gl450_handle_free(self, h);
 		mn_assert(_renoir_gl450_check());
@@ -2040,39 +4851,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	{
 		auto& desc = command->compute_new.desc;
 		auto h = command->compute_new.handle;
-		constexpr size_t error_length = 1024;
-		char error[error_length];
-		GLint size = 0;
-		GLint success = 0;
-
-		auto compute_shader = glCreateShader(GL_COMPUTE_SHADER);
-		size = desc.compute.size;
-		glShaderSource(compute_shader, 1, &desc.compute.bytes, &size);
-		glCompileShader(compute_shader);
-		glGetShaderiv(compute_shader, GL_COMPILE_STATUS, &success);
-		if (success == GL_FALSE)
-		{
-			glGetShaderiv(compute_shader, GL_INFO_LOG_LENGTH, &size);
-			size = size > error_length ? error_length : size;
-			glGetShaderInfoLog(compute_shader, size, &size, error);
-			mn::panic("compute shader compile error\n{}", error);
-		}
-
-		h->compute.id = glCreateProgram();
-		glAttachShader(h->compute.id, compute_shader);
-
-		glLinkProgram(h->compute.id);
-		glGetProgramiv(h->compute.id, GL_LINK_STATUS, &success);
-		if (success == GL_FALSE)
-		{
-			glGetProgramiv(h->compute.id, GL_INFO_LOG_LENGTH, &size);
-			size = size > error_length ? error_length : size;
-			glGetProgramInfoLog(h->compute.id, size, &size, error);
-			mn::panic("compute program linking error\n{}", error);
-		}
-
-		glDetachShader(h->compute.id, compute_shader);
-		glDeleteShader(compute_shader);
+		_renoir_gl450_program_build(self, h, &desc.compute);
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2081,6 +4860,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		auto h = command->compute_free.handle;
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
+		_renoir_gl450_program_build_cancel(self, h);
 		glDeleteProgram(h->compute.id);
 		_renoir_gl450_handle_free(self, h);
 		mn_assert(_renoir_gl450_check());
@@ -2090,6 +4870,8 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	{
 		auto h = command->pipeline_new.handle;
 		_renoir_gl450_handle_ref(h->pipeline.program);
+		if (h->pipeline.fallback)
+			_renoir_gl450_handle_ref(h->pipeline.fallback);
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2099,10 +4881,18 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
 
-		// issue command to free the program
-		auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_FREE);
-		command->program_free.handle = h->pipeline.program;
-		_renoir_gl450_command_process(self, command);
+		// execute command to free the program
+		Renoir_Command command{};
+		command.kind = RENOIR_COMMAND_KIND_PROGRAM_FREE;
+		command.program_free.handle = h->pipeline.program;
+		_renoir_gl450_command_execute(self, &command);
+
+		if (h->pipeline.fallback)
+		{
+			command.kind = RENOIR_COMMAND_KIND_PIPELINE_FREE;
+			command.pipeline_free.handle = h->pipeline.fallback;
+			_renoir_gl450_command_execute(self, &command);
+		}
 
 		_renoir_gl450_handle_free(self, h);
 		mn_assert(_renoir_gl450_check());
@@ -2146,9 +4936,72 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
+	case RENOIR_COMMAND_KIND_READBACK_BUFFER:
+	{
+		auto h = command->readback_buffer.handle;
+		auto hbuffer = command->readback_buffer.buffer;
+
+		renoir_gl450_context_bind(self->ctx);
+		_renoir_gl450_barrier_use(self, hbuffer, GL_BUFFER_UPDATE_BARRIER_BIT);
+		glCreateBuffers(1, &h->readback.staging);
+		glNamedBufferStorage(h->readback.staging, h->readback.size, nullptr, GL_CLIENT_STORAGE_BIT);
+		glCopyNamedBufferSubData(hbuffer->buffer.id, h->readback.staging, command->readback_buffer.offset, 0, h->readback.size);
+		h->readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		h->readback.data = mn::alloc(h->readback.size, alignof(char)).ptr;
+		mn::buf_push(self->pending_readbacks, h);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_READBACK_TEXTURE:
+	{
+		auto h = command->readback_texture.handle;
+
+		renoir_gl450_context_bind(self->ctx);
+		glCreateBuffers(1, &h->readback.staging);
+		glNamedBufferStorage(h->readback.staging, h->readback.size, nullptr, GL_CLIENT_STORAGE_BIT);
+
+		// with a pixel pack buffer bound the texture read writes into it, and bytes is treated as an offset
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, h->readback.staging);
+		Renoir_Command read{};
+		read.kind = RENOIR_COMMAND_KIND_TEXTURE_READ;
+		read.texture_read.handle = command->readback_texture.texture;
+		read.texture_read.desc = command->readback_texture.desc;
+		read.texture_read.desc.bytes = nullptr;
+		_renoir_gl450_command_execute(self, &read);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		h->readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		h->readback.data = mn::alloc(h->readback.size, alignof(char)).ptr;
+		mn::buf_push(self->pending_readbacks, h);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_READBACK_FREE:
+	{
+		auto h = command->readback_free.handle;
+		if (_renoir_gl450_handle_unref(h) == false)
+			break;
+		for (size_t i = 0; i < self->pending_readbacks.count; ++i)
+		{
+			if (self->pending_readbacks[i] == h)
+			{
+				mn::buf_remove(self->pending_readbacks, i);
+				break;
+			}
+		}
+		if (h->readback.fence)
+			glDeleteSync(h->readback.fence);
+		glDeleteBuffers(1, &h->readback.staging);
+		if (h->readback.data)
+			mn::free(mn::Block{h->readback.data, h->readback.size});
+		_renoir_gl450_handle_free(self, h);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
 	case RENOIR_COMMAND_KIND_PASS_BEGIN:
 	{
 		auto h = command->pass_begin.handle;
+		mn::buf_clear(self->bindings);
 		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
 		{
 			// if this is an on screen/window
@@ -2158,15 +5011,74 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 				glBindFramebuffer(GL_FRAMEBUFFER, NULL);
 				glViewport(0, 0, swapchain->swapchain.width, swapchain->swapchain.height);
 				glDisable(GL_SCISSOR_TEST);
+				self->gl_state.scissor = GL_FALSE;
 				self->current_pass = h;
 			}
 			// this is an offscreen
 			else if (h->raster_pass.fb != 0)
 			{
+				// attachments written by dispatches should be visible to the framebuffer
+				for (const auto& attachment: h->raster_pass.offscreen.color)
+					_renoir_gl450_barrier_use(self, (Renoir_Handle*)attachment.texture.handle, GL_FRAMEBUFFER_BARRIER_BIT);
+				_renoir_gl450_barrier_use(self, (Renoir_Handle*)h->raster_pass.offscreen.depth_stencil.texture.handle, GL_FRAMEBUFFER_BARRIER_BIT);
+
 				glBindFramebuffer(GL_FRAMEBUFFER, h->raster_pass.fb);
 				glViewport(0, 0, h->raster_pass.width, h->raster_pass.height);
 				glDisable(GL_SCISSOR_TEST);
+				self->gl_state.scissor = GL_FALSE;
 				self->current_pass = h;
+
+				// apply the load actions, attachments which don't care about their contents are invalidated
+				auto& offscreen = h->raster_pass.offscreen;
+				GLenum invalidate[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE + 1];
+				GLsizei invalidate_count = 0;
+				for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+				{
+					auto& attachment = offscreen.color[i];
+					if (attachment.texture.handle == nullptr)
+						continue;
+
+					if (attachment.load == RENOIR_LOAD_ACTION_CLEAR)
+					{
+						// clears are affected by the color mask, the shadow state is updated so the next pipeline
+						// re-applies its own mask
+						glColorMaski(i, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+						for (auto& mask: self->gl_state.blend[i].color_mask)
+							mask = GL_TRUE;
+						glClearNamedFramebufferfv(h->raster_pass.fb, GL_COLOR, i, &attachment.clear_color.r);
+					}
+					else if (attachment.load == RENOIR_LOAD_ACTION_DONT_CARE)
+						invalidate[invalidate_count++] = GL_COLOR_ATTACHMENT0 + i;
+				}
+
+				if (auto depth = (Renoir_Handle*)offscreen.depth_stencil.texture.handle)
+				{
+					auto& attachment = offscreen.depth_stencil;
+					auto gl_attachment = _renoir_pixelformat_to_depth_attachment(depth->texture.desc.pixel_format);
+					if (attachment.load == RENOIR_LOAD_ACTION_CLEAR)
+					{
+						// clears are affected by the depth mask
+						glDepthMask(GL_TRUE);
+						self->gl_state.depth_write_mask = GL_TRUE;
+						if (gl_attachment == GL_DEPTH_STENCIL_ATTACHMENT)
+						{
+							// and the stencil part by the stencil write mask
+							glStencilMask(~0u);
+							glClearNamedFramebufferfi(h->raster_pass.fb, GL_DEPTH_STENCIL, 0, attachment.clear_depth, attachment.clear_stencil);
+						}
+						else
+						{
+							glClearNamedFramebufferfv(h->raster_pass.fb, GL_DEPTH, 0, &attachment.clear_depth);
+						}
+					}
+					else if (attachment.load == RENOIR_LOAD_ACTION_DONT_CARE)
+					{
+						invalidate[invalidate_count++] = gl_attachment;
+					}
+				}
+
+				if (invalidate_count > 0)
+					glInvalidateNamedFramebufferData(h->raster_pass.fb, invalidate_count, invalidate);
 			}
 			else
 			{
@@ -2188,6 +5100,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_PASS_END:
 	{
 		auto h = command->pass_end.handle;
+		mn::buf_clear(self->bindings);
 
 		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
 		{
@@ -2203,8 +5116,9 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 				if (color == nullptr)
 					continue;
 
-				// only resolve msaa textures
-				if (color->texture.desc.msaa == RENOIR_MSAA_MODE_NONE)
+				// only resolve msaa textures which requested it
+				if (color->texture.desc.msaa == RENOIR_MSAA_MODE_NONE ||
+					h->raster_pass.offscreen.color[i].store != RENOIR_STORE_ACTION_RESOLVE)
 					continue;
 
 				if (color->texture.desc.cube_map == false)
@@ -2241,7 +5155,8 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 
 			// resolve depth textures as well
 			auto depth = (Renoir_Handle*)h->raster_pass.offscreen.depth_stencil.texture.handle;
-			if (depth && depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE)
+			if (depth && depth->texture.desc.msaa != RENOIR_MSAA_MODE_NONE &&
+				h->raster_pass.offscreen.depth_stencil.store == RENOIR_STORE_ACTION_RESOLVE)
 			{
 				auto attachment = _renoir_pixelformat_to_depth_attachment(depth->texture.desc.pixel_format);
 
@@ -2272,6 +5187,24 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 				glNamedFramebufferTexture(self->msaa_resolve_fb, attachment, 0, 0);
 			}
 
+			// discarded attachments are invalidated so the driver can skip writing them back
+			if (h->raster_pass.fb != 0)
+			{
+				GLenum invalidate[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE + 1];
+				GLsizei invalidate_count = 0;
+				for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+				{
+					auto& attachment = h->raster_pass.offscreen.color[i];
+					if (attachment.texture.handle && attachment.store == RENOIR_STORE_ACTION_DISCARD)
+						invalidate[invalidate_count++] = GL_COLOR_ATTACHMENT0 + i;
+				}
+				if (depth && h->raster_pass.offscreen.depth_stencil.store == RENOIR_STORE_ACTION_DISCARD)
+					invalidate[invalidate_count++] = _renoir_pixelformat_to_depth_attachment(depth->texture.desc.pixel_format);
+
+				if (invalidate_count > 0)
+					glInvalidateNamedFramebufferData(h->raster_pass.fb, invalidate_count, invalidate);
+			}
+
 			if (scissor_enabled)
 				glEnable(GL_SCISSOR_TEST);
 			else
@@ -2286,8 +5219,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 			mn_unreachable_msg("invalid pass");
 		}
 		self->current_pass = nullptr;
-		self->current_pipeline->pipeline.desc = Renoir_Pipeline_Desc{};
-		_renoir_gl450_pipeline_desc_defaults(&self->current_pipeline->pipeline.desc);
+		self->current_pipeline = nullptr;
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2334,6 +5266,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		if (command->pass_clear.desc.flags & RENOIR_CLEAR_DEPTH)
 		{
 			glDepthMask(GL_TRUE);
+			self->gl_state.depth_write_mask = GL_TRUE;
 			glClearDepth(command->pass_clear.desc.depth);
 			glClearStencil(command->pass_clear.desc.stencil);
 			clear_bits |= GL_DEPTH_BUFFER_BIT;
@@ -2345,128 +5278,142 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	}
 	case RENOIR_COMMAND_KIND_USE_PIPELINE:
 	{
-		self->current_pipeline = command->use_pipeline.pipeline;
-		auto h = self->current_pipeline;
-
-		if (h->pipeline.desc.rasterizer.cull == RENOIR_SWITCH_ENABLE)
+		// use the fallback pipeline until the program is compiled, and skip the draws if there's none
+		auto pipeline = command->use_pipeline.pipeline;
+		self->skip_draws = false;
+#if RENOIR_STATS
+		++self->frame_stats.pipeline_binds;
+#endif
+		if (_renoir_gl450_program_poll(self, pipeline->pipeline.program) == false)
 		{
-			auto gl_face = _renoir_face_to_gl(h->pipeline.desc.rasterizer.cull_face);
-			auto gl_orientation = _renoir_orientation_to_gl(h->pipeline.desc.rasterizer.cull_front);
-			glEnable(GL_CULL_FACE);
-			glCullFace(gl_face);
-			glFrontFace(gl_orientation);
-		}
-		else
-		{
-			glDisable(GL_CULL_FACE);
+			auto fallback = pipeline->pipeline.fallback;
+			if (fallback != nullptr && _renoir_gl450_program_poll(self, fallback->pipeline.program))
+				pipeline = fallback;
+			else
+				self->skip_draws = true;
 		}
 
-		switch (h->pipeline.desc.rasterizer.scissor)
-		{
-		case RENOIR_SWITCH_ENABLE:
-			glEnable(GL_SCISSOR_TEST);
-			break;
-		case RENOIR_SWITCH_DISABLE:
-			glDisable(GL_SCISSOR_TEST);
-			break;
-		default:
-			mn_unreachable();
+		self->current_pipeline = pipeline;
+		if (self->skip_draws)
 			break;
-		}
 
-		if (h->pipeline.desc.depth_stencil.depth == RENOIR_SWITCH_ENABLE)
-		{
-			glEnable(GL_DEPTH_TEST);
+		auto& state = self->current_pipeline->pipeline.state;
+		auto program = self->current_pipeline->pipeline.program->program.id;
+		auto& current = self->gl_state;
+
+		// the shadow state is invalid at the start and after the gl state is touched outside renoir (external context)
+		auto force = self->gl_state_valid == false;
+		if (force)
 			glDepthRange(0.0, 1.0);
-		}
-		else
-		{
-			glDisable(GL_DEPTH_TEST);
-		}
 
-		if (h->pipeline.desc.depth_stencil.depth_write_mask == RENOIR_SWITCH_ENABLE)
-		{
-			glDepthMask(GL_TRUE);
-		}
-		else
+		size_t emitted = 0, skipped = 0;
+		auto diff = [&](bool changed) {
+			if (changed || force)
+				++emitted;
+			else
+				++skipped;
+			return changed || force;
+		};
+
+		if (diff(state.cull != current.cull))
+			_renoir_gl450_enable(GL_CULL_FACE, state.cull);
+		if (state.cull || force)
 		{
-			glDepthMask(GL_FALSE);
+			if (diff(state.cull_face != current.cull_face))
+				glCullFace(state.cull_face);
+			if (diff(state.front_face != current.front_face))
+				glFrontFace(state.front_face);
 		}
 
-		for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+		if (diff(state.scissor != current.scissor))
+			_renoir_gl450_enable(GL_SCISSOR_TEST, state.scissor);
+		if (diff(state.depth != current.depth))
+			_renoir_gl450_enable(GL_DEPTH_TEST, state.depth);
+		if (diff(state.depth_write_mask != current.depth_write_mask))
+			glDepthMask(state.depth_write_mask);
+
+		if (state.independent_blend)
 		{
-			if (h->pipeline.desc.blend[i].enabled == RENOIR_SWITCH_ENABLE)
+			for (GLuint i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
 			{
-				auto gl_src_rgb = _renoir_blend_to_gl(h->pipeline.desc.blend[i].src_rgb);
-				auto gl_dst_rgb = _renoir_blend_to_gl(h->pipeline.desc.blend[i].dst_rgb);
-				auto gl_src_alpha = _renoir_blend_to_gl(h->pipeline.desc.blend[i].src_alpha);
-				auto gl_dst_alpha = _renoir_blend_to_gl(h->pipeline.desc.blend[i].dst_alpha);
-				auto gl_blend_eq_rgb = _renoir_blend_eq_to_gl(h->pipeline.desc.blend[i].eq_rgb);
-				auto gl_blend_eq_alpha = _renoir_blend_eq_to_gl(h->pipeline.desc.blend[i].eq_alpha);
-				if (h->pipeline.desc.independent_blend == RENOIR_SWITCH_ENABLE)
-				{
-					glEnablei(GL_BLEND, i);
-					glBlendFuncSeparatei(i, gl_src_rgb, gl_dst_rgb, gl_src_alpha, gl_dst_alpha);
-					glBlendEquationSeparatei(i, gl_blend_eq_rgb, gl_blend_eq_alpha);
-				}
-				else
+				auto& blend = state.blend[i];
+				auto& current_blend = current.blend[i];
+				if (diff(blend.enabled != current_blend.enabled))
+					_renoir_gl450_enablei(GL_BLEND, i, blend.enabled);
+				if (blend.enabled || force)
 				{
-					glEnable(GL_BLEND);
-					glBlendFuncSeparate(gl_src_rgb, gl_dst_rgb, gl_src_alpha, gl_dst_alpha);
-					glBlendEquationSeparate(gl_blend_eq_rgb, gl_blend_eq_alpha);
+					if (diff(_renoir_gl450_blend_func_equal(blend, current_blend) == false))
+						glBlendFuncSeparatei(i, blend.src_rgb, blend.dst_rgb, blend.src_alpha, blend.dst_alpha);
+					if (diff(_renoir_gl450_blend_eq_equal(blend, current_blend) == false))
+						glBlendEquationSeparatei(i, blend.eq_rgb, blend.eq_alpha);
 				}
+				if (diff(_renoir_gl450_color_mask_equal(blend, current_blend) == false))
+					glColorMaski(i, blend.color_mask[0], blend.color_mask[1], blend.color_mask[2], blend.color_mask[3]);
 			}
-			else
+		}
+		else
+		{
+			// non indexed calls set all the attachments, so they're needed if any attachment differs
+			bool enabled_changed = false, func_changed = false, eq_changed = false, color_mask_changed = false;
+			auto& blend = state.blend[0];
+			for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
 			{
-				if (h->pipeline.desc.independent_blend == RENOIR_SWITCH_ENABLE)
-				{
-					glDisablei(GL_BLEND, i);
-				}
-				else
-				{
-					glDisable(GL_BLEND);
-				}
+				auto& current_blend = current.blend[i];
+				enabled_changed |= blend.enabled != current_blend.enabled;
+				func_changed |= _renoir_gl450_blend_func_equal(blend, current_blend) == false;
+				eq_changed |= _renoir_gl450_blend_eq_equal(blend, current_blend) == false;
+				color_mask_changed |= _renoir_gl450_color_mask_equal(blend, current_blend) == false;
 			}
 
-			if (h->pipeline.desc.independent_blend == RENOIR_SWITCH_ENABLE)
+			if (diff(enabled_changed))
+				_renoir_gl450_enable(GL_BLEND, blend.enabled);
+			if (blend.enabled || force)
 			{
-				if (h->pipeline.desc.blend[i].color_mask == RENOIR_COLOR_MASK_NONE)
-				{
-					glColorMaski(i, false, false, false, false);
-				}
-				else
-				{
-					glColorMaski(
-						i,
-						(h->pipeline.desc.blend[i].color_mask & RENOIR_COLOR_MASK_RED) != 0,
-						(h->pipeline.desc.blend[i].color_mask & RENOIR_COLOR_MASK_GREEN) != 0,
-						(h->pipeline.desc.blend[i].color_mask & RENOIR_COLOR_MASK_BLUE) != 0,
-						(h->pipeline.desc.blend[i].color_mask & RENOIR_COLOR_MASK_ALPHA) != 0
-					);
-				}
+				if (diff(func_changed))
+					glBlendFuncSeparate(blend.src_rgb, blend.dst_rgb, blend.src_alpha, blend.dst_alpha);
+				if (diff(eq_changed))
+					glBlendEquationSeparate(blend.eq_rgb, blend.eq_alpha);
+			}
+			if (diff(color_mask_changed))
+				glColorMask(blend.color_mask[0], blend.color_mask[1], blend.color_mask[2], blend.color_mask[3]);
+		}
+
+		if (diff(program != current.program))
+			glUseProgram(program);
+
+		// update the shadow state, blend funcs of disabled attachments are not issued so we keep the old values
+		for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+		{
+			if (state.blend[i].enabled == false && force == false)
+			{
+				auto old = current.blend[i];
+				current.blend[i] = state.blend[i];
+				current.blend[i].src_rgb = old.src_rgb;
+				current.blend[i].dst_rgb = old.dst_rgb;
+				current.blend[i].src_alpha = old.src_alpha;
+				current.blend[i].dst_alpha = old.dst_alpha;
+				current.blend[i].eq_rgb = old.eq_rgb;
+				current.blend[i].eq_alpha = old.eq_alpha;
 			}
 			else
 			{
-				if (h->pipeline.desc.blend[i].color_mask == RENOIR_COLOR_MASK_NONE)
-				{
-					glColorMask(false, false, false, false);
-				}
-				else
-				{
-					glColorMask(
-						(h->pipeline.desc.blend[i].color_mask& RENOIR_COLOR_MASK_RED) != 0,
-						(h->pipeline.desc.blend[i].color_mask& RENOIR_COLOR_MASK_GREEN) != 0,
-						(h->pipeline.desc.blend[i].color_mask& RENOIR_COLOR_MASK_BLUE) != 0,
-						(h->pipeline.desc.blend[i].color_mask& RENOIR_COLOR_MASK_ALPHA) != 0
-					);
-				}
+				current.blend[i] = state.blend[i];
 			}
-
-			if (h->pipeline.desc.independent_blend == RENOIR_SWITCH_DISABLE)
-				break;
 		}
+		current.cull = state.cull;
+		if (state.cull || force)
+		{
+			current.cull_face = state.cull_face;
+			current.front_face = state.front_face;
+		}
+		current.scissor = state.scissor;
+		current.depth = state.depth;
+		current.depth_write_mask = state.depth_write_mask;
+		current.program = program;
+		self->gl_state_valid = true;
 
-		glUseProgram(h->pipeline.program->program.id);
+		self->gl_state_calls_emitted_frame += emitted;
+		self->gl_state_calls_skipped_frame += skipped;
 
 		mn_assert(_renoir_gl450_check());
 		break;
@@ -2475,7 +5422,11 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	{
 		auto h = command->use_compute.compute;
 		self->current_compute = h;
+		self->skip_dispatches = _renoir_gl450_program_poll(self, h) == false;
+		if (self->skip_dispatches)
+			break;
 		glUseProgram(self->current_compute->compute.id);
+		self->gl_state.program = h->compute.id;
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2488,6 +5439,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_BUFFER_CLEAR:
 	{
 		auto h = command->buffer_clear.handle;
+		_renoir_gl450_barrier_use(self, h, GL_BUFFER_UPDATE_BARRIER_BIT);
 		uint8_t value = 0;
 		glClearNamedBufferData(h->buffer.id, GL_R8UI, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &value);
 		mn_assert(_renoir_gl450_check());
@@ -2496,6 +5448,10 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_BUFFER_WRITE:
 	{
 		auto h = command->buffer_write.handle;
+#if RENOIR_STATS
+		self->frame_stats.upload_bytes += command->buffer_write.bytes_size;
+#endif
+		_renoir_gl450_barrier_use(self, h, GL_BUFFER_UPDATE_BARRIER_BIT);
 		glNamedBufferSubData(
 			h->buffer.id,
 			command->buffer_write.offset,
@@ -2508,6 +5464,10 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_TEXTURE_WRITE:
 	{
 		auto h = command->texture_write.handle;
+#if RENOIR_STATS
+		self->frame_stats.upload_bytes += command->texture_write.desc.bytes_size;
+#endif
+		_renoir_gl450_barrier_use(self, h, GL_TEXTURE_UPDATE_BARRIER_BIT);
 		auto gl_format = _renoir_pixelformat_to_gl(h->texture.desc.pixel_format);
 		auto gl_type = _renoir_pixelformat_to_type_gl(h->texture.desc.pixel_format);
 
@@ -2600,6 +5560,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_BUFFER_READ:
 	{
 		auto h = command->buffer_read.handle;
+		_renoir_gl450_barrier_use(self, h, GL_BUFFER_UPDATE_BARRIER_BIT);
 		void* ptr = glMapNamedBufferRange(
 			h->buffer.id,
 			command->buffer_read.offset,
@@ -2614,6 +5575,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_TEXTURE_READ:
 	{
 		auto h = command->texture_read.handle;
+		_renoir_gl450_barrier_use(self, h, GL_TEXTURE_UPDATE_BARRIER_BIT);
 		auto gl_format = _renoir_pixelformat_to_gl(h->texture.desc.pixel_format);
 		auto gl_type = _renoir_pixelformat_to_type_gl(h->texture.desc.pixel_format);
 
@@ -2708,9 +5670,19 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_BUFFER_BIND:
 	{
 		auto h = command->buffer_bind.handle;
-		mn_assert(h->buffer.type == RENOIR_BUFFER_UNIFORM || h->buffer.type == RENOIR_BUFFER_COMPUTE);
+		mn_assert(h->buffer.type == RENOIR_BUFFER_UNIFORM || h->buffer.type == RENOIR_BUFFER_COMPUTE || h->buffer.type == RENOIR_BUFFER_INDIRECT);
 		auto gl_type = _renoir_buffer_type_to_gl(h->buffer.type);
-		glBindBufferBase(gl_type, command->buffer_bind.slot, h->buffer.id);
+		// indirect buffers are bound as storage buffers so compute shaders can write the arguments
+		if (h->buffer.type == RENOIR_BUFFER_INDIRECT)
+			gl_type = GL_SHADER_STORAGE_BUFFER;
+		_renoir_gl450_buffer_range_bind(gl_type, command->buffer_bind.slot, h, command->buffer_bind.offset, command->buffer_bind.size);
+		_renoir_gl450_binding_set(
+			self,
+			h,
+			gl_type == GL_UNIFORM_BUFFER ? GL_UNIFORM_BARRIER_BIT : GL_SHADER_STORAGE_BARRIER_BIT,
+			command->buffer_bind.slot,
+			command->buffer_bind.gpu_access
+		);
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2723,7 +5695,15 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 				continue;
 
 			auto gl_type = _renoir_buffer_type_to_gl(h->buffer.type);
-			glBindBufferBase(gl_type, command->buffer_storage_bind.start_slot + i, h->buffer.id);
+			_renoir_gl450_buffer_range_bind(
+				gl_type,
+				command->buffer_storage_bind.start_slot + i,
+				h,
+				command->buffer_storage_bind.offsets[i],
+				command->buffer_storage_bind.sizes[i]
+			);
+			// only the compute writes are tracked, so raster storage binds are treated as reads
+			_renoir_gl450_binding_set(self, h, GL_SHADER_STORAGE_BARRIER_BIT, command->buffer_storage_bind.start_slot + i, RENOIR_ACCESS_READ);
 		}
 		mn_assert(_renoir_gl450_check());
 		break;
@@ -2731,6 +5711,9 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_TEXTURE_BIND:
 	{
 		auto h = command->texture_bind.handle;
+#if RENOIR_STATS
+		++self->frame_stats.texture_binds;
+#endif
 		glActiveTexture(GL_TEXTURE0 + command->texture_bind.slot);
 		if (command->texture_bind.sampler == nullptr)
 		{
@@ -2752,6 +5735,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 				gl_gpu_access,
 				gl_format
 			);
+			_renoir_gl450_binding_set(self, h, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT, command->texture_bind.slot, command->texture_bind.gpu_access);
 		}
 		else
 		{
@@ -2779,6 +5763,7 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 			}
 			// bind the used sampler
 			glBindSampler(command->texture_bind.slot, command->texture_bind.sampler->sampler.id);
+			_renoir_gl450_binding_set(self, h, GL_TEXTURE_FETCH_BARRIER_BIT, command->texture_bind.slot, RENOIR_ACCESS_READ);
 		}
 		mn_assert(_renoir_gl450_check());
 		break;
@@ -2786,90 +5771,77 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_DRAW:
 	{
 		mn_assert_msg(self->current_pipeline, "you should use a pipeline before drawing");
+		if (self->skip_draws)
+			break;
 
-		auto& desc = command->draw.desc;
-		glBindVertexArray(self->vao);
-
-		for (size_t i = 0; i < RENOIR_CONSTANT_DRAW_VERTEX_BUFFER_SIZE; ++i)
-		{
-			auto& vertex = desc.vertex_buffers[i];
-			if (vertex.buffer.handle == nullptr)
-				continue;
-
-			// calculate the default stride for the vertex buffer
-			if (vertex.stride == 0)
-				vertex.stride = _renoir_type_to_size(vertex.type);
-
-			auto h = (Renoir_Handle*)vertex.buffer.handle;
-
-			glBindBuffer(GL_ARRAY_BUFFER, h->buffer.id);
-
-			GLint gl_size = _renoir_type_to_gl_element_count(vertex.type);
-			GLenum gl_type = _renoir_type_to_gl(vertex.type);
+#if RENOIR_STATS
+		++self->frame_stats.draws;
+		self->frame_stats.primitives += _renoir_primitive_count(command->draw.primitive, command->draw.elements_count, command->draw.instances_count);
+#endif
+		_renoir_gl450_bindings_barrier(self);
+		_renoir_gl450_draw_barrier(self, command->draw.vertex_buffers, command->draw.vertex_buffers_count, command->draw.index_buffer);
+		if (self->settings.merge_draws)
+			_renoir_gl450_draw_batch_push(self, command);
+		else
+			_renoir_gl450_draw_execute(self, command);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_DRAW_INDIRECT:
+	{
+		mn_assert_msg(self->current_pipeline, "you should use a pipeline before drawing");
+		if (self->skip_draws)
+			break;
 
-			if (_renoir_type_is_int(vertex.type))
-			{
-				glVertexAttribIPointer(
-					GLuint(i),
-					gl_size,
-					gl_type,
-					vertex.stride,
-					(void*)vertex.offset
-				);
-			}
-			else
-			{
-				bool gl_normalized = _renoir_type_normalized(vertex.type);
-				glVertexAttribPointer(
-					GLuint(i),
-					gl_size,
-					gl_type,
-					gl_normalized,
-					vertex.stride,
-					(void*)vertex.offset
-				);
-			}
-			glEnableVertexAttribArray(i);
-		}
+		auto& desc = command->draw_indirect;
+#if RENOIR_STATS
+		self->frame_stats.draws += desc.draw_count;
+#endif
+		_renoir_gl450_bindings_barrier(self);
+		_renoir_gl450_draw_barrier(self, desc.vertex_buffers, desc.vertex_buffers_count, desc.index_buffer);
+		_renoir_gl450_barrier_use(self, desc.indirect_buffer, GL_COMMAND_BARRIER_BIT);
+		_renoir_gl450_barrier_use(self, desc.count_buffer, GL_COMMAND_BARRIER_BIT);
+		_renoir_gl450_vertex_array_bind(self, desc.layout, desc.vertex_buffers, desc.vertex_buffers_count, desc.index_buffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, desc.indirect_buffer->buffer.id);
 
 		auto gl_primitive = _renoir_primitive_to_gl(desc.primitive);
-		if (desc.index_buffer.handle != nullptr)
+		auto indirect = (const void*)desc.indirect_offset;
+		if (desc.count_buffer != nullptr)
 		{
-			if (desc.index_type == RENOIR_TYPE_NONE)
-				desc.index_type = RENOIR_TYPE_UINT16;
-
-			auto gl_index_type = _renoir_type_to_gl(desc.index_type);
-			auto gl_index_type_size = _renoir_type_to_size(desc.index_type);
-
-			auto h = (Renoir_Handle*)desc.index_buffer.handle;
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, h->buffer.id);
+			// the recorders check it, this only catches the draws which were recorded before init executed
+			mn_assert_msg(self->draw_indirect_count_supported.load(), "draw_indirect_count needs ARB_indirect_parameters which is not supported");
+			if (self->draw_indirect_count_supported.load() == false)
+				break;
 
-			if (desc.instances_count > 1)
+			glBindBuffer(GL_PARAMETER_BUFFER_ARB, desc.count_buffer->buffer.id);
+			if (desc.index_buffer.handle != nullptr)
 			{
-				glDrawElementsInstanced(
+				glMultiDrawElementsIndirectCountARB(
 					gl_primitive,
-					desc.elements_count,
-					gl_index_type,
-					(void*)(desc.base_element * gl_index_type_size),
-					desc.instances_count
+					_renoir_type_to_gl(desc.index_type),
+					indirect,
+					(GLintptr)desc.count_offset,
+					desc.draw_count,
+					GLsizei(desc.indirect_stride)
 				);
 			}
 			else
 			{
-				glDrawElements(
+				glMultiDrawArraysIndirectCountARB(
 					gl_primitive,
-					desc.elements_count,
-					gl_index_type,
-					(void*)(desc.base_element * gl_index_type_size)
+					indirect,
+					(GLintptr)desc.count_offset,
+					desc.draw_count,
+					GLsizei(desc.indirect_stride)
 				);
 			}
 		}
 		else
 		{
-			if (desc.instances_count > 1)
-				glDrawArraysInstanced(gl_primitive, desc.base_element, desc.elements_count, desc.instances_count);
+			if (desc.index_buffer.handle != nullptr)
+				glMultiDrawElementsIndirect(gl_primitive, _renoir_type_to_gl(desc.index_type), indirect, desc.draw_count, GLsizei(desc.indirect_stride));
 			else
-				glDrawArrays(gl_primitive, desc.base_element, desc.elements_count);
+				glMultiDrawArraysIndirect(gl_primitive, indirect, desc.draw_count, GLsizei(desc.indirect_stride));
 		}
 		mn_assert(_renoir_gl450_check());
 		break;
@@ -2877,9 +5849,39 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_DISPATCH:
 	{
 		mn_assert_msg(self->current_compute, "you should use a compute before dispatching it");
+		if (self->skip_dispatches)
+			break;
+#if RENOIR_STATS
+		++self->frame_stats.dispatches;
+#endif
+		_renoir_gl450_bindings_barrier(self);
 		glDispatchCompute(command->dispatch.x, command->dispatch.y, command->dispatch.z);
-		// Note(Moustapha): not sure about this barrier
-		glMemoryBarrier(GL_ALL_BARRIER_BITS);
+		_renoir_gl450_bindings_written(self);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_DISPATCH_INDIRECT:
+	{
+		mn_assert_msg(self->current_compute, "you should use a compute before dispatching it");
+		if (self->skip_dispatches)
+			break;
+#if RENOIR_STATS
+		++self->frame_stats.dispatches;
+#endif
+		auto h = command->dispatch_indirect.buffer;
+		_renoir_gl450_bindings_barrier(self);
+		_renoir_gl450_barrier_use(self, h, GL_COMMAND_BARRIER_BIT);
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, h->buffer.id);
+		glDispatchComputeIndirect((GLintptr)command->dispatch_indirect.offset);
+		_renoir_gl450_bindings_written(self);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_BARRIER:
+	{
+		auto bits = _renoir_barrier_to_gl(command->barrier.barriers);
+		if (bits != 0)
+			_renoir_gl450_barrier_issue(self, bits);
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
@@ -2897,6 +5899,18 @@ _renoir_gl450_command_execute(IRenoir* self, Renoir_Command* command)
 		mn_assert(_renoir_gl450_check());
 		break;
 	}
+	case RENOIR_COMMAND_KIND_PROFILE_BEGIN:
+	{
+		_renoir_gl450_profile_scope_begin(self, command->profile_begin.name, command->profile_begin.name_size);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
+	case RENOIR_COMMAND_KIND_PROFILE_END:
+	{
+		_renoir_gl450_profile_scope_end(self);
+		mn_assert(_renoir_gl450_check());
+		break;
+	}
 	default:
 		mn_unreachable();
 		break;
@@ -2924,78 +5938,68 @@ _renoir_gl450_sampler_free(IRenoir* self, Renoir_Handle* h)
 	_renoir_gl450_command_process(self, command);
 }
 
-inline static bool
-operator==(const Renoir_Sampler_Desc& a, const Renoir_Sampler_Desc& b)
+inline static void
+_renoir_gl450_sampler_lru_remove(IRenoir* self, Renoir_Handle* h)
 {
-	return (
-		a.filter == b.filter &&
-		a.u == b.u &&
-		a.v == b.v &&
-		a.w == b.w &&
-		a.compare == b.compare &&
-		a.border.r == b.border.r &&
-		a.border.g == b.border.g &&
-		a.border.b == b.border.b &&
-		a.border.a == b.border.a
-	);
+	if (h->sampler.lru_prev)
+		h->sampler.lru_prev->sampler.lru_next = h->sampler.lru_next;
+	else
+		self->sampler_lru_head = h->sampler.lru_next;
+
+	if (h->sampler.lru_next)
+		h->sampler.lru_next->sampler.lru_prev = h->sampler.lru_prev;
+	else
+		self->sampler_lru_tail = h->sampler.lru_prev;
+
+	h->sampler.lru_prev = nullptr;
+	h->sampler.lru_next = nullptr;
+}
+
+inline static void
+_renoir_gl450_sampler_lru_push_front(IRenoir* self, Renoir_Handle* h)
+{
+	h->sampler.lru_prev = nullptr;
+	h->sampler.lru_next = self->sampler_lru_head;
+	if (self->sampler_lru_head)
+		self->sampler_lru_head->sampler.lru_prev = h;
+	self->sampler_lru_head = h;
+	if (self->sampler_lru_tail == nullptr)
+		self->sampler_lru_tail = h;
 }
 
 inline static Renoir_Handle*
 _renoir_gl450_sampler_get(IRenoir* self, Renoir_Sampler_Desc desc)
 {
-	size_t best_ix = self->sampler_cache.count;
-	size_t first_empty_ix = self->sampler_cache.count;
-	for (size_t i = 0; i < self->sampler_cache.count; ++i)
-	{
-		auto hsampler = self->sampler_cache[i];
-		if (hsampler == nullptr)
-		{
-			if (first_empty_ix == self->sampler_cache.count)
-				first_empty_ix = i;
-			continue;
-		}
-
-		if (desc == hsampler->sampler.desc)
-		{
-			best_ix = i;
-			break;
-		}
-	}
-
-	// we found what we were looking for
-	if (best_ix < self->sampler_cache.count)
+	// we found what we were looking for, so move it to the front of the lru list
+	if (auto it = mn::map_lookup(self->sampler_cache, desc))
 	{
-		auto res = self->sampler_cache[best_ix];
-		// reorder the cache
-		for (size_t i = 0; i < best_ix; ++i)
+		++self->sampler_cache_hits;
+		auto res = it->value;
+		if (self->sampler_lru_head != res)
 		{
-			auto index = best_ix - i - 1;
-			self->sampler_cache[index + 1] = self->sampler_cache[index];
+			_renoir_gl450_sampler_lru_remove(self, res);
+			_renoir_gl450_sampler_lru_push_front(self, res);
 		}
-		self->sampler_cache[0] = res;
 		return res;
 	}
 
-	// we didn't find a matching sampler, so create new one
-	size_t sampler_ix = first_empty_ix;
+	++self->sampler_cache_misses;
 
-	// we didn't find an empty slot for the new sampler, so we'll have to make one for it
-	if (sampler_ix == self->sampler_cache.count)
+	// the cache is full, so evict the least recently used sampler
+	if (self->sampler_cache.count >= size_t(self->settings.sampler_cache_size))
 	{
-		auto to_be_evicted = mn::buf_top(self->sampler_cache);
-		for (size_t i = 0; i + 1 < self->sampler_cache.count; ++i)
-		{
-			auto index = self->sampler_cache.count - i - 1;
-			self->sampler_cache[index] = self->sampler_cache[index - 1];
-		}
+		auto to_be_evicted = self->sampler_lru_tail;
+		_renoir_gl450_sampler_lru_remove(self, to_be_evicted);
+		mn::map_remove(self->sampler_cache, to_be_evicted->sampler.desc);
 		_renoir_gl450_sampler_free(self, to_be_evicted);
+		++self->sampler_cache_evictions;
 		mn::log_warning("gl450: sampler evicted");
-		sampler_ix = 0;
 	}
 
 	// create the new sampler and put it at the head of the cache
 	auto sampler = _renoir_gl450_sampler_new(self, desc);
-	self->sampler_cache[sampler_ix] = sampler;
+	mn::map_insert(self->sampler_cache, desc, sampler);
+	_renoir_gl450_sampler_lru_push_front(self, sampler);
 	return sampler;
 }
 
@@ -3017,6 +6021,14 @@ _renoir_gl450_handle_leak_free(IRenoir* self, Renoir_Command* command)
 		auto h = command->pass_free.handle;
 		if (_renoir_gl450_handle_unref(h) == false)
 			break;
+		_renoir_gl450_pass_recorder_free(self, h);
+		if (auto parent = _renoir_gl450_pass_recorder(h).parent)
+		{
+			Renoir_Command command{};
+			command.kind = RENOIR_COMMAND_KIND_PASS_FREE;
+			command.pass_free.handle = parent;
+			_renoir_gl450_handle_leak_free(self, &command);
+		}
 		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
 		{
 			// free all the bound textures if it's a framebuffer pass
@@ -3029,18 +6041,20 @@ _renoir_gl450_handle_leak_free(IRenoir* self, Renoir_Command* command)
 						continue;
 
 					// issue command to free the color texture
-					auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
-					command->texture_free.handle = color;
-					_renoir_gl450_handle_leak_free(self, command);
+					Renoir_Command command{};
+					command.kind = RENOIR_COMMAND_KIND_TEXTURE_FREE;
+					command.texture_free.handle = color;
+					_renoir_gl450_handle_leak_free(self, &command);
 				}
 
 				auto depth = (Renoir_Handle*)h->raster_pass.offscreen.depth_stencil.texture.handle;
 				if (depth)
 				{
 					// issue command to free the depth texture
-					auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
-					command->texture_free.handle = depth;
-					_renoir_gl450_handle_leak_free(self, command);
+					Renoir_Command command{};
+					command.kind = RENOIR_COMMAND_KIND_TEXTURE_FREE;
+					command.texture_free.handle = depth;
+					_renoir_gl450_handle_leak_free(self, &command);
 				}
 			}
 		}
@@ -3087,6 +6101,16 @@ _renoir_gl450_handle_leak_free(IRenoir* self, Renoir_Command* command)
 		_renoir_gl450_handle_free(self, h);
 		break;
 	}
+	case RENOIR_COMMAND_KIND_READBACK_FREE:
+	{
+		auto h = command->readback_free.handle;
+		if (_renoir_gl450_handle_unref(h) == false)
+			break;
+		if (h->readback.data)
+			mn::free(mn::Block{h->readback.data, h->readback.size});
+		_renoir_gl450_handle_free(self, h);
+		break;
+	}
 	case RENOIR_COMMAND_KIND_TIMER_FREE:
 	{
 		auto h = command->timer_free.handle;
@@ -3102,9 +6126,17 @@ _renoir_gl450_handle_leak_free(IRenoir* self, Renoir_Command* command)
 			break;
 
 		// issue command to free the program
-		auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_FREE);
-		command->program_free.handle = h->pipeline.program;
-		_renoir_gl450_handle_leak_free(self, command);
+		Renoir_Command command{};
+		command.kind = RENOIR_COMMAND_KIND_PROGRAM_FREE;
+		command.program_free.handle = h->pipeline.program;
+		_renoir_gl450_handle_leak_free(self, &command);
+
+		if (h->pipeline.fallback)
+		{
+			command.kind = RENOIR_COMMAND_KIND_PIPELINE_FREE;
+			command.pipeline_free.handle = h->pipeline.fallback;
+			_renoir_gl450_handle_leak_free(self, &command);
+		}
 
 		_renoir_gl450_handle_free(self, h);
 		break;
@@ -3121,29 +6153,61 @@ _renoir_gl450_init(Renoir* api, Renoir_Settings settings, void* display)
 	if (settings.sampler_cache_size <= 0)
 		settings.sampler_cache_size = RENOIR_CONSTANT_DEFAULT_SAMPLER_CACHE_SIZE;
 
+	if (settings.frames_in_flight <= 0)
+		settings.frames_in_flight = RENOIR_CONSTANT_DEFAULT_FRAMES_IN_FLIGHT;
+
+	if (settings.render_thread)
+	{
+		if (settings.external_context)
+		{
+			mn::log_warning("render thread is not supported with an external context, it will be disabled");
+			settings.render_thread = false;
+		}
+		else
+		{
+			// commands are recorded on the api threads then executed on the render thread
+			settings.defer_api_calls = true;
+		}
+	}
+
 	auto ctx = renoir_gl450_context_new(&settings, display);
 	if (ctx == nullptr && settings.external_context == false)
 		return false;
 
 	auto self = mn::alloc_zerod<IRenoir>();
 	self->mtx = mn_mutex_new_with_srcloc("renoir gl450");
-	self->handle_pool = mn::pool_new(sizeof(Renoir_Handle), 128);
-	self->command_pool = mn::pool_new(sizeof(Renoir_Command), 128);
+	self->exec_mtx = mn_mutex_new_with_srcloc("renoir gl450 exec");
+	self->handle_mtx = mn_mutex_new_with_srcloc("renoir gl450 handles");
+	self->stats_mtx = mn_mutex_new_with_srcloc("renoir gl450 stats");
+	self->stream_mtx = mn_mutex_new_with_srcloc("renoir gl450 stream");
+	self->trace_mtx = mn_mutex_new_with_srcloc("renoir gl450 trace");
+	self->trace_id = _renoir_gl450_trace_ids.fetch_add(1) + 1;
+	self->trace_enabled = settings.trace;
+	for (int i = RENOIR_HANDLE_KIND_NONE + 1; i < RENOIR_HANDLE_KIND_COUNT; ++i)
+		self->handle_tables[i] = _renoir_gl450_handle_table_new(RENOIR_HANDLE_KIND(i));
+	self->allocator = _renoir_gl450_command_allocator_new();
 	self->settings = settings;
 	self->info_description = mn::str_new();
+	self->program_cache_driver = mn::str_new();
 	self->ctx = ctx;
-	self->sampler_cache = mn::buf_new<Renoir_Handle*>();
+	self->sampler_cache = mn::map_new<Renoir_Sampler_Desc, Renoir_Handle*, Renoir_GL450_Sampler_Desc_Hasher>();
 	self->state = _renoir_gl450_state_new();
 	self->alive_handles = mn::map_new<Renoir_Handle*, Renoir_Leak_Info>();
-	mn::buf_resize_fill(self->sampler_cache, self->settings.sampler_cache_size, nullptr);
-
-	self->current_pipeline = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_PIPELINE);
-	self->current_pipeline->pipeline.desc = Renoir_Pipeline_Desc{};
-	_renoir_gl450_pipeline_desc_defaults(&self->current_pipeline->pipeline.desc);
+	self->vertex_arrays = mn::map_new<uint64_t, Renoir_GL450_Vertex_Array>();
+	self->framebuffers = mn::map_new<Renoir_GL450_Framebuffer_Key, GLuint, Renoir_GL450_Framebuffer_Key_Hasher>();
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_INIT);
 	_renoir_gl450_command_process(self, command);
 
+	if (self->settings.render_thread)
+	{
+		// the context can only be current on one thread, and it's owned by the render thread from now on
+		renoir_gl450_context_unbind(self->ctx);
+		self->queue_mtx = mn_mutex_new_with_srcloc("renoir gl450 queue");
+		self->queue_cv = mn::cond_var_new();
+		self->render_thread = mn::thread_new(_renoir_gl450_render_thread_main, self, "renoir gl450 render thread");
+	}
+
 	api->ctx = self;
 
 	return true;
@@ -3153,9 +6217,46 @@ static void
 _renoir_gl450_dispose(Renoir* api)
 {
 	auto self = api->ctx;
+
+	// the render thread executes the queued frames before it quits
+	if (self->settings.render_thread)
+	{
+		mn::mutex_lock(self->queue_mtx);
+		self->queue_quit = true;
+		mn::cond_var_notify_all(self->queue_cv);
+		mn::mutex_unlock(self->queue_mtx);
+
+		mn::thread_join(self->render_thread);
+		mn::thread_free(self->render_thread);
+		mn::cond_var_free(self->queue_cv);
+		mn::mutex_free(self->queue_mtx);
+		mn::buf_free(self->queue);
+	}
+
+	// the queued programs are never compiled, their handles are freed below
+	if (self->program_compile == RENOIR_GL450_PROGRAM_COMPILE_WORKER)
+	{
+		mn::mutex_lock(self->compile_mtx);
+		self->compile_quit = true;
+		mn::cond_var_notify_all(self->compile_cv);
+		mn::mutex_unlock(self->compile_mtx);
+
+		mn::thread_join(self->compile_thread);
+		mn::thread_free(self->compile_thread);
+		mn::cond_var_free(self->compile_cv);
+		mn::mutex_free(self->compile_mtx);
+		for (auto& job: self->compile_jobs)
+			_renoir_gl450_job_free(job);
+		renoir_gl450_context_free(self->compile_ctx);
+	}
+	mn::buf_free(self->compile_jobs);
+	mn::buf_free(self->program_builds);
+
 	// process these commands for frees to give correct leak report
-	for (auto it = self->command_list_head; it != nullptr; it = it->next)
-		_renoir_gl450_handle_leak_free(self, it);
+	_renoir_gl450_command_stream_for_each(self->commands, [self](Renoir_Command* command) {
+		_renoir_gl450_handle_leak_free(self, command);
+	});
+	_renoir_gl450_command_stream_free(self, self->commands);
 	#if RENOIR_LEAK
 		for(auto[handle, info]: self->alive_handles)
 		{
@@ -3170,13 +6271,48 @@ _renoir_gl450_dispose(Renoir* api)
 			::fprintf(stderr, "renoir leak count: %zu, for callstack turn on 'RENOIR_LEAK' flag\n", self->alive_handles.count);
 	#endif
 	mn::mutex_free(self->mtx);
+	mn::mutex_free(self->exec_mtx);
+	mn::mutex_free(self->handle_mtx);
+	mn::mutex_free(self->stats_mtx);
+	mn::mutex_free(self->stream_mtx);
+	mn::mutex_free(self->trace_mtx);
 	renoir_gl450_context_free(self->ctx);
-	mn::pool_free(self->handle_pool);
-	mn::pool_free(self->command_pool);
+	for (auto& table: self->handle_tables)
+		_renoir_gl450_handle_table_free(table);
+	_renoir_gl450_command_allocator_orphan(self->allocator);
 	mn::str_free(self->info_description);
-	mn::buf_free(self->sampler_cache);
+	mn::str_free(self->program_cache_driver);
+	mn::map_free(self->sampler_cache);
 	_renoir_gl450_state_free(self->state);
 	mn::map_free(self->alive_handles);
+	mn::map_free(self->vertex_arrays);
+	mn::map_free(self->framebuffers);
+	mn::buf_free(self->framebuffers_evicted);
+	mn::buf_free(self->draw_batch_counts);
+	mn::buf_free(self->draw_batch_firsts);
+	mn::buf_free(self->draw_batch_indices);
+	mn::buf_free(self->stream_buffers);
+	mn::buf_free(self->stream_regions);
+	mn::buf_free(self->pending_readbacks);
+	mn::buf_free(self->bindings);
+	mn::buf_free(self->barrier_resources);
+	for (auto& frame: self->profile_frames)
+	{
+		mn::buf_free(frame.scopes);
+		mn::buf_free(frame.names);
+	}
+	mn::buf_free(self->profile_stack);
+	mn::buf_free(self->profile_queries);
+	mn::buf_free(self->profile_results);
+	mn::buf_free(self->profile_results_names);
+	mn::buf_free(self->profile_results_user);
+	mn::buf_free(self->profile_results_user_names);
+	for (auto ring: self->trace_rings)
+		mn::free(ring);
+	mn::buf_free(self->trace_rings);
+	if (self->trace_gpu_ring)
+		mn::free(self->trace_gpu_ring);
+	mn::buf_free(self->trace_gpu_scopes);
 	mn::free(self);
 }
 
@@ -3199,9 +6335,59 @@ _renoir_gl450_info(Renoir* api)
 
 	Renoir_Info res{};
 	res.description = self->info_description.ptr;
+
+	_renoir_gl450_mtx_lock(self);
+	res.upload_bytes_last_frame = self->upload_bytes_last_frame;
+	res.upload_bytes_high_water = self->upload_bytes_high_water;
+	res.sampler_cache_hits = self->sampler_cache_hits;
+	res.sampler_cache_misses = self->sampler_cache_misses;
+	res.sampler_cache_evictions = self->sampler_cache_evictions;
+	_renoir_gl450_mtx_unlock(self);
+
+	mn::mutex_lock(self->stats_mtx);
+	res.state_calls_emitted_last_frame = self->gl_state_calls_emitted_last_frame;
+	res.state_calls_skipped_last_frame = self->gl_state_calls_skipped_last_frame;
+	res.program_cache_hits = self->program_cache_hits;
+	res.program_cache_misses = self->program_cache_misses;
+	res.program_compile_time_in_nanos = self->program_compile_time_in_nanos;
+	res.program_load_time_in_nanos = self->program_load_time_in_nanos;
+	mn::mutex_unlock(self->stats_mtx);
+	res.uniform_buffer_offset_alignment = self->uniform_buffer_offset_alignment.load();
+	res.storage_buffer_offset_alignment = self->storage_buffer_offset_alignment.load();
+	res.draw_indirect_count_supported = self->draw_indirect_count_supported.load();
 	return res;
 }
 
+static Renoir_Resource_Stats
+_renoir_gl450_resource_stats(Renoir* api)
+{
+	auto self = api->ctx;
+
+	mn::mutex_lock(self->handle_mtx);
+	mn_defer{mn::mutex_unlock(self->handle_mtx);};
+	return self->resource_stats;
+}
+
+static Renoir_Frame_Stats
+_renoir_gl450_frame_stats(Renoir* api)
+{
+#if RENOIR_STATS
+	auto self = api->ctx;
+
+	mn::mutex_lock(self->stats_mtx);
+	mn_defer{mn::mutex_unlock(self->stats_mtx);};
+	return self->frame_stats_last;
+#else
+	return Renoir_Frame_Stats{};
+#endif
+}
+
+static const char*
+_renoir_gl450_frame_stats_command_name(Renoir*, int kind)
+{
+	return _renoir_gl450_command_kind_name(kind);
+}
+
 static void
 _renoir_gl450_handle_ref(Renoir* api, void* handle)
 {
@@ -3212,10 +6398,26 @@ _renoir_gl450_handle_ref(Renoir* api, void* handle)
 static void
 _renoir_gl450_flush(Renoir* api, void*, void*)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "flush", trace_begin);};
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	auto frame = _renoir_gl450_frame_submit(self, nullptr);
+
+	// the render thread is disabled with external contexts, so here the frame is just handed to the render thread
+	if (self->settings.render_thread)
+	{
+		_renoir_gl450_render_thread_push(self, frame);
+		_renoir_gl450_mtx_unlock(self);
+		return;
+	}
+
+	// the execution lock is taken before releasing mtx so the frames execute in the order they were submitted
+	mn::mutex_lock(self->exec_mtx);
+	_renoir_gl450_mtx_unlock(self);
+	mn_defer{mn::mutex_unlock(self->exec_mtx);};
 
 	if (auto error = glGetError(); error != GL_NO_ERROR)
 	{
@@ -3225,28 +6427,29 @@ _renoir_gl450_flush(Renoir* api, void*, void*)
 	if (self->glewInited)
 		_renoir_gl450_state_capture(self->state);
 
+	// the external context could have changed the state behind our back
+	self->gl_state_valid = false;
+	self->current_vao = 0;
+
 	// process commands
-	for(auto it = self->command_list_head; it != nullptr; it = it->next)
-	{
-		_renoir_gl450_command_execute(self, it);
-		_renoir_gl450_command_free(self, it);
-	}
+	_renoir_gl450_command_stream_execute(self, frame.commands);
+	_renoir_gl450_frame_end(self, frame);
 
 	mn_assert(_renoir_gl450_check());
 
 	_renoir_gl450_state_reset(self->state);
-
-	self->command_list_head = nullptr;
-	self->command_list_tail = nullptr;
 }
 
 static Renoir_Swapchain
 _renoir_gl450_swapchain_new(Renoir* api, int width, int height, void* window, void* display)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "swapchain_new", trace_begin);};
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_SWAPCHAIN);
 	h->swapchain.width = width;
@@ -3257,18 +6460,21 @@ _renoir_gl450_swapchain_new(Renoir* api, int width, int height, void* window, vo
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_SWAPCHAIN_NEW);
 	command->swapchain_new.handle = h;
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Swapchain{h};
+	return Renoir_Swapchain{h, h->generation};
 }
 
 static void
 _renoir_gl450_swapchain_free(Renoir* api, Renoir_Swapchain swapchain)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "swapchain_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)swapchain.handle;
+	auto h = _renoir_gl450_handle_get(swapchain);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_SWAPCHAIN_FREE);
 	command->swapchain_free.handle = h;
@@ -3278,7 +6484,7 @@ _renoir_gl450_swapchain_free(Renoir* api, Renoir_Swapchain swapchain)
 static void
 _renoir_gl450_swapchain_resize(Renoir*, Renoir_Swapchain swapchain, int width, int height)
 {
-	auto h = (Renoir_Handle*)swapchain.handle;
+	auto h = _renoir_gl450_handle_get(swapchain);
 	mn_assert(h != nullptr);
 
 	h->swapchain.width = width;
@@ -3288,29 +6494,42 @@ _renoir_gl450_swapchain_resize(Renoir*, Renoir_Swapchain swapchain, int width, i
 static void
 _renoir_gl450_swapchain_present(Renoir* api, Renoir_Swapchain swapchain)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "swapchain_present", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)swapchain.handle;
+	auto h = _renoir_gl450_handle_get(swapchain);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	auto frame = _renoir_gl450_frame_submit(self, h);
 
-	// process commands
-	for(auto it = self->command_list_head; it != nullptr; it = it->next)
+	// the frame is moved to the render thread, this blocks if settings.frames_in_flight frames are already queued
+	if (self->settings.render_thread)
 	{
-		_renoir_gl450_command_execute(self, it);
-		_renoir_gl450_command_free(self, it);
+		_renoir_gl450_render_thread_push(self, frame);
+		_renoir_gl450_mtx_unlock(self);
+		return;
 	}
 
-	self->command_list_head = nullptr;
-	self->command_list_tail = nullptr;
+	// the execution lock is taken before releasing mtx so the frames execute in the order they were submitted
+	mn::mutex_lock(self->exec_mtx);
+	_renoir_gl450_mtx_unlock(self);
+	mn_defer{mn::mutex_unlock(self->exec_mtx);};
 
-	renoir_gl450_context_window_present(self->ctx, h);
+	// process commands
+	_renoir_gl450_command_stream_execute(self, frame.commands);
+	_renoir_gl450_frame_end(self, frame);
+
+	renoir_gl450_context_window_present(self->ctx, frame.swapchain);
 }
 
 static Renoir_Buffer
 _renoir_gl450_buffer_new(Renoir* api, Renoir_Buffer_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_new", trace_begin);};
+
 	if (desc.usage == RENOIR_USAGE_NONE)
 		desc.usage = RENOIR_USAGE_STATIC;
 
@@ -3324,16 +6543,33 @@ _renoir_gl450_buffer_new(Renoir* api, Renoir_Buffer_Desc desc)
 		mn_unreachable_msg("uniform buffers should be aligned to 16 bytes");
 	}
 
+	if (desc.usage == RENOIR_USAGE_STREAM && desc.data_size == 0)
+	{
+		mn_unreachable_msg("a stream buffer should have a size");
+	}
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_BUFFER);
 	h->buffer.access = desc.access;
 	h->buffer.type = desc.type;
 	h->buffer.usage = desc.usage;
 	h->buffer.size = desc.data_size;
+	_renoir_gl450_resource_bytes_add(self, h);
+
+	// stream buffers are created immediately even in deferred mode, because buffer_stream_alloc needs the mapped pointer
+	if (desc.usage == RENOIR_USAGE_STREAM)
+	{
+		Renoir_Command command{};
+		command.kind = RENOIR_COMMAND_KIND_BUFFER_NEW;
+		command.buffer_new.handle = h;
+		command.buffer_new.desc = desc;
+		_renoir_gl450_sync_run(self, _renoir_gl450_command_execute_job, &command);
+		return Renoir_Buffer{h, h->generation};
+	}
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_NEW);
 	command->buffer_new.handle = h;
@@ -3348,18 +6584,21 @@ _renoir_gl450_buffer_new(Renoir* api, Renoir_Buffer_Desc desc)
 		}
 	}
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Buffer{h};
+	return Renoir_Buffer{h, h->generation};
 }
 
 static void
 _renoir_gl450_buffer_free(Renoir* api, Renoir_Buffer buffer)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)buffer.handle;
+	auto h = _renoir_gl450_handle_get(buffer);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_FREE);
 	command->buffer_free.handle = h;
 	_renoir_gl450_command_process(self, command);
@@ -3369,15 +6608,78 @@ static size_t
 _renoir_gl450_buffer_size(Renoir* api, Renoir_Buffer buffer)
 {
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)buffer.handle;
+	auto h = _renoir_gl450_handle_get(buffer);
 	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_BUFFER);
 
 	return h->buffer.size;
 }
 
+static Renoir_Stream_Alloc
+_renoir_gl450_buffer_stream_alloc(Renoir* api, Renoir_Buffer buffer, size_t size, size_t alignment)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_stream_alloc", trace_begin);};
+
+	auto self = api->ctx;
+	auto h = _renoir_gl450_handle_get(buffer);
+	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert_msg(h->buffer.usage == RENOIR_USAGE_STREAM, "buffer_stream_alloc only works with stream buffers");
+	mn_assert_msg(size <= h->buffer.size, "stream allocation is larger than the stream buffer");
+
+	if (alignment == 0)
+		alignment = 1;
+
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
+
+	auto offset = (h->buffer.stream_head + alignment - 1) / alignment * alignment;
+	auto skipped = offset - h->buffer.stream_head;
+	// wrap around to the start of the buffer, the skipped tail is counted in this frame's region
+	if (offset + size > h->buffer.size)
+	{
+		skipped = h->buffer.size - h->buffer.stream_head;
+		offset = 0;
+	}
+
+	h->buffer.stream_frame_size += skipped + size;
+	mn_assert_msg(h->buffer.stream_frame_size <= h->buffer.size, "stream buffer is too small for the data streamed in a single frame");
+
+	// wait for the previous frames which the gpu may still be reading from this range
+	bool overlaps = false;
+	mn::mutex_lock(self->stream_mtx);
+	for (const auto& region: self->stream_regions)
+	{
+		if (region.buffer == h && _renoir_gl450_stream_region_overlaps(region, h->buffer.size, offset, size))
+		{
+			overlaps = true;
+			break;
+		}
+	}
+	mn::mutex_unlock(self->stream_mtx);
+
+	if (overlaps)
+	{
+		Renoir_GL450_Stream_Region range{};
+		range.buffer = h;
+		range.begin = offset;
+		range.size = size;
+		_renoir_gl450_sync_run(self, _renoir_gl450_stream_wait_job, &range);
+	}
+
+	h->buffer.stream_head = offset + size;
+
+	Renoir_Stream_Alloc res{};
+	res.ptr = h->buffer.stream_ptr + offset;
+	res.offset = offset;
+	return res;
+}
+
 static Renoir_Texture
 _renoir_gl450_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_new", trace_begin);};
+
 	mn_assert_msg(desc.size.width > 0, "a texture must have at least width");
 
 	if (desc.usage == RENOIR_USAGE_NONE)
@@ -3391,6 +6693,11 @@ _renoir_gl450_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 		mn_unreachable_msg("a dynamic texture with cpu access set to none is a static texture");
 	}
 
+	if (desc.usage == RENOIR_USAGE_STREAM)
+	{
+		mn_unreachable_msg("only buffers can have stream usage");
+	}
+
 	if (desc.usage == RENOIR_USAGE_STATIC && (desc.access == RENOIR_ACCESS_WRITE || desc.access == RENOIR_ACCESS_READ_WRITE))
 	{
 		mn_unreachable_msg("a static texture cannot have write access");
@@ -3403,13 +6710,14 @@ _renoir_gl450_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_TEXTURE);
 	h->texture.desc = desc;
 	::memset(h->texture.desc.data, 0, sizeof(h->texture.desc.data));
 	h->texture.desc.data_size = 0;
+	_renoir_gl450_resource_bytes_add(self, h);
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_NEW);
 	command->texture_new.handle = h;
@@ -3427,18 +6735,21 @@ _renoir_gl450_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 		}
 	}
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Texture{h};
+	return Renoir_Texture{h, h->generation};
 }
 
 static void
 _renoir_gl450_texture_free(Renoir* api, Renoir_Texture texture)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)texture.handle;
+	auto h = _renoir_gl450_handle_get(texture);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
 	command->texture_free.handle = h;
 	_renoir_gl450_command_process(self, command);
@@ -3447,7 +6758,7 @@ _renoir_gl450_texture_free(Renoir* api, Renoir_Texture texture)
 static void*
 _renoir_gl450_texture_native_handle(Renoir* api, Renoir_Texture texture)
 {
-	auto h = (Renoir_Handle*)texture.handle;
+	auto h = _renoir_gl450_handle_get(texture);
 	mn_assert(h != nullptr);
 	return (void*)h->texture.id;
 }
@@ -3455,7 +6766,7 @@ _renoir_gl450_texture_native_handle(Renoir* api, Renoir_Texture texture)
 static Renoir_Size
 _renoir_gl450_texture_size(Renoir* api, Renoir_Texture texture)
 {
-	auto h = (Renoir_Handle*)texture.handle;
+	auto h = _renoir_gl450_handle_get(texture);
 	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_TEXTURE);
 	return h->texture.desc.size;
 }
@@ -3463,7 +6774,7 @@ _renoir_gl450_texture_size(Renoir* api, Renoir_Texture texture)
 static Renoir_Texture_Desc
 _renoir_gl450_texture_desc(Renoir* api, Renoir_Texture texture)
 {
-	auto h = (Renoir_Handle*)texture.handle;
+	auto h = _renoir_gl450_handle_get(texture);
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_TEXTURE);
 	return h->texture.desc;
@@ -3472,6 +6783,9 @@ _renoir_gl450_texture_desc(Renoir* api, Renoir_Texture texture)
 static Renoir_Program
 _renoir_gl450_program_new(Renoir* api, Renoir_Program_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "program_new", trace_begin);};
+
 	mn_assert(desc.vertex.bytes != nullptr && desc.pixel.bytes != nullptr);
 	if (desc.vertex.size == 0)
 		desc.vertex.size = ::strlen(desc.vertex.bytes);
@@ -3482,8 +6796,8 @@ _renoir_gl450_program_new(Renoir* api, Renoir_Program_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_PROGRAM);
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_NEW);
@@ -3506,35 +6820,54 @@ _renoir_gl450_program_new(Renoir* api, Renoir_Program_Desc desc)
 		command->program_new.owns_data = true;
 	}
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Program{h};
+	return Renoir_Program{h, h->generation};
 }
 
 static void
 _renoir_gl450_program_free(Renoir* api, Renoir_Program program)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "program_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)program.handle;
+	auto h = _renoir_gl450_handle_get(program);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_FREE);
 	command->program_free.handle = h;
 	_renoir_gl450_command_process(self, command);
 }
 
+static bool
+_renoir_gl450_program_ready(Renoir* api, Renoir_Program program)
+{
+	auto self = api->ctx;
+	auto h = _renoir_gl450_handle_get(program);
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_PROGRAM);
+
+	if (self->settings.async_programs == false)
+		return true;
+	return h->program.ready;
+}
+
 static Renoir_Compute
 _renoir_gl450_compute_new(Renoir* api, Renoir_Compute_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "compute_new", trace_begin);};
+
 	mn_assert(desc.compute.bytes != nullptr);
 	if (desc.compute.size == 0)
 		desc.compute.size = ::strlen(desc.compute.bytes);
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_COMPUTE);
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_COMPUTE_NEW);
@@ -3548,58 +6881,84 @@ _renoir_gl450_compute_new(Renoir* api, Renoir_Compute_Desc desc)
 		command->compute_new.owns_data = true;
 	}
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Compute{h};
+	return Renoir_Compute{h, h->generation};
 }
 
 static void
 _renoir_gl450_compute_free(Renoir* api, Renoir_Compute compute)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "compute_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)compute.handle;
+	auto h = _renoir_gl450_handle_get(compute);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_COMPUTE_FREE);
 	command->compute_free.handle = h;
 	_renoir_gl450_command_process(self, command);
 }
 
+static bool
+_renoir_gl450_compute_ready(Renoir* api, Renoir_Compute compute)
+{
+	auto self = api->ctx;
+	auto h = _renoir_gl450_handle_get(compute);
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE);
+
+	if (self->settings.async_programs == false)
+		return true;
+	return h->compute.ready;
+}
+
 static Renoir_Pipeline
 _renoir_gl450_pipeline_new(Renoir* api, Renoir_Pipeline_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pipeline_new", trace_begin);};
+
 	auto self = api->ctx;
 
 	_renoir_gl450_pipeline_desc_defaults(&desc);
-	auto h_program = (Renoir_Handle*)desc.program.handle;
+	auto h_program = _renoir_gl450_handle_get(desc.program);
 	mn_assert(h_program);
 	mn_assert(h_program->kind == RENOIR_HANDLE_KIND_PROGRAM);
+	auto h_fallback = _renoir_gl450_handle_get(desc.fallback);
+	mn_assert(h_fallback == nullptr || h_fallback->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_PIPELINE);
 	h->pipeline.desc = desc;
 	h->pipeline.program = h_program;
+	h->pipeline.fallback = h_fallback;
+	h->pipeline.state = _renoir_gl450_pipeline_state_bake(desc);
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PIPELINE_NEW);
 	command->pipeline_new.handle = h;
 	_renoir_gl450_command_process(self, command);
 
-	return Renoir_Pipeline{h};
+	return Renoir_Pipeline{h, h->generation};
 }
 
 static void
 _renoir_gl450_pipeline_free(Renoir* api, Renoir_Pipeline pipeline)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pipeline_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pipeline.handle;
+	auto h = _renoir_gl450_handle_get(pipeline);
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PIPELINE_FREE);
 	command->pipeline_free.handle = h;
@@ -3609,30 +6968,37 @@ _renoir_gl450_pipeline_free(Renoir* api, Renoir_Pipeline pipeline)
 static Renoir_Pass
 _renoir_gl450_pass_swapchain_new(Renoir* api, Renoir_Swapchain swapchain)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_swapchain_new", trace_begin);};
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_RASTER_PASS);
-	h->raster_pass.swapchain = (Renoir_Handle*)swapchain.handle;
+	h->raster_pass.swapchain = _renoir_gl450_handle_get(swapchain);
+	h->raster_pass.recorder.allocator = _renoir_gl450_command_allocator_new();
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_SWAPCHAIN_NEW);
 	command->pass_swapchain_new.handle = h;
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Pass{h};
+	return Renoir_Pass{h, h->generation};
 }
 
 static Renoir_Pass
 _renoir_gl450_pass_offscreen_new(Renoir* api, Renoir_Pass_Offscreen_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_offscreen_new", trace_begin);};
+
 	auto self = api->ctx;
 
 	// check that all sizes match
 	int width = -1, height = -1;
 	for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
 	{
-		auto color = (Renoir_Handle*)desc.color[i].texture.handle;
+		auto color = _renoir_gl450_handle_get(desc.color[i].texture);
 		if (color == nullptr)
 			continue;
 
@@ -3649,7 +7015,7 @@ _renoir_gl450_pass_offscreen_new(Renoir* api, Renoir_Pass_Offscreen_Desc desc)
 		}
 	}
 
-	auto depth = (Renoir_Handle*)desc.depth_stencil.texture.handle;
+	auto depth = _renoir_gl450_handle_get(desc.depth_stencil.texture);
 	if (depth)
 	{
 		// first time getting the width/height
@@ -3665,45 +7031,77 @@ _renoir_gl450_pass_offscreen_new(Renoir* api, Renoir_Pass_Offscreen_Desc desc)
 		}
 	}
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_RASTER_PASS);
 	h->raster_pass.offscreen = desc;
 	h->raster_pass.width = width;
 	h->raster_pass.height = height;
+	h->raster_pass.recorder.allocator = _renoir_gl450_command_allocator_new();
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_OFFSCREEN_NEW);
 	command->pass_offscreen_new.handle = h;
 	command->pass_offscreen_new.desc = desc;
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Pass{h};
+	return Renoir_Pass{h, h->generation};
 }
 
 static Renoir_Pass
 _renoir_gl450_pass_compute_new(Renoir* api)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_compute_new", trace_begin);};
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_COMPUTE_PASS);
+	h->compute_pass.recorder.allocator = _renoir_gl450_command_allocator_new();
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW);
 	command->pass_compute_new.handle = h;
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Pass{h};
+	return Renoir_Pass{h, h->generation};
+}
+
+static Renoir_Pass
+_renoir_gl450_pass_secondary_new(Renoir* api, Renoir_Pass parent)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_secondary_new", trace_begin);};
+
+	auto self = api->ctx;
+	auto hparent = _renoir_gl450_handle_get(parent);
+	mn_assert(hparent != nullptr);
+	mn_assert_msg(_renoir_gl450_pass_recorder(hparent).parent == nullptr, "secondary passes can't be nested");
+
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
+
+	// secondary passes have no gpu objects of their own, they only record commands which
+	// will be merged into the parent pass so there's no need to issue a creation command
+	auto h = _renoir_gl450_handle_new(self, hparent->kind);
+	_renoir_gl450_handle_ref(hparent);
+	auto& recorder = _renoir_gl450_pass_recorder(h);
+	recorder.allocator = _renoir_gl450_command_allocator_new();
+	recorder.parent = hparent;
+	return Renoir_Pass{h, h->generation};
 }
 
 static void
 _renoir_gl450_pass_free(Renoir* api, Renoir_Pass pass)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_free", trace_begin);};
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_FREE);
 	command->pass_free.handle = h;
@@ -3714,7 +7112,7 @@ static Renoir_Size
 _renoir_gl450_pass_size(Renoir* api, Renoir_Pass pass)
 {
 	Renoir_Size res{};
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
@@ -3736,7 +7134,7 @@ _renoir_gl450_pass_size(Renoir* api, Renoir_Pass pass)
 static Renoir_Pass_Offscreen_Desc
 _renoir_gl450_pass_offscreen_desc(Renoir* api, Renoir_Pass pass)
 {
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 	return h->raster_pass.offscreen;
@@ -3745,28 +7143,34 @@ _renoir_gl450_pass_offscreen_desc(Renoir* api, Renoir_Pass pass)
 static Renoir_Timer
 _renoir_gl450_timer_new(Renoir* api)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "timer_new", trace_begin);};
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_TIMER);
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TIMER_NEW);
 	command->timer_new.handle = h;
 	_renoir_gl450_command_process(self, command);
-	return Renoir_Timer{h};
+	return Renoir_Timer{h, h->generation};
 }
 
 static void
 _renoir_gl450_timer_free(struct Renoir* api, Renoir_Timer timer)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "timer_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)timer.handle;
+	auto h = _renoir_gl450_handle_get(timer);
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TIMER_FREE);
 	command->timer_free.handle = h;
@@ -3777,7 +7181,7 @@ static bool
 _renoir_gl450_timer_elapsed(struct Renoir* api, Renoir_Timer timer, uint64_t* elapsed_time_in_nanos)
 {
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)timer.handle;
+	auto h = _renoir_gl450_handle_get(timer);
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_TIMER);
 
@@ -3789,11 +7193,11 @@ _renoir_gl450_timer_elapsed(struct Renoir* api, Renoir_Timer timer, uint64_t* el
 	}
 	else if (h->timer.state == RENOIR_TIMER_STATE_END)
 	{
-		mn::mutex_lock(self->mtx);
+		_renoir_gl450_mtx_lock(self);
+		mn_defer{_renoir_gl450_mtx_unlock(self);};
+
 		auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TIMER_ELAPSED);
 		h->timer.state = RENOIR_TIMER_STATE_READ_SCHEDULED;
-		mn::mutex_unlock(self->mtx);
-
 		command->timer_elapsed.handle = h;
 		_renoir_gl450_command_process(self, command);
 
@@ -3807,119 +7211,102 @@ _renoir_gl450_timer_elapsed(struct Renoir* api, Renoir_Timer timer, uint64_t* el
 static void
 _renoir_gl450_pass_submit(Renoir* api, Renoir_Pass pass)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_submit", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
-	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+	auto& recorder = _renoir_gl450_pass_recorder(h);
+	mn_assert_msg(recorder.parent == nullptr, "secondary passes are merged into their parent, not submitted");
+
+	auto& commands = recorder.commands;
+	// the pass begin command is pushed with the first recorded command, so empty passes have nothing to submit unless
+	// they have attachments to clear
+	if (commands.head == nullptr)
 	{
-		if (h->raster_pass.command_list_head != nullptr)
-		{
-			mn::mutex_lock(self->mtx);
+		if (_renoir_gl450_pass_load_clears(h) == false)
+			return;
 
-			// push the pass begin command
-			{
-				auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_BEGIN);
-				command->pass_begin.handle = h;
-				_renoir_gl450_command_push_front(&h->raster_pass, command);
-			}
+		auto begin = _renoir_gl450_command_stream_push(recorder.allocator, commands, RENOIR_COMMAND_KIND_PASS_BEGIN, 0);
+		begin->pass_begin.handle = h;
+	}
 
-			// push the pass end command
-			{
-				auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_END);
-				command->pass_end.handle = h;
-				_renoir_gl450_command_push_back(&h->raster_pass, command);
-			}
+	// push the pass end command, this is still recording so it doesn't need the lock
+	auto command = _renoir_gl450_command_stream_push(recorder.allocator, commands, RENOIR_COMMAND_KIND_PASS_END, 0);
+	command->pass_end.handle = h;
 
-			// push the commands to the end of command list, if the user requested to defer api calls
-			if (self->settings.defer_api_calls)
-			{
-				if (self->command_list_tail == nullptr)
-				{
-					self->command_list_head = h->raster_pass.command_list_head;
-					self->command_list_tail = h->raster_pass.command_list_tail;
-				}
-				else
-				{
-					self->command_list_tail->next = h->raster_pass.command_list_head;
-					self->command_list_tail = h->raster_pass.command_list_tail;
-				}
-			}
-			// other than this just process the command
-			else
-			{
-				for(auto it = h->raster_pass.command_list_head; it != nullptr; it = it->next)
-				{
-					_renoir_gl450_command_execute(self, it);
-					_renoir_gl450_command_free(self, it);
-				}
-			}
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
-			mn::mutex_unlock(self->mtx);
-		}
-		h->raster_pass.command_list_head = nullptr;
-		h->raster_pass.command_list_tail = nullptr;
+	if (self->settings.profile_passes)
+	{
+		auto name = _renoir_handle_kind_name(h->kind);
+		auto name_size = ::strlen(name);
+		auto begin = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PROFILE_BEGIN, name_size);
+		begin->profile_begin.name = (char*)_renoir_gl450_command_payload(begin);
+		begin->profile_begin.name_size = name_size;
+		::memcpy(_renoir_gl450_command_payload(begin), name, name_size);
+		_renoir_gl450_command_process(self, begin);
 	}
-	else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
+
+	// push the commands to the end of command stream, if the user requested to defer api calls
+	if (self->settings.defer_api_calls)
 	{
-		if (h->compute_pass.command_list_head != nullptr)
-		{
-			mn::mutex_lock(self->mtx);
+		_renoir_gl450_command_stream_append(self->commands, commands);
+	}
+	// other than this just process the commands
+	else
+	{
+		mn::mutex_lock(self->exec_mtx);
+		_renoir_gl450_command_stream_execute(self, commands);
+		mn::mutex_unlock(self->exec_mtx);
+	}
 
-			// push the pass begin command
-			{
-				auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_BEGIN);
-				command->pass_begin.handle = h;
-				_renoir_gl450_command_push_front(&h->compute_pass, command);
-			}
+	if (self->settings.profile_passes)
+	{
+		auto end = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PROFILE_END);
+		_renoir_gl450_command_process(self, end);
+	}
+}
 
-			// push the pass end command
-			{
-				auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_END);
-				command->pass_end.handle = h;
-				_renoir_gl450_command_push_back(&h->compute_pass, command);
-			}
+static void
+_renoir_gl450_pass_merge(Renoir* api, Renoir_Pass pass, Renoir_Pass secondary)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "pass_merge", trace_begin);};
 
-			// push the commands to the end of command list, if the user requested to defer api calls
-			if (self->settings.defer_api_calls)
-			{
-				if (self->command_list_tail == nullptr)
-				{
-					self->command_list_head = h->compute_pass.command_list_head;
-					self->command_list_tail = h->compute_pass.command_list_tail;
-				}
-				else
-				{
-					self->command_list_tail->next = h->compute_pass.command_list_head;
-					self->command_list_tail = h->compute_pass.command_list_tail;
-				}
-			}
-			// other than this just process the command
-			else
-			{
-				for(auto it = h->compute_pass.command_list_head; it != nullptr; it = it->next)
-				{
-					_renoir_gl450_command_execute(self, it);
-					_renoir_gl450_command_free(self, it);
-				}
-			}
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
 
-			mn::mutex_unlock(self->mtx);
-		}
-		h->compute_pass.command_list_head = nullptr;
-		h->compute_pass.command_list_tail = nullptr;
-	}
-	else
+	auto hsecondary = _renoir_gl450_handle_get(secondary);
+	mn_assert(hsecondary != nullptr);
+
+	auto& secondary_recorder = _renoir_gl450_pass_recorder(hsecondary);
+	mn_assert_msg(secondary_recorder.parent == h, "secondary pass can only be merged into its parent");
+	if (secondary_recorder.commands.head == nullptr)
+		return;
+
+	// make sure the parent stream starts with its pass begin command
+	auto& recorder = _renoir_gl450_pass_recorder(h);
+	if (recorder.commands.head == nullptr)
 	{
-		mn_unreachable_msg("invalid pass");
+		auto command = _renoir_gl450_command_stream_push(recorder.allocator, recorder.commands, RENOIR_COMMAND_KIND_PASS_BEGIN, 0);
+		command->pass_begin.handle = h;
 	}
+
+	// the chunks keep their owner allocator, so they go back to the secondary pass after execution
+	_renoir_gl450_command_stream_append(recorder.commands, secondary_recorder.commands);
 }
 
 static void
 _renoir_gl450_clear(Renoir* api, Renoir_Pass pass, Renoir_Clear_Desc desc)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "clear", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
@@ -3927,81 +7314,75 @@ _renoir_gl450_clear(Renoir* api, Renoir_Pass pass, Renoir_Clear_Desc desc)
 	if (desc.independent_clear_color == RENOIR_SWITCH_DEFAULT)
 		desc.independent_clear_color = RENOIR_SWITCH_DISABLE;
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_PASS_CLEAR);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_PASS_CLEAR);
 
 	command->pass_clear.desc = desc;
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_use_pipeline(Renoir* api, Renoir_Pass pass, Renoir_Pipeline pipeline)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "use_pipeline", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	auto h_pipeline = (Renoir_Handle*)pipeline.handle;
+	auto h_pipeline = _renoir_gl450_handle_get(pipeline);
 	mn_assert(h_pipeline->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_USE_PIPELINE);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_USE_PIPELINE);
 
 	command->use_pipeline.pipeline = h_pipeline;
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_use_compute(Renoir* api, Renoir_Pass pass, Renoir_Compute compute)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "use_compute", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_USE_COMPUTE);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_USE_COMPUTE);
 
-	command->use_compute.compute = (Renoir_Handle*)compute.handle;
-	_renoir_gl450_command_push_back(&h->compute_pass, command);
+	command->use_compute.compute = _renoir_gl450_handle_get(compute);
 }
 
 static void
 _renoir_gl450_scissor(Renoir* api, Renoir_Pass pass, int x, int y, int width, int height)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "scissor", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_SCISSOR);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_SCISSOR);
 
 	command->scissor.x = x;
 	command->scissor.y = y;
 	command->scissor.w = width;
 	command->scissor.h = height;
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_buffer_zero_global(Renoir* api, Renoir_Buffer buffer)
 {
 	auto self = api->ctx;
-	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	auto hbuffer = _renoir_gl450_handle_get(buffer);
 	mn_assert(hbuffer != nullptr);
 
 	mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
 	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_CLEAR);
 	command->buffer_clear.handle = hbuffer;
@@ -4011,37 +7392,24 @@ _renoir_gl450_buffer_zero_global(Renoir* api, Renoir_Buffer buffer)
 static void
 _renoir_gl450_buffer_zero(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_zero", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	if (h == nullptr)
 	{
 		_renoir_gl450_buffer_zero_global(api, buffer);
 	}
 	else
 	{
-		auto hbuffer = (Renoir_Handle*)buffer.handle;
+		auto hbuffer = _renoir_gl450_handle_get(buffer);
 		mn_assert(hbuffer != nullptr);
 
 		mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
 
-		mn::mutex_lock(self->mtx);
-		auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_CLEAR);
-		mn::mutex_unlock(self->mtx);
+		auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BUFFER_CLEAR);
 
 		command->buffer_clear.handle = hbuffer;
-
-		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
-		{
-			_renoir_gl450_command_push_back(&h->raster_pass, command);
-		}
-		else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
-		{
-			_renoir_gl450_command_push_back(&h->compute_pass, command);
-		}
-		else
-		{
-			mn_unreachable_msg("invalid pass");
-		}
 	}
 }
 
@@ -4049,65 +7417,56 @@ static void
 _renoir_gl450_buffer_write_global(Renoir* api, Renoir_Buffer buffer, size_t offset, void* bytes, size_t bytes_size)
 {
 	auto self = api->ctx;
-	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	auto hbuffer = _renoir_gl450_handle_get(buffer);
 	mn_assert(hbuffer != nullptr);
 
 	mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
+	mn_assert_msg(hbuffer->buffer.usage != RENOIR_USAGE_STREAM, "stream buffers are written using buffer_stream_alloc");
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_WRITE);
+	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_WRITE, bytes_size);
 	command->buffer_write.handle = hbuffer;
 	command->buffer_write.offset = offset;
-	command->buffer_write.bytes = mn::alloc(bytes_size, alignof(char)).ptr;
+	command->buffer_write.bytes = _renoir_gl450_command_payload(command);
 	command->buffer_write.bytes_size = bytes_size;
 	::memcpy(command->buffer_write.bytes, bytes, bytes_size);
+	self->upload_bytes_frame.fetch_add(bytes_size);
 	_renoir_gl450_command_process(self, command);
 }
 
 static void
 _renoir_gl450_buffer_write(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, size_t offset, void* bytes, size_t bytes_size)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_write", trace_begin);};
+
 	// this means he's trying to write nothing so no-op
 	if (bytes_size == 0)
 		return;
 
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	if (h == nullptr)
 	{
 		_renoir_gl450_buffer_write_global(api, buffer, offset, bytes, bytes_size);
 	}
 	else
 	{
-		auto hbuffer = (Renoir_Handle*)buffer.handle;
+		auto hbuffer = _renoir_gl450_handle_get(buffer);
 		mn_assert(hbuffer != nullptr);
 
 		mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
+		mn_assert_msg(hbuffer->buffer.usage != RENOIR_USAGE_STREAM, "stream buffers are written using buffer_stream_alloc");
 
-		mn::mutex_lock(self->mtx);
-		auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_WRITE);
-		mn::mutex_unlock(self->mtx);
+		auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BUFFER_WRITE, bytes_size);
 
 		command->buffer_write.handle = hbuffer;
 		command->buffer_write.offset = offset;
-		command->buffer_write.bytes = mn::alloc(bytes_size, alignof(char)).ptr;
+		command->buffer_write.bytes = _renoir_gl450_command_payload(command);
 		command->buffer_write.bytes_size = bytes_size;
 		::memcpy(command->buffer_write.bytes, bytes, bytes_size);
-
-		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
-		{
-			_renoir_gl450_command_push_back(&h->raster_pass, command);
-		}
-		else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
-		{
-			_renoir_gl450_command_push_back(&h->compute_pass, command);
-		}
-		else
-		{
-			mn_unreachable_msg("invalid pass");
-		}
+		api->ctx->upload_bytes_frame.fetch_add(bytes_size);
 	}
 }
 
@@ -4116,77 +7475,63 @@ _renoir_gl450_texture_write_global(Renoir* api, Renoir_Texture texture, Renoir_T
 {
 	auto self = api->ctx;
 
-	auto htexture = (Renoir_Handle*)texture.handle;
+	auto htexture = _renoir_gl450_handle_get(texture);
 	mn_assert(htexture->texture.desc.usage != RENOIR_USAGE_STATIC);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
 
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_WRITE);
+	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_WRITE, desc.bytes_size);
 	command->texture_write.handle = htexture;
 	command->texture_write.desc = desc;
-	command->texture_write.desc.bytes = mn::alloc(desc.bytes_size, alignof(char)).ptr;
+	command->texture_write.desc.bytes = _renoir_gl450_command_payload(command);
 	::memcpy(command->texture_write.desc.bytes, desc.bytes, desc.bytes_size);
+	self->upload_bytes_frame.fetch_add(desc.bytes_size);
 	_renoir_gl450_command_process(self, command);
 }
 
 static void
 _renoir_gl450_texture_write(Renoir* api, Renoir_Pass pass, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_write", trace_begin);};
+
 	// this means he's trying to write nothing so no-op
 	if (desc.bytes_size == 0)
 		return;
 
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	if (h == nullptr)
 	{
-		_renoir_gl450_texture_write_global(api, texture, desc);
-	}
-	else
-	{
-		auto htexture = (Renoir_Handle*)texture.handle;
-		mn_assert(htexture->texture.desc.usage != RENOIR_USAGE_STATIC);
-
-		mn::mutex_lock(self->mtx);
-		auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_WRITE);
-		mn::mutex_unlock(self->mtx);
-
-		command->texture_write.handle = htexture;
-		command->texture_write.desc = desc;
-		command->texture_write.desc.bytes = mn::alloc(desc.bytes_size, alignof(char)).ptr;
-		::memcpy(command->texture_write.desc.bytes, desc.bytes, desc.bytes_size);
-
-		if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
-		{
-			_renoir_gl450_command_push_back(&h->raster_pass, command);
-		}
-		else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
-		{
-			_renoir_gl450_command_push_back(&h->compute_pass, command);
-		}
-		else
-		{
-			mn_unreachable_msg("invalid pass");
-		}
+		_renoir_gl450_texture_write_global(api, texture, desc);
+	}
+	else
+	{
+		auto htexture = _renoir_gl450_handle_get(texture);
+		mn_assert(htexture->texture.desc.usage != RENOIR_USAGE_STATIC);
+
+		auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_TEXTURE_WRITE, desc.bytes_size);
+
+		command->texture_write.handle = htexture;
+		command->texture_write.desc = desc;
+		command->texture_write.desc.bytes = _renoir_gl450_command_payload(command);
+		::memcpy(command->texture_write.desc.bytes, desc.bytes, desc.bytes_size);
+		api->ctx->upload_bytes_frame.fetch_add(desc.bytes_size);
 	}
 }
 
 static void
 _renoir_gl450_buffer_read(Renoir* api, Renoir_Buffer buffer, size_t offset, void* bytes, size_t bytes_size)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_read", trace_begin);};
+
 	// this means he's trying to read nothing so no-op
 	if (bytes_size == 0)
 		return;
 
-	auto h = (Renoir_Handle*)buffer.handle;
+	auto h = _renoir_gl450_handle_get(buffer);
 	mn_assert(h != nullptr);
-	// this means that buffer creation didn't execute yet
-	if (h->buffer.id == 0)
-	{
-		::memset(bytes, 0, bytes_size);
-		return;
-	}
 
 	auto self = api->ctx;
 
@@ -4197,26 +7542,23 @@ _renoir_gl450_buffer_read(Renoir* api, Renoir_Buffer buffer, size_t offset, void
 	command.buffer_read.bytes = bytes;
 	command.buffer_read.bytes_size = bytes_size;
 
-	mn::mutex_lock(self->mtx);
-	_renoir_gl450_command_execute(self, &command);
-	mn::mutex_unlock(self->mtx);
+	_renoir_gl450_mtx_lock(self);
+	_renoir_gl450_sync_run(self, _renoir_gl450_read_job, &command);
+	_renoir_gl450_mtx_unlock(self);
 }
 
 static void
 _renoir_gl450_texture_read(Renoir* api, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_read", trace_begin);};
+
 	// this means he's trying to read nothing so no-op
 	if (desc.bytes_size == 0)
 		return;
 
-	auto h = (Renoir_Handle*)texture.handle;
+	auto h = _renoir_gl450_handle_get(texture);
 	mn_assert(h != nullptr);
-	// this means that texture creation didn't execute yet
-	if (h->texture.id == 0)
-	{
-		::memset(desc.bytes, 0, desc.bytes_size);
-		return;
-	}
 
 	auto self = api->ctx;
 
@@ -4225,54 +7567,201 @@ _renoir_gl450_texture_read(Renoir* api, Renoir_Texture texture, Renoir_Texture_E
 	command.texture_read.handle = h;
 	command.texture_read.desc = desc;
 
-	mn::mutex_lock(self->mtx);
-	_renoir_gl450_command_execute(self, &command);
-	mn::mutex_unlock(self->mtx);
+	_renoir_gl450_mtx_lock(self);
+	_renoir_gl450_sync_run(self, _renoir_gl450_read_job, &command);
+	_renoir_gl450_mtx_unlock(self);
+}
+
+static Renoir_Readback
+_renoir_gl450_buffer_read_async(Renoir* api, Renoir_Buffer buffer, size_t offset, size_t bytes_size)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_read_async", trace_begin);};
+
+	auto self = api->ctx;
+	auto hbuffer = _renoir_gl450_handle_get(buffer);
+	mn_assert(hbuffer != nullptr && hbuffer->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert_msg(offset + bytes_size <= hbuffer->buffer.size, "read is out of the buffer bounds");
+
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
+
+	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_READBACK);
+	h->readback.size = bytes_size;
+
+	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_READBACK_BUFFER);
+	command->readback_buffer.handle = h;
+	command->readback_buffer.buffer = hbuffer;
+	command->readback_buffer.offset = offset;
+	_renoir_gl450_command_process(self, command);
+	return Renoir_Readback{h, h->generation};
+}
+
+static Renoir_Readback
+_renoir_gl450_texture_read_async(Renoir* api, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_read_async", trace_begin);};
+
+	auto self = api->ctx;
+	auto htexture = _renoir_gl450_handle_get(texture);
+	mn_assert(htexture != nullptr && htexture->kind == RENOIR_HANDLE_KIND_TEXTURE);
+
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
+
+	auto h = _renoir_gl450_handle_new(self, RENOIR_HANDLE_KIND_READBACK);
+	h->readback.size = desc.bytes_size;
+
+	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_READBACK_TEXTURE);
+	command->readback_texture.handle = h;
+	command->readback_texture.texture = htexture;
+	command->readback_texture.desc = desc;
+	_renoir_gl450_command_process(self, command);
+	return Renoir_Readback{h, h->generation};
+}
+
+static bool
+_renoir_gl450_readback_poll(Renoir* api, Renoir_Readback readback, void* bytes, size_t bytes_size)
+{
+	auto self = api->ctx;
+	auto h = _renoir_gl450_handle_get(readback);
+	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_READBACK);
+	mn_assert_msg(bytes_size <= h->readback.size, "readback is smaller than the requested size");
+
+	if (h->readback.ready == false)
+	{
+		// the render thread resolves the readbacks at the end of every frame
+		if (self->settings.render_thread)
+			return false;
+
+		mn::mutex_lock(self->exec_mtx);
+		auto ready = _renoir_gl450_readback_resolve(self, h, false);
+		mn::mutex_unlock(self->exec_mtx);
+		if (ready == false)
+			return false;
+	}
+
+	::memcpy(bytes, h->readback.data, bytes_size);
+	return true;
 }
 
 static void
-_renoir_gl450_buffer_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER shader, int slot)
+_renoir_gl450_readback_wait(Renoir* api, Renoir_Readback readback, void* bytes, size_t bytes_size)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "readback_wait", trace_begin);};
+
+	auto self = api->ctx;
+	auto h = _renoir_gl450_handle_get(readback);
+	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_READBACK);
+	mn_assert_msg(bytes_size <= h->readback.size, "readback is smaller than the requested size");
+
+	if (h->readback.ready == false)
+	{
+		_renoir_gl450_mtx_lock(self);
+		_renoir_gl450_sync_run(self, _renoir_gl450_readback_wait_job, h);
+		_renoir_gl450_mtx_unlock(self);
+	}
+
+	// in deferred mode the readback command stays in the global stream until the next flush/present, waiting for it
+	// before that would block forever so it's a usage error
+	mn_assert_msg(h->readback.ready, "readback command didn't execute yet, call flush/present before readback_wait");
+	if (h->readback.ready == false)
+		return;
+
+	::memcpy(bytes, h->readback.data, bytes_size);
+}
+
+static void
+_renoir_gl450_readback_free(Renoir* api, Renoir_Readback readback)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "readback_free", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(readback);
+	mn_assert(h != nullptr);
+
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
+
+	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_READBACK_FREE);
+	command->readback_free.handle = h;
+	_renoir_gl450_command_process(self, command);
+}
+
+static void
+_renoir_gl450_buffer_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER shader, int slot)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_bind", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_BIND);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BUFFER_BIND);
 
-	command->buffer_bind.handle = (Renoir_Handle*)buffer.handle;
+	command->buffer_bind.handle = _renoir_gl450_handle_get(buffer);
 	command->buffer_bind.shader = shader;
 	command->buffer_bind.slot = slot;
+}
+
+static void
+_renoir_gl450_buffer_bind_range(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER shader, int slot, size_t offset, size_t size)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_bind_range", trace_begin);};
+
+	auto self = api->ctx;
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	auto hbuffer = _renoir_gl450_handle_get(buffer);
+	mn_assert(hbuffer != nullptr);
+	mn_assert_msg(size > 0, "buffer bind range should not be empty");
+	mn_assert_msg(offset + size <= hbuffer->buffer.size, "buffer bind range is out of the buffer bounds");
+	// indirect buffers are bound as storage buffers
+	_renoir_gl450_buffer_range_check(self, hbuffer->buffer.type == RENOIR_BUFFER_UNIFORM ? GL_UNIFORM_BUFFER : GL_SHADER_STORAGE_BUFFER, offset);
 
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BUFFER_BIND);
+
+	command->buffer_bind.handle = hbuffer;
+	command->buffer_bind.shader = shader;
+	command->buffer_bind.slot = slot;
+	command->buffer_bind.offset = offset;
+	command->buffer_bind.size = size;
 }
 
 static void
 _renoir_gl450_buffer_storage_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer_Storage_Bind_Desc desc)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_storage_bind", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BUFFER_STORAGE_BIND);
 
+	// secondary passes render into their parent's targets
+	auto primary = _renoir_gl450_pass_primary(h);
 	size_t render_target_count = 0;
-	if (h->raster_pass.swapchain)
+	if (primary->raster_pass.swapchain)
 	{
 		render_target_count = 1;
 	}
-	else if (h->raster_pass.fb)
+	else if (primary->raster_pass.fb)
 	{
 		for (size_t i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
 		{
-			auto texture = h->raster_pass.offscreen.color[i].texture;
+			auto texture = primary->raster_pass.offscreen.color[i].texture;
 			if (texture.handle == nullptr)
 				continue;
 			++render_target_count;
@@ -4287,66 +7776,78 @@ _renoir_gl450_buffer_storage_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer_S
 
 	for (int i = 0; i < RENOIR_CONSTANT_BUFFER_STORAGE_SIZE; ++i)
 	{
-		auto h = (Renoir_Handle*)desc.buffers[i].handle;
-		if (h)
-			command->buffer_storage_bind.handle[i] = h;
+		auto h = _renoir_gl450_handle_get(desc.buffers[i]);
+		if (h == nullptr)
+			continue;
+
+		mn_assert_msg(desc.offsets[i] + desc.sizes[i] <= h->buffer.size, "buffer bind range is out of the buffer bounds");
+		_renoir_gl450_buffer_range_check(api->ctx, GL_SHADER_STORAGE_BUFFER, desc.offsets[i]);
+		command->buffer_storage_bind.handle[i] = h;
+		command->buffer_storage_bind.offsets[i] = desc.offsets[i];
+		command->buffer_storage_bind.sizes[i] = desc.sizes[i];
 	}
 	command->buffer_storage_bind.start_slot = desc.start_slot;
-
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_texture_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture texture, RENOIR_SHADER shader, int slot)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_bind", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
-	auto htex = (Renoir_Handle*)texture.handle;
+	auto htex = _renoir_gl450_handle_get(texture);
 	mn_assert(htex != nullptr);
 
-	mn::mutex_lock(self->mtx);
+	// the sampler cache is shared between all the passes
+	_renoir_gl450_mtx_lock(self);
 	auto sampler = _renoir_gl450_sampler_get(self, htex->texture.desc.sampler);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_gl450_mtx_unlock(self);
+
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_TEXTURE_BIND);
 
 	command->texture_bind.handle = htex;
 	command->texture_bind.shader = shader;
 	command->texture_bind.slot = slot;
 	command->texture_bind.sampler = sampler;
-
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_texture_sampler_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture texture, RENOIR_SHADER shader, int slot, Renoir_Sampler_Desc sampler)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_sampler_bind", trace_begin);};
+
 	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
-	auto htex = (Renoir_Handle*)texture.handle;
+	auto htex = _renoir_gl450_handle_get(texture);
 	mn_assert(htex != nullptr);
 
-	mn::mutex_lock(self->mtx);
+	// the sampler cache is shared between all the passes
+	_renoir_gl450_mtx_lock(self);
 	auto hsampler = _renoir_gl450_sampler_get(self, sampler);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_BIND);
-	mn::mutex_unlock(self->mtx);
+	_renoir_gl450_mtx_unlock(self);
+
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_TEXTURE_BIND);
 
 	command->texture_bind.handle = htex;
 	command->texture_bind.shader = shader;
 	command->texture_bind.slot = slot;
 	command->texture_bind.sampler = hsampler;
-
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_buffer_compute_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, int slot, RENOIR_ACCESS gpu_access)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "buffer_compute_bind", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
@@ -4355,23 +7856,21 @@ _renoir_gl450_buffer_compute_bind(Renoir* api, Renoir_Pass pass, Renoir_Buffer b
 		"gpu should read, write, or both, it has no meaning to bind a buffer that the GPU cannot read or write from"
 	);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_BUFFER_BIND);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BUFFER_BIND);
 
-	command->buffer_bind.handle = (Renoir_Handle*)buffer.handle;
+	command->buffer_bind.handle = _renoir_gl450_handle_get(buffer);
 	command->buffer_bind.shader = RENOIR_SHADER_COMPUTE;
 	command->buffer_bind.slot = slot;
 	command->buffer_bind.gpu_access = gpu_access;
-
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
 }
 
 static void
 _renoir_gl450_texture_compute_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture texture, int slot, int mip_level, RENOIR_ACCESS gpu_access)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "texture_compute_bind", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
@@ -4385,126 +7884,391 @@ _renoir_gl450_texture_compute_bind(Renoir* api, Renoir_Pass pass, Renoir_Texture
 		mn_assert_msg(mip_level == 0, "read only textures are bound as samplers, so you can't change mip level");
 	}
 
-	auto htex = (Renoir_Handle*)texture.handle;
+	auto htex = _renoir_gl450_handle_get(texture);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_BIND);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_TEXTURE_BIND);
 
 	command->texture_bind.handle = htex;
 	command->texture_bind.shader = RENOIR_SHADER_COMPUTE;
 	command->texture_bind.slot = slot;
 	command->texture_bind.level = mip_level;
 	command->texture_bind.gpu_access = gpu_access;
-
-	_renoir_gl450_command_push_back(&h->compute_pass, command);
 }
 
 static void
 _renoir_gl450_draw(Renoir* api, Renoir_Pass pass, Renoir_Draw_Desc desc)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "draw", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_DRAW);
-	mn::mutex_unlock(self->mtx);
+	auto vertex_buffers_count = _renoir_gl450_vertex_buffers_count(desc.vertex_buffers);
+	auto vertex_buffers_size = vertex_buffers_count * sizeof(Renoir_Vertex_Desc);
+
+	_renoir_gl450_handle_get(desc.index_buffer);
+	if (desc.index_buffer.handle != nullptr && desc.index_type == RENOIR_TYPE_NONE)
+		desc.index_type = RENOIR_TYPE_UINT16;
+
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_DRAW, vertex_buffers_size);
+
+	command->draw.primitive = desc.primitive;
+	command->draw.base_element = desc.base_element;
+	command->draw.elements_count = desc.elements_count;
+	command->draw.instances_count = desc.instances_count;
+	command->draw.index_buffer = desc.index_buffer;
+	command->draw.index_type = desc.index_type;
+	command->draw.vertex_buffers_count = vertex_buffers_count;
+	command->draw.layout = _renoir_gl450_vertex_buffers_copy(command->draw.vertex_buffers, desc.vertex_buffers, vertex_buffers_count);
+}
+
+static void
+_renoir_gl450_draw_indirect_record(Renoir_Pass pass, const Renoir_Draw_Indirect_Desc& desc, Renoir_Handle* count_buffer)
+{
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	auto indirect_buffer = _renoir_gl450_handle_get(desc.indirect_buffer);
+	mn_assert(indirect_buffer != nullptr && indirect_buffer->buffer.type == RENOIR_BUFFER_INDIRECT);
+	mn_assert_msg(desc.indirect_offset % 4 == 0, "indirect offset should be a multiple of 4");
+	mn_assert(desc.draw_count >= 0);
+
+	auto vertex_buffers_count = _renoir_gl450_vertex_buffers_count(desc.vertex_buffers);
+	auto vertex_buffers_size = vertex_buffers_count * sizeof(Renoir_Vertex_Desc);
+
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_DRAW_INDIRECT, vertex_buffers_size);
+	command->draw_indirect.primitive = desc.primitive;
+	command->draw_indirect.index_buffer = desc.index_buffer;
+	command->draw_indirect.index_type = desc.index_type;
+	_renoir_gl450_handle_get(desc.index_buffer);
+	if (desc.index_buffer.handle != nullptr && desc.index_type == RENOIR_TYPE_NONE)
+		command->draw_indirect.index_type = RENOIR_TYPE_UINT16;
+	command->draw_indirect.indirect_buffer = indirect_buffer;
+	command->draw_indirect.indirect_offset = desc.indirect_offset;
+	command->draw_indirect.indirect_stride = desc.indirect_stride;
+	command->draw_indirect.draw_count = desc.draw_count;
+	command->draw_indirect.count_buffer = count_buffer;
+	command->draw_indirect.count_offset = desc.count_offset;
+	command->draw_indirect.vertex_buffers_count = vertex_buffers_count;
+	command->draw_indirect.layout = _renoir_gl450_vertex_buffers_copy(command->draw_indirect.vertex_buffers, desc.vertex_buffers, vertex_buffers_count);
+}
+
+static void
+_renoir_gl450_draw_indirect(Renoir* api, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "draw_indirect", trace_begin);};
 
-	command->draw.desc = desc;
+	_renoir_gl450_draw_indirect_record(pass, desc, nullptr);
+}
+
+static void
+_renoir_gl450_draw_indirect_count(Renoir* api, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "draw_indirect_count", trace_begin);};
+
+	auto self = api->ctx;
+	mn_assert_msg(
+		self->draw_indirect_count_queried.load() == false || self->draw_indirect_count_supported.load(),
+		"draw_indirect_count needs ARB_indirect_parameters which is not supported, check info().draw_indirect_count_supported"
+	);
 
-	_renoir_gl450_command_push_back(&h->raster_pass, command);
+	auto count_buffer = _renoir_gl450_handle_get(desc.count_buffer);
+	mn_assert(count_buffer != nullptr && count_buffer->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert_msg(desc.count_offset % 4 == 0, "count offset should be a multiple of 4");
+	_renoir_gl450_draw_indirect_record(pass, desc, count_buffer);
 }
 
 static void
 _renoir_gl450_dispatch(Renoir* api, Renoir_Pass pass, int x, int y, int z)
 {
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "dispatch", trace_begin);};
+
 	mn_assert(x >= 0 && y >= 0 && z >= 0);
 
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_DISPATCH);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_DISPATCH);
 
 	command->dispatch.x = x;
 	command->dispatch.y = y;
 	command->dispatch.z = z;
+}
+
+static void
+_renoir_gl450_dispatch_indirect(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, size_t offset)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "dispatch_indirect", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+
+	auto hbuffer = _renoir_gl450_handle_get(buffer);
+	mn_assert(hbuffer != nullptr && hbuffer->buffer.type == RENOIR_BUFFER_INDIRECT);
+	mn_assert_msg(offset % 4 == 0, "indirect offset should be a multiple of 4");
+	mn_assert_msg(offset + sizeof(Renoir_Dispatch_Indirect_Command) <= hbuffer->buffer.size, "indirect offset out of range");
+
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_DISPATCH_INDIRECT);
+	command->dispatch_indirect.buffer = hbuffer;
+	command->dispatch_indirect.offset = offset;
+}
+
+static void
+_renoir_gl450_barrier(Renoir* api, Renoir_Pass pass, int barriers)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "barrier", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
 
-	_renoir_gl450_command_push_back(&h->compute_pass, command);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS ||
+			  h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+	mn_assert_msg((barriers & ~RENOIR_BARRIER_ALL) == 0, "invalid barrier flags");
+
+	if (barriers == RENOIR_BARRIER_NONE)
+		return;
+
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_BARRIER);
+	command->barrier.barriers = barriers;
 }
 
 static void
 _renoir_gl450_timer_begin(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "timer_begin", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
-	auto htimer = (Renoir_Handle*)timer.handle;
+	auto htimer = _renoir_gl450_handle_get(timer);
 	mn_assert(htimer != nullptr && htimer->kind == RENOIR_HANDLE_KIND_TIMER);
 
 	if(htimer->timer.state != RENOIR_TIMER_STATE_NONE)
 		return;
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TIMER_BEGIN);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_TIMER_BEGIN);
 
 	command->timer_begin.handle = htimer;
 	htimer->timer.state = RENOIR_TIMER_STATE_BEGIN;
-
-	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
-	{
-		_renoir_gl450_command_push_back(&h->raster_pass, command);
-	}
-	else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
-	{
-		_renoir_gl450_command_push_back(&h->compute_pass, command);
-	}
-	else
-	{
-		mn_unreachable();
-	}
 }
 
 static void
 _renoir_gl450_timer_end(struct Renoir* api, Renoir_Pass pass, Renoir_Timer timer)
 {
-	auto self = api->ctx;
-	auto h = (Renoir_Handle*)pass.handle;
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "timer_end", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
 	mn_assert(h != nullptr);
 
-	auto htimer = (Renoir_Handle*)timer.handle;
+	auto htimer = _renoir_gl450_handle_get(timer);
 	mn_assert(htimer != nullptr && htimer->kind == RENOIR_HANDLE_KIND_TIMER);
 	if (htimer->timer.state != RENOIR_TIMER_STATE_BEGIN)
 		return;
 
-	mn::mutex_lock(self->mtx);
-	auto command = _renoir_gl450_command_new(self, RENOIR_COMMAND_KIND_TIMER_END);
-	mn::mutex_unlock(self->mtx);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_TIMER_END);
 
 	command->timer_end.handle = htimer;
 	htimer->timer.state = RENOIR_TIMER_STATE_END;
+}
 
-	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+static void
+_renoir_gl450_profile_begin(struct Renoir* api, Renoir_Pass pass, const char* name)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "profile_begin", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
+	mn_assert(name != nullptr);
+
+	auto name_size = ::strlen(name);
+	auto command = _renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_PROFILE_BEGIN, name_size);
+	command->profile_begin.name = (char*)_renoir_gl450_command_payload(command);
+	command->profile_begin.name_size = name_size;
+	::memcpy(_renoir_gl450_command_payload(command), name, name_size);
+}
+
+static void
+_renoir_gl450_profile_end(struct Renoir* api, Renoir_Pass pass)
+{
+	auto trace_begin = _renoir_gl450_trace_begin(api->ctx);
+	mn_defer{_renoir_gl450_trace_end(api->ctx, "profile_end", trace_begin);};
+
+	auto h = _renoir_gl450_handle_get(pass);
+	mn_assert(h != nullptr);
+
+	_renoir_gl450_pass_command_new(h, RENOIR_COMMAND_KIND_PROFILE_END);
+}
+
+static bool
+_renoir_gl450_profile_results(struct Renoir* api, Renoir_Profile_Results* results)
+{
+	auto self = api->ctx;
+	mn_assert(results != nullptr);
+
+	_renoir_gl450_mtx_lock(self);
+	mn_defer{_renoir_gl450_mtx_unlock(self);};
+
+	// the executor may resolve newer results at any time, so the results are copied out under the stats lock
+	mn::mutex_lock(self->stats_mtx);
+	mn_defer{mn::mutex_unlock(self->stats_mtx);};
+
+	if (self->profile_results_ready == false)
+		return false;
+
+	mn::buf_resize(self->profile_results_user_names, self->profile_results_names.count);
+	if (self->profile_results_names.count > 0)
+		::memcpy(self->profile_results_user_names.ptr, self->profile_results_names.ptr, self->profile_results_names.count);
+
+	mn::buf_clear(self->profile_results_user);
+	for (auto scope: self->profile_results)
 	{
-		_renoir_gl450_command_push_back(&h->raster_pass, command);
+		scope.name = self->profile_results_user_names.ptr + (scope.name - self->profile_results_names.ptr);
+		mn::buf_push(self->profile_results_user, scope);
 	}
-	else if (h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS)
+
+	results->frame = self->profile_results_frame;
+	results->scopes = self->profile_results_user.ptr;
+	results->scopes_count = self->profile_results_user.count;
+	return true;
+}
+
+static void
+_renoir_gl450_trace_enable(Renoir* api, bool enabled)
+{
+	auto self = api->ctx;
+	self->trace_enabled.store(enabled);
+}
+
+// copies the events of the ring which weren't overwritten while they were being copied
+static void
+_renoir_gl450_trace_ring_copy(Renoir_GL450_Trace_Ring* ring, mn::Buf<Renoir_GL450_Trace_Event>& events)
+{
+	mn::buf_clear(events);
+
+	auto head = ring->head.load(std::memory_order_acquire);
+	auto begin = head > RENOIR_CONSTANT_TRACE_RING_SIZE ? head - RENOIR_CONSTANT_TRACE_RING_SIZE : 0;
+	for (auto i = begin; i < head; ++i)
+		mn::buf_push(events, ring->events[i % RENOIR_CONSTANT_TRACE_RING_SIZE]);
+
+	// the thread may be writing the slot of the event after the published head
+	auto head_after = ring->head.load(std::memory_order_acquire);
+	auto valid_begin = head_after >= RENOIR_CONSTANT_TRACE_RING_SIZE ? head_after - RENOIR_CONSTANT_TRACE_RING_SIZE + 1 : 0;
+	if (valid_begin > begin)
 	{
-		_renoir_gl450_command_push_back(&h->compute_pass, command);
+		auto dropped = valid_begin - begin;
+		if (dropped > events.count)
+			dropped = events.count;
+		::memmove(events.ptr, events.ptr + dropped, (events.count - dropped) * sizeof(*events.ptr));
+		mn::buf_resize(events, events.count - dropped);
 	}
-	else
+}
+
+// writes str as a quoted json string, the names come from the user so they may contain quotes or control characters
+static void
+_renoir_gl450_trace_write_string(FILE* file, const char* str)
+{
+	::fputc('"', file);
+	for (auto it = str; *it; ++it)
 	{
-		mn_unreachable();
+		auto c = (unsigned char)*it;
+		switch (c)
+		{
+		case '"': ::fputs("\\\"", file); break;
+		case '\\': ::fputs("\\\\", file); break;
+		case '\b': ::fputs("\\b", file); break;
+		case '\f': ::fputs("\\f", file); break;
+		case '\n': ::fputs("\\n", file); break;
+		case '\r': ::fputs("\\r", file); break;
+		case '\t': ::fputs("\\t", file); break;
+		default:
+			if (c < 0x20)
+				::fprintf(file, "\\u%04x", c);
+			else
+				::fputc(c, file);
+			break;
+		}
+	}
+	::fputc('"', file);
+}
+
+static bool
+_renoir_gl450_trace_write(Renoir* api, const char* path)
+{
+	auto self = api->ctx;
+
+	auto file = fopen(path, "wb");
+	if (file == nullptr)
+	{
+		mn::log_error("gl450: failed to write the trace file '{}'", path);
+		return false;
 	}
+	mn_defer{fclose(file);};
+
+	auto events = mn::buf_new<Renoir_GL450_Trace_Event>();
+	mn_defer{mn::buf_free(events);};
+
+	bool first = true;
+	auto write_ring = [&](Renoir_GL450_Trace_Ring* ring) {
+		char default_name[32];
+		auto name = ring->name;
+		if (name == nullptr)
+		{
+			::snprintf(default_name, sizeof(default_name), "thread %u", ring->tid);
+			name = default_name;
+		}
+		::fprintf(
+			file,
+			"%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+			first ? "" : ",",
+			ring->tid
+		);
+		_renoir_gl450_trace_write_string(file, name);
+		::fprintf(file, "}}");
+		first = false;
+
+		// trace-event timestamps are in microseconds
+		_renoir_gl450_trace_ring_copy(ring, events);
+		for (const auto& event: events)
+		{
+			::fprintf(file, ",\n{\"name\":");
+			_renoir_gl450_trace_write_string(file, event.name);
+			::fprintf(
+				file,
+				",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				ring->tid,
+				event.begin / 1000.0,
+				(event.end - event.begin) / 1000.0
+			);
+		}
+	};
+
+	::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	mn::mutex_lock(self->trace_mtx);
+	if (self->trace_gpu_ring)
+		write_ring(self->trace_gpu_ring);
+	for (auto ring: self->trace_rings)
+		write_ring(ring);
+	mn::mutex_unlock(self->trace_mtx);
+
+	::fprintf(file, "\n]}\n");
+	return ferror(file) == 0;
 }
 
 inline static void
@@ -4518,6 +8282,9 @@ _renoir_load_api(Renoir* api)
 	api->name = _renoir_gl450_name;
 	api->texture_origin = _renoir_gl450_texture_origin;
 	api->info = _renoir_gl450_info;
+	api->resource_stats = _renoir_gl450_resource_stats;
+	api->frame_stats = _renoir_gl450_frame_stats;
+	api->frame_stats_command_name = _renoir_gl450_frame_stats_command_name;
 
 	api->handle_ref = _renoir_gl450_handle_ref;
 	api->flush = _renoir_gl450_flush;
@@ -4530,6 +8297,7 @@ _renoir_load_api(Renoir* api)
 	api->buffer_new = _renoir_gl450_buffer_new;
 	api->buffer_free = _renoir_gl450_buffer_free;
 	api->buffer_size = _renoir_gl450_buffer_size;
+	api->buffer_stream_alloc = _renoir_gl450_buffer_stream_alloc;
 
 	api->texture_new = _renoir_gl450_texture_new;
 	api->texture_free = _renoir_gl450_texture_free;
@@ -4539,9 +8307,11 @@ _renoir_load_api(Renoir* api)
 
 	api->program_new = _renoir_gl450_program_new;
 	api->program_free = _renoir_gl450_program_free;
+	api->program_ready = _renoir_gl450_program_ready;
 
 	api->compute_new = _renoir_gl450_compute_new;
 	api->compute_free = _renoir_gl450_compute_free;
+	api->compute_ready = _renoir_gl450_compute_ready;
 
 	api->pipeline_new = _renoir_gl450_pipeline_new;
 	api->pipeline_free = _renoir_gl450_pipeline_free;
@@ -4549,6 +8319,7 @@ _renoir_load_api(Renoir* api)
 	api->pass_swapchain_new = _renoir_gl450_pass_swapchain_new;
 	api->pass_offscreen_new = _renoir_gl450_pass_offscreen_new;
 	api->pass_compute_new = _renoir_gl450_pass_compute_new;
+	api->pass_secondary_new = _renoir_gl450_pass_secondary_new;
 	api->pass_free = _renoir_gl450_pass_free;
 	api->pass_size = _renoir_gl450_pass_size;
 	api->pass_offscreen_desc = _renoir_gl450_pass_offscreen_desc;
@@ -4558,6 +8329,7 @@ _renoir_load_api(Renoir* api)
 	api->timer_elapsed = _renoir_gl450_timer_elapsed;
 
 	api->pass_submit = _renoir_gl450_pass_submit;
+	api->pass_merge = _renoir_gl450_pass_merge;
 	api->clear = _renoir_gl450_clear;
 	api->use_pipeline = _renoir_gl450_use_pipeline;
 	api->use_compute = _renoir_gl450_use_compute;
@@ -4567,16 +8339,31 @@ _renoir_load_api(Renoir* api)
 	api->texture_write = _renoir_gl450_texture_write;
 	api->buffer_read = _renoir_gl450_buffer_read;
 	api->texture_read = _renoir_gl450_texture_read;
+	api->buffer_read_async = _renoir_gl450_buffer_read_async;
+	api->texture_read_async = _renoir_gl450_texture_read_async;
+	api->readback_poll = _renoir_gl450_readback_poll;
+	api->readback_wait = _renoir_gl450_readback_wait;
+	api->readback_free = _renoir_gl450_readback_free;
 	api->buffer_bind = _renoir_gl450_buffer_bind;
+	api->buffer_bind_range = _renoir_gl450_buffer_bind_range;
 	api->buffer_storage_bind = _renoir_gl450_buffer_storage_bind;
 	api->texture_bind = _renoir_gl450_texture_bind;
 	api->texture_sampler_bind = _renoir_gl450_texture_sampler_bind;
 	api->buffer_compute_bind = _renoir_gl450_buffer_compute_bind;
 	api->texture_compute_bind = _renoir_gl450_texture_compute_bind;
 	api->draw = _renoir_gl450_draw;
+	api->draw_indirect = _renoir_gl450_draw_indirect;
+	api->draw_indirect_count = _renoir_gl450_draw_indirect_count;
 	api->dispatch = _renoir_gl450_dispatch;
+	api->dispatch_indirect = _renoir_gl450_dispatch_indirect;
+	api->barrier = _renoir_gl450_barrier;
 	api->timer_begin = _renoir_gl450_timer_begin;
 	api->timer_end = _renoir_gl450_timer_end;
+	api->profile_begin = _renoir_gl450_profile_begin;
+	api->profile_end = _renoir_gl450_profile_end;
+	api->profile_results = _renoir_gl450_profile_results;
+	api->trace_enable = _renoir_gl450_trace_enable;
+	api->trace_write = _renoir_gl450_trace_write;
 }
 
 extern "C" Renoir*
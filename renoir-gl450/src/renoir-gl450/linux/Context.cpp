@@ -18,6 +18,9 @@ struct Renoir_GL450_Context
 	bool owns_display;
 	::GLXContext context;
 	::Window dummy_window;
+	// worker contexts render nothing so they're bound to a pbuffer instead of a window
+	::GLXPbuffer pbuffer;
+	::GLXFBConfig fbconfig;
 };
 
 inline static int
@@ -186,6 +189,7 @@ renoir_gl450_context_new(Renoir_Settings* settings, void* given_display)
 	self->display = display;
 	self->owns_display = given_display == nullptr;
 	self->dummy_window = dummy_window;
+	self->fbconfig = bestFbc;
 
 	context = nullptr;
 	display = nullptr;
@@ -200,6 +204,8 @@ renoir_gl450_context_free(Renoir_GL450_Context* self)
 
 	if(self->dummy_window)
 		XDestroyWindow(self->display, self->dummy_window);
+	if (self->pbuffer)
+		glXDestroyPbuffer(self->display, self->pbuffer);
 	if (self->context)
 		glXDestroyContext(self->display, self->context);
 	if (self->display && self->owns_display)
@@ -207,6 +213,77 @@ renoir_gl450_context_free(Renoir_GL450_Context* self)
 	mn::free(self);
 }
 
+Renoir_GL450_Context*
+renoir_gl450_context_worker_new(Renoir_GL450_Context* self)
+{
+	if (self == nullptr) return nullptr;
+
+	auto glXCreateContextAttribsARB = (glXCreateContextAttribsARBProc)glXGetProcAddressARB((const GLubyte*)"glXCreateContextAttribsARB");
+	if (glXCreateContextAttribsARB == nullptr)
+		return nullptr;
+
+	const int major = 4, minor = 5;
+	int context_attribs[] = {
+		GLX_CONTEXT_MAJOR_VERSION_ARB, major,
+		GLX_CONTEXT_MINOR_VERSION_ARB, minor,
+		GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+		None
+	};
+
+	// the worker gets its own display connection since it's used from the compile thread while the render thread uses
+	// the main one, and Xlib connections aren't thread safe unless XInitThreads is called before any other Xlib call
+	// which we can't guarantee when the display is given by the user
+	auto display = XOpenDisplay(DisplayString(self->display));
+	if (display == nullptr)
+		return nullptr;
+	mn_defer(if (display) XCloseDisplay(display));
+
+	const int pbuffer_visual_attribs[] = {
+		GLX_DRAWABLE_TYPE       , GLX_PBUFFER_BIT,
+		GLX_RENDER_TYPE         , GLX_RGBA_BIT,
+		GLX_RED_SIZE            , 8,
+		GLX_GREEN_SIZE          , 8,
+		GLX_BLUE_SIZE           , 8,
+		GLX_ALPHA_SIZE          , 8,
+		None
+	};
+
+	int fbcount = 0;
+	auto fbc = glXChooseFBConfig(display, DefaultScreen(display), pbuffer_visual_attribs, &fbcount);
+	if (fbc == nullptr)
+		return nullptr;
+	mn_defer(XFree(fbc));
+	if (fbcount == 0)
+		return nullptr;
+	auto fbconfig = fbc[0];
+
+	const int pbuffer_attribs[] = {
+		GLX_PBUFFER_WIDTH, 1,
+		GLX_PBUFFER_HEIGHT, 1,
+		None
+	};
+	auto pbuffer = glXCreatePbuffer(display, fbconfig, pbuffer_attribs);
+	if (pbuffer == None)
+		return nullptr;
+	mn_defer(if (pbuffer) glXDestroyPbuffer(display, pbuffer));
+
+	auto context = glXCreateContextAttribsARB(display, fbconfig, self->context, True, context_attribs);
+	if (context == nullptr)
+		return nullptr;
+
+	auto worker = mn::alloc_zerod<Renoir_GL450_Context>();
+	worker->context = context;
+	worker->display = display;
+	worker->owns_display = true;
+	worker->dummy_window = None;
+	worker->pbuffer = pbuffer;
+	worker->fbconfig = fbconfig;
+
+	display = nullptr;
+	pbuffer = None;
+	return worker;
+}
+
 void
 renoir_gl450_context_window_init(Renoir_GL450_Context* self, Renoir_Handle* h, Renoir_Settings* settings)
 {
@@ -254,7 +331,8 @@ renoir_gl450_context_bind(Renoir_GL450_Context* self)
 {
 	if (self == nullptr) return;
 
-	bool result = glXMakeCurrent(self->display, self->dummy_window, self->context);
+	auto drawable = self->pbuffer ? (GLXDrawable)self->pbuffer : (GLXDrawable)self->dummy_window;
+	bool result = glXMakeCurrent(self->display, drawable, self->context);
 	assert(result && "glXMakeCurrent failed");
 }
 
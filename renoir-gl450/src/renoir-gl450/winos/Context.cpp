@@ -38,6 +38,8 @@ struct Renoir_GL450_Context
 	HGLRC context;
 	HWND dummy_window;
 	HDC dummy_dc;
+	// worker contexts use the dummy window of the context they were created from
+	bool owns_window;
 };
 
 inline static int
@@ -245,6 +247,7 @@ renoir_gl450_context_new(Renoir_Settings* settings, void*)
 	self->context = ctx;
 	self->dummy_dc = dummy_dc;
 	self->dummy_window = dummy_window;
+	self->owns_window = true;
 	return self;
 err:
 	if (fake_ctx) wglDeleteContext(fake_ctx);
@@ -262,11 +265,39 @@ renoir_gl450_context_free(Renoir_GL450_Context* self)
 	if (self == nullptr) return;
 
 	wglDeleteContext(self->context);
-	ReleaseDC(self->dummy_window, self->dummy_dc);
-	DestroyWindow(self->dummy_window);
+	if (self->owns_window)
+	{
+		ReleaseDC(self->dummy_window, self->dummy_dc);
+		DestroyWindow(self->dummy_window);
+	}
 	mn::free(self);
 }
 
+Renoir_GL450_Context*
+renoir_gl450_context_worker_new(Renoir_GL450_Context* self)
+{
+	if (self == nullptr) return nullptr;
+
+	const int major_min = 4, minor_min = 5;
+	int context_attribs[] = {
+		WGL_CONTEXT_MAJOR_VERSION_ARB, major_min,
+		WGL_CONTEXT_MINOR_VERSION_ARB, minor_min,
+		WGL_CONTEXT_PROFILE_MASK_ARB,  WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+		0
+	};
+
+	auto ctx = wglCreateContextAttribsARB(self->dummy_dc, self->context, context_attribs);
+	if (ctx == NULL)
+		return nullptr;
+
+	auto worker = mn::alloc<Renoir_GL450_Context>();
+	worker->context = ctx;
+	worker->dummy_dc = self->dummy_dc;
+	worker->dummy_window = self->dummy_window;
+	worker->owns_window = false;
+	return worker;
+}
+
 void
 renoir_gl450_context_window_init(Renoir_GL450_Context* self, Renoir_Handle* h, Renoir_Settings* settings)
 {
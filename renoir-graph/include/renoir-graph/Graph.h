@@ -0,0 +1,86 @@
+#pragma once
+
+#include "renoir-graph/Exports.h"
+#include "renoir/Renoir.h"
+
+#if __cplusplus
+extern "C" {
+#endif
+
+// render graph built on top of the Renoir API, it's rebuilt every frame
+// passes declare the textures they read and write, then renoir_graph_execute culls the passes which
+// nobody reads, orders the rest by their dependencies, and allocates the transient textures from a pool
+// where transient textures with the same desc which are not alive at the same time share the same texture
+typedef struct Renoir_Graph Renoir_Graph;
+
+// handle to a texture declared in the graph, it's only valid in the frame it was declared in
+typedef struct Renoir_Graph_Texture {
+	int index; // 0 is the invalid texture
+} Renoir_Graph_Texture;
+
+typedef struct Renoir_Graph_Pass {
+	int index; // 0 is the invalid pass
+} Renoir_Graph_Pass;
+
+typedef enum RENOIR_GRAPH_PASS_KIND {
+	// raster pass which renders into the textures written with renoir_graph_pass_write_color/depth, if it
+	// has no attachments the pass given to execute is null and the pass should submit to its own passes
+	RENOIR_GRAPH_PASS_KIND_RASTER,
+	RENOIR_GRAPH_PASS_KIND_COMPUTE,
+} RENOIR_GRAPH_PASS_KIND;
+
+// called when the pass executes, record the pass commands into pass and use renoir_graph_texture to get the
+// textures, the graph submits and frees the pass after it returns
+typedef void (*Renoir_Graph_Execute)(Renoir* api, Renoir_Graph* graph, Renoir_Pass pass, void* user_data);
+
+typedef struct Renoir_Graph_Pass_Desc {
+	const char* name; // should be alive until renoir_graph_execute returns
+	RENOIR_GRAPH_PASS_KIND kind; // default: RENOIR_GRAPH_PASS_KIND_RASTER
+	// default: false, passes with side effects are never culled (e.g. passes which render to the swapchain)
+	bool side_effect;
+	Renoir_Graph_Execute execute;
+	void* user_data;
+} Renoir_Graph_Pass_Desc;
+
+RENOIR_GRAPH_EXPORT Renoir_Graph*
+renoir_graph_new(Renoir* api);
+
+RENOIR_GRAPH_EXPORT void
+renoir_graph_free(Renoir_Graph* self);
+
+// transient texture which only lives inside the frame, desc.data should be null
+RENOIR_GRAPH_EXPORT Renoir_Graph_Texture
+renoir_graph_texture_new(Renoir_Graph* self, const char* name, Renoir_Texture_Desc desc);
+
+// texture owned by the user, passes which write to imported textures are never culled
+RENOIR_GRAPH_EXPORT Renoir_Graph_Texture
+renoir_graph_texture_import(Renoir_Graph* self, const char* name, Renoir_Texture texture);
+
+// returns the texture which backs the graph texture, it's only valid inside the execute callbacks
+RENOIR_GRAPH_EXPORT Renoir_Texture
+renoir_graph_texture(Renoir_Graph* self, Renoir_Graph_Texture texture);
+
+RENOIR_GRAPH_EXPORT Renoir_Graph_Pass
+renoir_graph_pass_new(Renoir_Graph* self, Renoir_Graph_Pass_Desc desc);
+
+// reads see the texture after all the passes which write to it
+RENOIR_GRAPH_EXPORT void
+renoir_graph_pass_read(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture);
+
+// writes without attaching the texture to the pass (e.g. compute passes writing to images)
+RENOIR_GRAPH_EXPORT void
+renoir_graph_pass_write(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture);
+
+RENOIR_GRAPH_EXPORT void
+renoir_graph_pass_write_color(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture, int slot);
+
+RENOIR_GRAPH_EXPORT void
+renoir_graph_pass_write_depth(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture);
+
+// compiles and executes the declared passes then clears the graph for the next frame
+RENOIR_GRAPH_EXPORT void
+renoir_graph_execute(Renoir_Graph* self);
+
+#if __cplusplus
+}
+#endif
@@ -0,0 +1,528 @@
+#include "renoir-graph/Graph.h"
+
+#include <mn/Buf.h>
+#include <mn/Log.h>
+#include <mn/Memory.h>
+#include <mn/Assert.h>
+
+// pooled textures which are not used for this number of frames are freed
+constexpr uint64_t RENOIR_GRAPH_POOL_UNUSED_FRAMES = 4;
+
+struct Renoir_Graph_Texture_Node
+{
+	const char* name;
+	Renoir_Texture_Desc desc;
+	bool imported;
+	Renoir_Texture texture;
+	// indices of the passes which write/read the texture in declaration order
+	mn::Buf<int> writers;
+	mn::Buf<int> readers;
+	// first and last position of the texture in the execution order, -1 if no alive pass uses it
+	int first_use;
+	int last_use;
+	// index of the pool texture which backs this transient texture
+	int pool_index;
+};
+
+struct Renoir_Graph_Pass_Node
+{
+	Renoir_Graph_Pass_Desc desc;
+	// indices of the textures the pass reads/writes
+	mn::Buf<int> reads;
+	mn::Buf<int> writes;
+	// attachments are texture handle indices, 0 means no attachment
+	int color[RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE];
+	int depth;
+	bool alive;
+	int in_degree;
+};
+
+// transient textures are pooled by desc, a pool texture backs all the transient textures with the same desc
+// whose lifetimes don't overlap in the frame
+struct Renoir_Graph_Pool_Texture
+{
+	Renoir_Texture_Desc desc;
+	Renoir_Texture texture;
+	bool in_use;
+	uint64_t last_used_frame;
+};
+
+struct Renoir_Graph
+{
+	Renoir* api;
+	uint64_t frame;
+	mn::Buf<Renoir_Graph_Texture_Node> textures;
+	mn::Buf<Renoir_Graph_Pass_Node> passes;
+	mn::Buf<Renoir_Graph_Pool_Texture> pool;
+	// compile scratch memory, kept across frames to avoid allocating every frame
+	mn::Buf<int> order;
+	mn::Buf<int> stack;
+};
+
+inline static bool
+_renoir_graph_sampler_desc_equal(const Renoir_Sampler_Desc& a, const Renoir_Sampler_Desc& b)
+{
+	return (
+		a.filter == b.filter &&
+		a.u == b.u &&
+		a.v == b.v &&
+		a.w == b.w &&
+		a.compare == b.compare &&
+		a.border.r == b.border.r &&
+		a.border.g == b.border.g &&
+		a.border.b == b.border.b &&
+		a.border.a == b.border.a
+	);
+}
+
+inline static bool
+_renoir_graph_texture_desc_equal(const Renoir_Texture_Desc& a, const Renoir_Texture_Desc& b)
+{
+	return (
+		a.size.width == b.size.width &&
+		a.size.height == b.size.height &&
+		a.size.depth == b.size.depth &&
+		a.usage == b.usage &&
+		a.access == b.access &&
+		a.pixel_format == b.pixel_format &&
+		a.mipmaps == b.mipmaps &&
+		a.render_target == b.render_target &&
+		a.msaa == b.msaa &&
+		a.cube_map == b.cube_map &&
+		_renoir_graph_sampler_desc_equal(a.sampler, b.sampler)
+	);
+}
+
+inline static Renoir_Graph_Texture_Node&
+_renoir_graph_texture_node(Renoir_Graph* self, Renoir_Graph_Texture texture)
+{
+	mn_assert_msg(texture.index > 0 && texture.index <= self->textures.count, "invalid graph texture");
+	return self->textures[texture.index - 1];
+}
+
+inline static Renoir_Graph_Pass_Node&
+_renoir_graph_pass_node(Renoir_Graph* self, Renoir_Graph_Pass pass)
+{
+	mn_assert_msg(pass.index > 0 && pass.index <= self->passes.count, "invalid graph pass");
+	return self->passes[pass.index - 1];
+}
+
+inline static void
+_renoir_graph_push_unique(mn::Buf<int>& list, int value)
+{
+	for (auto v: list)
+		if (v == value)
+			return;
+	mn::buf_push(list, value);
+}
+
+inline static bool
+_renoir_graph_contains(const mn::Buf<int>& list, int value)
+{
+	for (auto v: list)
+		if (v == value)
+			return true;
+	return false;
+}
+
+static void
+_renoir_graph_write(Renoir_Graph* self, int pass_index, Renoir_Graph_Texture texture)
+{
+	auto& pass = self->passes[pass_index];
+	auto& node = _renoir_graph_texture_node(self, texture);
+	_renoir_graph_push_unique(pass.writes, texture.index - 1);
+	_renoir_graph_push_unique(node.writers, pass_index);
+}
+
+// calls func with the passes which depend on pass p, all the writers of a texture run in declaration
+// order and the readers of the texture run after its last writer
+template<typename TFunc>
+static void
+_renoir_graph_pass_successors(Renoir_Graph* self, int p, TFunc&& func)
+{
+	for (auto t: self->passes[p].writes)
+	{
+		auto& node = self->textures[t];
+
+		int next_writer = -1;
+		bool found = false;
+		for (auto w: node.writers)
+		{
+			if (self->passes[w].alive == false)
+				continue;
+
+			if (found)
+			{
+				next_writer = w;
+				break;
+			}
+			found = w == p;
+		}
+
+		if (next_writer != -1)
+		{
+			func(next_writer);
+			continue;
+		}
+
+		for (auto r: node.readers)
+			if (self->passes[r].alive && _renoir_graph_contains(node.writers, r) == false)
+				func(r);
+	}
+}
+
+// passes are alive if they have side effects, write to imported textures, or write to textures read by alive passes
+static void
+_renoir_graph_cull(Renoir_Graph* self)
+{
+	mn::buf_clear(self->stack);
+	for (int i = 0; i < self->passes.count; ++i)
+	{
+		auto& pass = self->passes[i];
+		pass.alive = pass.desc.side_effect;
+		for (auto t: pass.writes)
+			pass.alive |= self->textures[t].imported;
+
+		if (pass.alive)
+			mn::buf_push(self->stack, i);
+	}
+
+	while (self->stack.count > 0)
+	{
+		auto p = mn::buf_top(self->stack);
+		mn::buf_pop(self->stack);
+
+		for (auto t: self->passes[p].reads)
+		{
+			for (auto w: self->textures[t].writers)
+			{
+				if (self->passes[w].alive)
+					continue;
+
+				self->passes[w].alive = true;
+				mn::buf_push(self->stack, w);
+			}
+		}
+	}
+}
+
+// orders the alive passes topologically, ties are broken by declaration order
+static void
+_renoir_graph_order(Renoir_Graph* self)
+{
+	mn::buf_clear(self->order);
+
+	int alive_count = 0;
+	for (auto& pass: self->passes)
+	{
+		pass.in_degree = 0;
+		if (pass.alive)
+			++alive_count;
+	}
+
+	for (int i = 0; i < self->passes.count; ++i)
+	{
+		if (self->passes[i].alive == false)
+			continue;
+		_renoir_graph_pass_successors(self, i, [self](int s) { ++self->passes[s].in_degree; });
+	}
+
+	while (self->order.count < alive_count)
+	{
+		int next = -1;
+		for (int i = 0; i < self->passes.count; ++i)
+		{
+			auto& pass = self->passes[i];
+			if (pass.alive && pass.in_degree == 0)
+			{
+				next = i;
+				break;
+			}
+		}
+
+		if (next == -1)
+		{
+			mn::log_error("render graph has a dependency cycle, the remaining passes will execute in declaration order");
+			for (int i = 0; i < self->passes.count; ++i)
+				if (self->passes[i].alive && self->passes[i].in_degree > 0)
+					mn::buf_push(self->order, i);
+			break;
+		}
+
+		// mark it as emitted
+		self->passes[next].in_degree = -1;
+		mn::buf_push(self->order, next);
+		_renoir_graph_pass_successors(self, next, [self](int s) { --self->passes[s].in_degree; });
+	}
+}
+
+static int
+_renoir_graph_pool_acquire(Renoir_Graph* self, const Renoir_Texture_Desc& desc)
+{
+	for (int i = 0; i < self->pool.count; ++i)
+	{
+		auto& entry = self->pool[i];
+		if (entry.in_use == false && _renoir_graph_texture_desc_equal(entry.desc, desc))
+		{
+			entry.in_use = true;
+			entry.last_used_frame = self->frame;
+			return i;
+		}
+	}
+
+	Renoir_Graph_Pool_Texture entry{};
+	entry.desc = desc;
+	entry.texture = self->api->texture_new(self->api, desc);
+	entry.in_use = true;
+	entry.last_used_frame = self->frame;
+	mn::buf_push(self->pool, entry);
+	return int(self->pool.count - 1);
+}
+
+// transient textures whose lifetimes don't overlap in the execution order share the same pool texture
+static void
+_renoir_graph_allocate(Renoir_Graph* self)
+{
+	for (auto& node: self->textures)
+	{
+		node.first_use = -1;
+		node.last_use = -1;
+		node.pool_index = -1;
+	}
+
+	for (int i = 0; i < self->order.count; ++i)
+	{
+		auto& pass = self->passes[self->order[i]];
+		auto use = [self, i](int t) {
+			auto& node = self->textures[t];
+			if (node.first_use == -1)
+				node.first_use = i;
+			node.last_use = i;
+		};
+		for (auto t: pass.reads)
+			use(t);
+		for (auto t: pass.writes)
+			use(t);
+	}
+
+	for (int i = 0; i < self->order.count; ++i)
+	{
+		for (auto& node: self->textures)
+		{
+			if (node.imported || node.first_use != i)
+				continue;
+
+			node.pool_index = _renoir_graph_pool_acquire(self, node.desc);
+			node.texture = self->pool[node.pool_index].texture;
+		}
+
+		for (auto& node: self->textures)
+		{
+			if (node.imported || node.last_use != i)
+				continue;
+
+			self->pool[node.pool_index].in_use = false;
+		}
+	}
+}
+
+static void
+_renoir_graph_clear(Renoir_Graph* self)
+{
+	for (auto& node: self->textures)
+	{
+		mn::buf_free(node.writers);
+		mn::buf_free(node.readers);
+	}
+	mn::buf_clear(self->textures);
+
+	for (auto& pass: self->passes)
+	{
+		mn::buf_free(pass.reads);
+		mn::buf_free(pass.writes);
+	}
+	mn::buf_clear(self->passes);
+}
+
+// API
+Renoir_Graph*
+renoir_graph_new(Renoir* api)
+{
+	mn_assert(api != nullptr);
+
+	auto self = mn::alloc_zerod<Renoir_Graph>();
+	self->api = api;
+	return self;
+}
+
+void
+renoir_graph_free(Renoir_Graph* self)
+{
+	if (self == nullptr)
+		return;
+
+	_renoir_graph_clear(self);
+	for (auto& entry: self->pool)
+		self->api->texture_free(self->api, entry.texture);
+	mn::buf_free(self->textures);
+	mn::buf_free(self->passes);
+	mn::buf_free(self->pool);
+	mn::buf_free(self->order);
+	mn::buf_free(self->stack);
+	mn::free(self);
+}
+
+Renoir_Graph_Texture
+renoir_graph_texture_new(Renoir_Graph* self, const char* name, Renoir_Texture_Desc desc)
+{
+	for (auto data: desc.data)
+		mn_assert_msg(data == nullptr, "transient textures can't have initial data");
+
+	Renoir_Graph_Texture_Node node{};
+	node.name = name;
+	node.desc = desc;
+	mn::buf_push(self->textures, node);
+	return Renoir_Graph_Texture{int(self->textures.count)};
+}
+
+Renoir_Graph_Texture
+renoir_graph_texture_import(Renoir_Graph* self, const char* name, Renoir_Texture texture)
+{
+	mn_assert(texture.handle != nullptr);
+
+	Renoir_Graph_Texture_Node node{};
+	node.name = name;
+	node.imported = true;
+	node.texture = texture;
+	mn::buf_push(self->textures, node);
+	return Renoir_Graph_Texture{int(self->textures.count)};
+}
+
+Renoir_Texture
+renoir_graph_texture(Renoir_Graph* self, Renoir_Graph_Texture texture)
+{
+	auto& node = _renoir_graph_texture_node(self, texture);
+	mn_assert_msg(node.texture.handle != nullptr, "graph texture is not used by any executing pass");
+	return node.texture;
+}
+
+Renoir_Graph_Pass
+renoir_graph_pass_new(Renoir_Graph* self, Renoir_Graph_Pass_Desc desc)
+{
+	mn_assert_msg(desc.execute != nullptr, "graph pass should have an execute function");
+
+	Renoir_Graph_Pass_Node pass{};
+	pass.desc = desc;
+	mn::buf_push(self->passes, pass);
+	return Renoir_Graph_Pass{int(self->passes.count)};
+}
+
+void
+renoir_graph_pass_read(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture)
+{
+	auto& p = _renoir_graph_pass_node(self, pass);
+	auto& node = _renoir_graph_texture_node(self, texture);
+	_renoir_graph_push_unique(p.reads, texture.index - 1);
+	_renoir_graph_push_unique(node.readers, pass.index - 1);
+}
+
+void
+renoir_graph_pass_write(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture)
+{
+	_renoir_graph_pass_node(self, pass);
+	_renoir_graph_write(self, pass.index - 1, texture);
+}
+
+void
+renoir_graph_pass_write_color(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture, int slot)
+{
+	auto& p = _renoir_graph_pass_node(self, pass);
+	mn_assert_msg(p.desc.kind == RENOIR_GRAPH_PASS_KIND_RASTER, "only raster passes can have color attachments");
+	mn_assert_msg(slot >= 0 && slot < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE, "color attachment slot is out of range");
+
+	auto& node = _renoir_graph_texture_node(self, texture);
+	if (node.imported == false)
+		node.desc.render_target = true;
+
+	p.color[slot] = texture.index;
+	_renoir_graph_write(self, pass.index - 1, texture);
+}
+
+void
+renoir_graph_pass_write_depth(Renoir_Graph* self, Renoir_Graph_Pass pass, Renoir_Graph_Texture texture)
+{
+	auto& p = _renoir_graph_pass_node(self, pass);
+	mn_assert_msg(p.desc.kind == RENOIR_GRAPH_PASS_KIND_RASTER, "only raster passes can have a depth attachment");
+
+	auto& node = _renoir_graph_texture_node(self, texture);
+	if (node.imported == false)
+		node.desc.render_target = true;
+
+	p.depth = texture.index;
+	_renoir_graph_write(self, pass.index - 1, texture);
+}
+
+void
+renoir_graph_execute(Renoir_Graph* self)
+{
+	auto api = self->api;
+
+	_renoir_graph_cull(self);
+	_renoir_graph_order(self);
+	_renoir_graph_allocate(self);
+
+	for (auto p: self->order)
+	{
+		auto& node = self->passes[p];
+
+		Renoir_Pass pass{};
+		if (node.desc.kind == RENOIR_GRAPH_PASS_KIND_COMPUTE)
+		{
+			pass = api->pass_compute_new(api);
+		}
+		else
+		{
+			Renoir_Pass_Offscreen_Desc desc{};
+			bool has_attachments = false;
+			for (int i = 0; i < RENOIR_CONSTANT_COLOR_ATTACHMENT_SIZE; ++i)
+			{
+				if (node.color[i] == 0)
+					continue;
+				desc.color[i].texture = self->textures[node.color[i] - 1].texture;
+				has_attachments = true;
+			}
+			if (node.depth != 0)
+			{
+				desc.depth_stencil.texture = self->textures[node.depth - 1].texture;
+				has_attachments = true;
+			}
+
+			if (has_attachments)
+				pass = api->pass_offscreen_new(api, desc);
+		}
+
+		node.desc.execute(api, self, pass, node.desc.user_data);
+
+		if (pass.handle != nullptr)
+		{
+			api->pass_submit(api, pass);
+			api->pass_free(api, pass);
+		}
+	}
+
+	++self->frame;
+	for (size_t i = 0; i < self->pool.count;)
+	{
+		if (self->frame - self->pool[i].last_used_frame > RENOIR_GRAPH_POOL_UNUSED_FRAMES)
+		{
+			api->texture_free(api, self->pool[i].texture);
+			mn::buf_remove(self->pool, i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	_renoir_graph_clear(self);
+}
@@ -13,6 +13,7 @@
 #include <mn/Assert.h>
 
 #include <atomic>
+#include <chrono>
 #include <math.h>
 #include <stdio.h>
 
@@ -33,8 +34,23 @@ enum RENOIR_HANDLE_KIND
 	RENOIR_HANDLE_KIND_COMPUTE,
 	RENOIR_HANDLE_KIND_PIPELINE,
 	RENOIR_HANDLE_KIND_TIMER,
+	RENOIR_HANDLE_KIND_READBACK,
 };
 
+#if RENOIR_STATS
+// pass commands are counted in their pass since each pass is recorded by a single thread, the counts are added to the
+// frame stats when the pass is submitted
+struct Renoir_Null_Pass_Stats
+{
+	size_t draws;
+	size_t dispatches;
+	size_t primitives;
+	size_t upload_bytes;
+	size_t pipeline_binds;
+	size_t texture_binds;
+};
+#endif
+
 struct Renoir_Handle
 {
 	RENOIR_HANDLE_KIND kind;
@@ -52,17 +68,27 @@ struct Renoir_Handle
 		{
 			Renoir_Command *command_list_head;
 			Renoir_Command *command_list_tail;
+			// used by secondary passes which are merged into their parent
+			Renoir_Handle* parent;
 			// used when rendering is done on screen/window
 			Renoir_Handle* swapchain;
 			// used when rendering is done off screen
 			int width, height;
 			Renoir_Pass_Offscreen_Desc offscreen;
+#if RENOIR_STATS
+			Renoir_Null_Pass_Stats stats;
+#endif
 		} raster_pass;
 
 		struct
 		{
 			Renoir_Command *command_list_head;
 			Renoir_Command *command_list_tail;
+			// used by secondary passes which are merged into their parent
+			Renoir_Handle* parent;
+#if RENOIR_STATS
+			Renoir_Null_Pass_Stats stats;
+#endif
 		} compute_pass;
 
 		struct
@@ -71,6 +97,9 @@ struct Renoir_Handle
 			RENOIR_USAGE usage;
 			RENOIR_ACCESS access;
 			size_t size;
+			// stream buffers are backed by cpu memory so the returned pointers can be written to
+			mn::Block stream_memory;
+			size_t stream_head;
 		} buffer;
 
 		struct
@@ -100,9 +129,60 @@ struct Renoir_Handle
 		struct
 		{
 		} timer;
+
+		struct
+		{
+			size_t size;
+		} readback;
 	};
 };
 
+inline static size_t
+_renoir_pixelformat_to_size(RENOIR_PIXELFORMAT format)
+{
+	switch(format)
+	{
+	case RENOIR_PIXELFORMAT_RGBA8:
+	case RENOIR_PIXELFORMAT_D32:
+	case RENOIR_PIXELFORMAT_R32F:
+	case RENOIR_PIXELFORMAT_D24S8:
+		return 4;
+	case RENOIR_PIXELFORMAT_R16I:
+	case RENOIR_PIXELFORMAT_R16UI:
+	case RENOIR_PIXELFORMAT_R16F:
+		return 2;
+	case RENOIR_PIXELFORMAT_R32G32F:
+	case RENOIR_PIXELFORMAT_R16G16B16A16F:
+		return 8;
+	case RENOIR_PIXELFORMAT_R32G32B32A32F: return 16;
+	case RENOIR_PIXELFORMAT_R8: return 1;
+	default: mn_unreachable(); return 0;
+	}
+}
+
+// estimated bytes of the texture, it counts all the mip levels, the cube faces, and the msaa render buffers of the render targets
+inline static size_t
+_renoir_texture_desc_bytes(const Renoir_Texture_Desc& desc)
+{
+	size_t width = desc.size.width > 0 ? desc.size.width : 1;
+	size_t height = desc.size.height > 0 ? desc.size.height : 1;
+	size_t depth = desc.size.depth > 0 ? desc.size.depth : 1;
+	size_t pixel_size = _renoir_pixelformat_to_size(desc.pixel_format);
+	size_t faces = desc.cube_map ? 6 : 1;
+
+	size_t res = 0;
+	int mipmaps = desc.mipmaps > 0 ? desc.mipmaps : 1;
+	for (int i = 0; i < mipmaps; ++i)
+	{
+		res += (width >> i > 0 ? width >> i : 1) * (height >> i > 0 ? height >> i : 1) * (depth >> i > 0 ? depth >> i : 1) * pixel_size;
+	}
+	res *= faces;
+
+	if (desc.render_target && desc.msaa != RENOIR_MSAA_MODE_NONE)
+		res += width * height * pixel_size * size_t(desc.msaa) * faces;
+	return res;
+}
+
 inline static const char*
 _renoir_handle_kind_name(RENOIR_HANDLE_KIND kind)
 {
@@ -118,10 +198,45 @@ _renoir_handle_kind_name(RENOIR_HANDLE_KIND kind)
 	case RENOIR_HANDLE_KIND_PROGRAM: return "program";
 	case RENOIR_HANDLE_KIND_COMPUTE: return "compute";
 	case RENOIR_HANDLE_KIND_PIPELINE: return "pipeline";
+	case RENOIR_HANDLE_KIND_TIMER: return "timer";
+	case RENOIR_HANDLE_KIND_READBACK: return "readback";
 	default: mn_unreachable_msg("invalid handle kind"); return "<INVALID>";
 	}
 }
 
+inline static RENOIR_RESOURCE
+_renoir_handle_kind_to_resource(RENOIR_HANDLE_KIND kind)
+{
+	switch(kind)
+	{
+	case RENOIR_HANDLE_KIND_SWAPCHAIN: return RENOIR_RESOURCE_SWAPCHAIN;
+	case RENOIR_HANDLE_KIND_RASTER_PASS: return RENOIR_RESOURCE_RASTER_PASS;
+	case RENOIR_HANDLE_KIND_COMPUTE_PASS: return RENOIR_RESOURCE_COMPUTE_PASS;
+	case RENOIR_HANDLE_KIND_BUFFER: return RENOIR_RESOURCE_BUFFER;
+	case RENOIR_HANDLE_KIND_TEXTURE: return RENOIR_RESOURCE_TEXTURE;
+	case RENOIR_HANDLE_KIND_SAMPLER: return RENOIR_RESOURCE_SAMPLER;
+	case RENOIR_HANDLE_KIND_PROGRAM: return RENOIR_RESOURCE_PROGRAM;
+	case RENOIR_HANDLE_KIND_COMPUTE: return RENOIR_RESOURCE_COMPUTE;
+	case RENOIR_HANDLE_KIND_PIPELINE: return RENOIR_RESOURCE_PIPELINE;
+	case RENOIR_HANDLE_KIND_TIMER: return RENOIR_RESOURCE_TIMER;
+	case RENOIR_HANDLE_KIND_READBACK: return RENOIR_RESOURCE_READBACK;
+	default: mn_unreachable_msg("invalid handle kind"); return RENOIR_RESOURCE_COUNT;
+	}
+}
+
+inline static size_t
+_renoir_primitive_count(RENOIR_PRIMITIVE p, int elements_count, int instances_count)
+{
+	size_t instances = instances_count > 1 ? instances_count : 1;
+	switch (p)
+	{
+	case RENOIR_PRIMITIVE_POINTS: return elements_count * instances;
+	case RENOIR_PRIMITIVE_LINES: return elements_count / 2 * instances;
+	case RENOIR_PRIMITIVE_TRIANGLES: return elements_count / 3 * instances;
+	default: mn_unreachable(); return 0;
+	}
+}
+
 inline static bool
 _renoir_handle_kind_should_track(RENOIR_HANDLE_KIND kind)
 {
@@ -135,7 +250,8 @@ _renoir_handle_kind_should_track(RENOIR_HANDLE_KIND kind)
 		// we ignore the samplers because they are cached not user created
 		// kind == RENOIR_HANDLE_KIND_SAMPLER ||
 		kind == RENOIR_HANDLE_KIND_PROGRAM ||
-		kind == RENOIR_HANDLE_KIND_COMPUTE
+		kind == RENOIR_HANDLE_KIND_COMPUTE ||
+		kind == RENOIR_HANDLE_KIND_READBACK
 		// we ignore the pipeline because they are cached not user created
 		// kind == RENOIR_HANDLE_KIND_PIPELINE
 	);
@@ -202,8 +318,36 @@ enum RENOIR_COMMAND_KIND
 	RENOIR_COMMAND_KIND_PROGRAM_FREE,
 	RENOIR_COMMAND_KIND_COMPUTE_FREE,
 	RENOIR_COMMAND_KIND_TIMER_FREE,
+	RENOIR_COMMAND_KIND_READBACK_FREE,
+	RENOIR_COMMAND_KIND_COUNT,
 };
 
+static_assert(int(RENOIR_COMMAND_KIND_COUNT) <= int(RENOIR_CONSTANT_STATS_COMMAND_KIND_SIZE), "frame stats can't count all the command kinds");
+
+inline static const char*
+_renoir_null_command_kind_name(int kind)
+{
+	switch(kind)
+	{
+	case RENOIR_COMMAND_KIND_NONE: return "none";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_FREE: return "swapchain_free";
+	case RENOIR_COMMAND_KIND_SWAPCHAIN_RESIZE: return "swapchain_resize";
+	case RENOIR_COMMAND_KIND_PASS_OFFSCREEN_NEW: return "pass_offscreen_new";
+	case RENOIR_COMMAND_KIND_PASS_COMPUTE_NEW: return "pass_compute_new";
+	case RENOIR_COMMAND_KIND_PIPELINE_NEW: return "pipeline_new";
+	case RENOIR_COMMAND_KIND_PIPELINE_FREE: return "pipeline_free";
+	case RENOIR_COMMAND_KIND_PASS_FREE: return "pass_free";
+	case RENOIR_COMMAND_KIND_BUFFER_FREE: return "buffer_free";
+	case RENOIR_COMMAND_KIND_TEXTURE_FREE: return "texture_free";
+	case RENOIR_COMMAND_KIND_SAMPLER_FREE: return "sampler_free";
+	case RENOIR_COMMAND_KIND_PROGRAM_FREE: return "program_free";
+	case RENOIR_COMMAND_KIND_COMPUTE_FREE: return "compute_free";
+	case RENOIR_COMMAND_KIND_TIMER_FREE: return "timer_free";
+	case RENOIR_COMMAND_KIND_READBACK_FREE: return "readback_free";
+	default: return nullptr;
+	}
+}
+
 struct Renoir_Command
 {
 	Renoir_Command *prev, *next;
@@ -330,6 +474,11 @@ struct Renoir_Command
 			Renoir_Handle* handle;
 		} timer_free;
 
+		struct
+		{
+			Renoir_Handle* handle;
+		} readback_free;
+
 		struct
 		{
 			Renoir_Handle* handle;
@@ -459,6 +608,8 @@ struct IRenoir
 {
 	mn::Mutex mtx;
 	mn::Pool handle_pool;
+	// resource accounting, it's updated with the handles so it's guarded by mtx as well
+	Renoir_Resource_Stats resource_stats;
 	mn::Pool command_pool;
 	Renoir_Settings settings;
 
@@ -472,6 +623,22 @@ struct IRenoir
 	// caches
 	mn::Buf<Renoir_Handle*> sampler_cache;
 
+#if RENOIR_STATS
+	// frame stats, the pass commands aren't recorded here so the recorders count them in their pass and the passes add
+	// their counts to the atomics on submit since passes are submitted concurrently, writes to the global pass are
+	// added directly, the rest is guarded by mtx and everything is snapshotted by present/flush
+	uint64_t frame_index;
+	uint64_t mtx_locked_time;
+	std::atomic<size_t> draws_frame;
+	std::atomic<size_t> dispatches_frame;
+	std::atomic<size_t> primitives_frame;
+	std::atomic<size_t> upload_bytes_frame;
+	std::atomic<size_t> pipeline_binds_frame;
+	std::atomic<size_t> texture_binds_frame;
+	Renoir_Frame_Stats frame_stats;
+	Renoir_Frame_Stats frame_stats_last;
+#endif
+
 	// leak detection
 	mn::Map<Renoir_Handle*, Renoir_Leak_Info> alive_handles;
 };
@@ -479,6 +646,75 @@ struct IRenoir
 static void
 _renoir_null_command_execute(IRenoir* self, Renoir_Command* command);
 
+static uint64_t
+_renoir_null_time_in_nanos()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+// api lock, it's timed when the frame stats are enabled
+inline static void
+_renoir_null_mtx_lock(IRenoir* self)
+{
+#if RENOIR_STATS
+	auto start_time = _renoir_null_time_in_nanos();
+	mn::mutex_lock(self->mtx);
+	self->mtx_locked_time = _renoir_null_time_in_nanos();
+	self->frame_stats.mtx_wait_time_in_nanos += self->mtx_locked_time - start_time;
+	++self->frame_stats.mtx_locks;
+#else
+	mn::mutex_lock(self->mtx);
+#endif
+}
+
+inline static void
+_renoir_null_mtx_unlock(IRenoir* self)
+{
+#if RENOIR_STATS
+	self->frame_stats.mtx_hold_time_in_nanos += _renoir_null_time_in_nanos() - self->mtx_locked_time;
+#endif
+	mn::mutex_unlock(self->mtx);
+}
+
+// called by present/flush under mtx after the frame's commands are executed
+static void
+_renoir_null_frame_end(IRenoir* self)
+{
+#if RENOIR_STATS
+	auto& stats = self->frame_stats;
+	stats.frame = self->frame_index++;
+	stats.draws = self->draws_frame.exchange(0);
+	stats.dispatches = self->dispatches_frame.exchange(0);
+	stats.primitives = self->primitives_frame.exchange(0);
+	stats.upload_bytes = self->upload_bytes_frame.exchange(0);
+	stats.pipeline_binds = self->pipeline_binds_frame.exchange(0);
+	stats.texture_binds = self->texture_binds_frame.exchange(0);
+	// the hold time of the present/flush lock is counted in the next frame since it's still held
+	self->frame_stats_last = stats;
+	stats = Renoir_Frame_Stats{};
+#endif
+}
+
+// buffers and textures add their bytes once their desc is set, the bytes are removed when the handle is freed
+static void
+_renoir_null_resource_bytes_add(IRenoir* self, Renoir_Handle* h)
+{
+	auto& stats = self->resource_stats;
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+	{
+		stats.buffer_bytes += h->buffer.size;
+		if (stats.buffer_bytes > stats.buffer_bytes_high_water)
+			stats.buffer_bytes_high_water = stats.buffer_bytes;
+	}
+	else if (h->kind == RENOIR_HANDLE_KIND_TEXTURE)
+	{
+		stats.texture_bytes += _renoir_texture_desc_bytes(h->texture.desc);
+		if (stats.texture_bytes > stats.texture_bytes_high_water)
+			stats.texture_bytes_high_water = stats.texture_bytes;
+	}
+}
+
 static Renoir_Handle*
 _renoir_null_handle_new(IRenoir* self, RENOIR_HANDLE_KIND kind)
 {
@@ -487,6 +723,12 @@ _renoir_null_handle_new(IRenoir* self, RENOIR_HANDLE_KIND kind)
 	handle->kind = kind;
 	handle->rc = 1;
 
+	auto& stats = self->resource_stats;
+	auto resource = _renoir_handle_kind_to_resource(kind);
+	++stats.count[resource];
+	if (stats.count[resource] > stats.count_high_water[resource])
+		stats.count_high_water[resource] = stats.count[resource];
+
 	#ifdef DEBUG
 	if (_renoir_handle_kind_should_track(kind))
 	{
@@ -512,6 +754,13 @@ _renoir_null_handle_free(IRenoir* self, Renoir_Handle* h)
 		mn_assert_msg(removed, "free was called with an invalid renoir handle");
 	}
 	#endif
+	auto& stats = self->resource_stats;
+	--stats.count[_renoir_handle_kind_to_resource(h->kind)];
+	if (h->kind == RENOIR_HANDLE_KIND_BUFFER)
+		stats.buffer_bytes -= h->buffer.size;
+	else if (h->kind == RENOIR_HANDLE_KIND_TEXTURE)
+		stats.texture_bytes -= _renoir_texture_desc_bytes(h->texture.desc);
+
 	mn::pool_put(self->handle_pool, h);
 }
 
@@ -528,6 +777,26 @@ _renoir_null_handle_unref(Renoir_Handle* h)
 	return h->rc.fetch_sub(1) == 1;
 }
 
+inline static Renoir_Handle*
+_renoir_null_pass_parent(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		return h->raster_pass.parent;
+	mn_assert_msg(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS, "invalid pass");
+	return h->compute_pass.parent;
+}
+
+#if RENOIR_STATS
+inline static Renoir_Null_Pass_Stats&
+_renoir_null_pass_stats(Renoir_Handle* h)
+{
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		return h->raster_pass.stats;
+	mn_assert_msg(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS, "invalid pass");
+	return h->compute_pass.stats;
+}
+#endif
+
 template<typename T>
 static Renoir_Command*
 _renoir_null_command_new(T* self, RENOIR_COMMAND_KIND kind)
@@ -557,6 +826,7 @@ _renoir_null_command_free(T* self, Renoir_Command* command)
 	case RENOIR_COMMAND_KIND_COMPUTE_FREE:
 	case RENOIR_COMMAND_KIND_PIPELINE_FREE:
 	case RENOIR_COMMAND_KIND_TIMER_FREE:
+	case RENOIR_COMMAND_KIND_READBACK_FREE:
 	default:
 		// do nothing
 		break;
@@ -613,6 +883,11 @@ _renoir_null_command_process(IRenoir* self, Renoir_Command* command)
 static void
 _renoir_null_command_execute(IRenoir* self, Renoir_Command* command)
 {
+#if RENOIR_STATS
+	++self->frame_stats.commands_count;
+	++self->frame_stats.commands[command->kind];
+#endif
+
 	switch(command->kind)
 	{
 	case RENOIR_COMMAND_KIND_SWAPCHAIN_FREE:
@@ -698,6 +973,15 @@ _renoir_null_command_execute(IRenoir* self, Renoir_Command* command)
 				_renoir_null_command_free(self, command);
 		}
 
+		// secondary passes hold a reference to their parent
+		if (auto parent = _renoir_null_pass_parent(h))
+		{
+			auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_PASS_FREE);
+			command->pass_free.handle = parent;
+			_renoir_null_command_execute(self, command);
+			_renoir_null_command_free(self, command);
+		}
+
 		_renoir_null_handle_free(self, h);
 		break;
 	}
@@ -706,6 +990,8 @@ _renoir_null_command_execute(IRenoir* self, Renoir_Command* command)
 		auto h = command->buffer_free.handle;
 		if (_renoir_null_handle_unref(h) == false)
 			break;
+		if (h->buffer.usage == RENOIR_USAGE_STREAM)
+			mn::free(h->buffer.stream_memory);
 		_renoir_null_handle_free(self, h);
 		break;
 	}
@@ -769,6 +1055,14 @@ _renoir_null_command_execute(IRenoir* self, Renoir_Command* command)
 		_renoir_null_handle_free(self, h);
 		break;
 	}
+	case RENOIR_COMMAND_KIND_READBACK_FREE:
+	{
+		auto h = command->readback_free.handle;
+		if (_renoir_null_handle_unref(h) == false)
+			break;
+		_renoir_null_handle_free(self, h);
+		break;
+	}
 	default:
 		mn_unreachable();
 		break;
@@ -820,6 +1114,12 @@ _renoir_null_handle_leak_free(IRenoir* self, Renoir_Command* command)
 				}
 			}
 		}
+		if (auto parent = _renoir_null_pass_parent(h))
+		{
+			auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_PASS_FREE);
+			command->pass_free.handle = parent;
+			_renoir_null_handle_leak_free(self, command);
+		}
 		_renoir_null_handle_free(self, h);
 		break;
 	}
@@ -828,6 +1128,8 @@ _renoir_null_handle_leak_free(IRenoir* self, Renoir_Command* command)
 		auto h = command->buffer_free.handle;
 		if (_renoir_null_handle_unref(h) == false)
 			break;
+		if (h->buffer.usage == RENOIR_USAGE_STREAM)
+			mn::free(h->buffer.stream_memory);
 		_renoir_null_handle_free(self, h);
 		break;
 	}
@@ -885,6 +1187,14 @@ _renoir_null_handle_leak_free(IRenoir* self, Renoir_Command* command)
 		_renoir_null_handle_free(self, h);
 		break;
 	}
+	case RENOIR_COMMAND_KIND_READBACK_FREE:
+	{
+		auto h = command->readback_free.handle;
+		if (_renoir_null_handle_unref(h) == false)
+			break;
+		_renoir_null_handle_free(self, h);
+		break;
+	}
 	}
 }
 
@@ -961,9 +1271,43 @@ _renoir_null_info(Renoir* api)
 	Renoir_Info res{};
 	res.description = self->info_description.ptr;
 	res.gpu_memory_in_bytes = self->gpu_memory_in_bytes;
+	// the strictest alignment the real backends ask for, so offsets which work here work everywhere
+	res.uniform_buffer_offset_alignment = 256;
+	res.storage_buffer_offset_alignment = 256;
+	res.draw_indirect_count_supported = true;
 	return res;
 }
 
+static Renoir_Resource_Stats
+_renoir_null_resource_stats(Renoir* api)
+{
+	auto self = api->ctx;
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+	return self->resource_stats;
+}
+
+static Renoir_Frame_Stats
+_renoir_null_frame_stats(Renoir* api)
+{
+#if RENOIR_STATS
+	auto self = api->ctx;
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+	return self->frame_stats_last;
+#else
+	return Renoir_Frame_Stats{};
+#endif
+}
+
+static const char*
+_renoir_null_frame_stats_command_name(Renoir*, int kind)
+{
+	return _renoir_null_command_kind_name(kind);
+}
+
 static void
 _renoir_null_handle_ref(Renoir* api, void* handle)
 {
@@ -976,8 +1320,8 @@ _renoir_null_flush(Renoir* api, void* device, void* context)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	// process commands
 	for(auto it = self->command_list_head; it != nullptr; it = it->next)
@@ -988,6 +1332,8 @@ _renoir_null_flush(Renoir* api, void* device, void* context)
 
 	self->command_list_head = nullptr;
 	self->command_list_tail = nullptr;
+
+	_renoir_null_frame_end(self);
 }
 
 static Renoir_Swapchain
@@ -995,8 +1341,8 @@ _renoir_null_swapchain_new(Renoir* api, int width, int height, void* window, voi
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_SWAPCHAIN);
 	h->swapchain.width = width;
@@ -1013,8 +1359,8 @@ _renoir_null_swapchain_free(Renoir* api, Renoir_Swapchain swapchain)
 	auto h = (Renoir_Handle*)swapchain.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_SWAPCHAIN_FREE);
 	command->swapchain_free.handle = h;
@@ -1028,8 +1374,8 @@ _renoir_null_swapchain_resize(Renoir* api, Renoir_Swapchain swapchain, int width
 	auto h = (Renoir_Handle*)swapchain.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_SWAPCHAIN_RESIZE);
 	command->swapchain_resize.handle = h;
@@ -1045,8 +1391,8 @@ _renoir_null_swapchain_present(Renoir* api, Renoir_Swapchain swapchain)
 	auto h = (Renoir_Handle*)swapchain.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	// process commands
 	for(auto it = self->command_list_head; it != nullptr; it = it->next)
@@ -1057,6 +1403,8 @@ _renoir_null_swapchain_present(Renoir* api, Renoir_Swapchain swapchain)
 
 	self->command_list_head = nullptr;
 	self->command_list_tail = nullptr;
+
+	_renoir_null_frame_end(self);
 }
 
 static Renoir_Buffer
@@ -1075,16 +1423,24 @@ _renoir_null_buffer_new(Renoir* api, Renoir_Buffer_Desc desc)
 		mn_unreachable_msg("uniform buffers should be aligned to 16 bytes");
 	}
 
+	if (desc.usage == RENOIR_USAGE_STREAM && desc.data_size == 0)
+	{
+		mn_unreachable_msg("a stream buffer should have a size");
+	}
+
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_BUFFER);
 	h->buffer.type = desc.type;
 	h->buffer.usage = desc.usage;
 	h->buffer.access = desc.access;
 	h->buffer.size = desc.data_size;
+	_renoir_null_resource_bytes_add(self, h);
+	if (desc.usage == RENOIR_USAGE_STREAM)
+		h->buffer.stream_memory = mn::alloc(desc.data_size, alignof(max_align_t));
 
 	return Renoir_Buffer{h};
 }
@@ -1096,8 +1452,8 @@ _renoir_null_buffer_free(Renoir* api, Renoir_Buffer buffer)
 	auto h = (Renoir_Handle*)buffer.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_BUFFER_FREE);
 	command->buffer_free.handle = h;
 	_renoir_null_command_process(self, command);
@@ -1113,6 +1469,32 @@ _renoir_null_buffer_size(Renoir* api, Renoir_Buffer buffer)
 	return h->buffer.size;
 }
 
+static Renoir_Stream_Alloc
+_renoir_null_buffer_stream_alloc(Renoir* api, Renoir_Buffer buffer, size_t size, size_t alignment)
+{
+	auto self = api->ctx;
+	auto h = (Renoir_Handle*)buffer.handle;
+	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert_msg(h->buffer.usage == RENOIR_USAGE_STREAM, "buffer_stream_alloc only works with stream buffers");
+	mn_assert_msg(size <= h->buffer.size, "stream allocation is larger than the stream buffer");
+
+	if (alignment == 0)
+		alignment = 1;
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+
+	auto offset = (h->buffer.stream_head + alignment - 1) / alignment * alignment;
+	if (offset + size > h->buffer.size)
+		offset = 0;
+	h->buffer.stream_head = offset + size;
+
+	Renoir_Stream_Alloc res{};
+	res.ptr = (char*)h->buffer.stream_memory.ptr + offset;
+	res.offset = offset;
+	return res;
+}
+
 static Renoir_Texture
 _renoir_null_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 {
@@ -1129,6 +1511,11 @@ _renoir_null_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 		mn_unreachable_msg("a dynamic texture with cpu access set to none is a static texture");
 	}
 
+	if (desc.usage == RENOIR_USAGE_STREAM)
+	{
+		mn_unreachable_msg("only buffers can have stream usage");
+	}
+
 	if (desc.usage == RENOIR_USAGE_STATIC && (desc.access == RENOIR_ACCESS_WRITE || desc.access == RENOIR_ACCESS_READ_WRITE))
 	{
 		mn_unreachable_msg("a static texture cannot have write access");
@@ -1141,13 +1528,14 @@ _renoir_null_texture_new(Renoir* api, Renoir_Texture_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_TEXTURE);
 	h->texture.desc = desc;
 	::memset(h->texture.desc.data, 0, sizeof(h->texture.desc.data));
 	h->texture.desc.data_size = 0;
+	_renoir_null_resource_bytes_add(self, h);
 	return Renoir_Texture{h};
 }
 
@@ -1158,8 +1546,8 @@ _renoir_null_texture_free(Renoir* api, Renoir_Texture texture)
 	auto h = (Renoir_Handle*)texture.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_TEXTURE_FREE);
 	command->texture_free.handle = h;
 	_renoir_null_command_process(self, command);
@@ -1195,8 +1583,8 @@ _renoir_null_program_new(Renoir* api, Renoir_Program_Desc desc)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_PROGRAM);
 	return Renoir_Program{h};
@@ -1209,14 +1597,24 @@ _renoir_null_program_free(Renoir* api, Renoir_Program program)
 	auto h = (Renoir_Handle*)program.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_PROGRAM_FREE);
 	command->program_free.handle = h;
 	_renoir_null_command_process(self, command);
 }
 
+// null backend compiles nothing, so the programs are always ready
+static bool
+_renoir_null_program_ready(Renoir* api, Renoir_Program program)
+{
+	auto h = (Renoir_Handle*)program.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_PROGRAM);
+	return true;
+}
+
 static Renoir_Compute
 _renoir_null_compute_new(Renoir* api, Renoir_Compute_Desc desc)
 {
@@ -1226,8 +1624,8 @@ _renoir_null_compute_new(Renoir* api, Renoir_Compute_Desc desc)
 
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_COMPUTE);
 	return Renoir_Compute{h};
@@ -1240,14 +1638,23 @@ _renoir_null_compute_free(Renoir* api, Renoir_Compute compute)
 	auto h = (Renoir_Handle*)compute.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_COMPUTE_FREE);
 	command->compute_free.handle = h;
 	_renoir_null_command_process(self, command);
 }
 
+static bool
+_renoir_null_compute_ready(Renoir* api, Renoir_Compute compute)
+{
+	auto h = (Renoir_Handle*)compute.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE);
+	return true;
+}
+
 static Renoir_Pipeline
 _renoir_null_pipeline_new(Renoir* api, Renoir_Pipeline_Desc desc)
 {
@@ -1257,9 +1664,11 @@ _renoir_null_pipeline_new(Renoir* api, Renoir_Pipeline_Desc desc)
 	auto h_program = (Renoir_Handle*)desc.program.handle;
 	mn_assert(h_program);
 	mn_assert(h_program->kind == RENOIR_HANDLE_KIND_PROGRAM);
+	auto h_fallback = (Renoir_Handle*)desc.fallback.handle;
+	mn_assert(h_fallback == nullptr || h_fallback->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_PIPELINE);
 	h->pipeline.desc = desc;
@@ -1280,8 +1689,8 @@ _renoir_null_pipeline_free(Renoir* api, Renoir_Pipeline pipeline)
 	mn_assert(h != nullptr);
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_PIPELINE);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_PIPELINE_FREE);
 	command->pipeline_free.handle = h;
@@ -1293,8 +1702,8 @@ _renoir_null_pass_swapchain_new(Renoir* api, Renoir_Swapchain swapchain)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_RASTER_PASS);
 	h->raster_pass.swapchain = (Renoir_Handle*)swapchain.handle;
@@ -1343,8 +1752,8 @@ _renoir_null_pass_offscreen_new(Renoir* api, Renoir_Pass_Offscreen_Desc desc)
 		}
 	}
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_RASTER_PASS);
 	h->raster_pass.offscreen = desc;
@@ -1363,20 +1772,40 @@ _renoir_null_pass_compute_new(Renoir* api)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_COMPUTE_PASS);
 	return Renoir_Pass{h};
 }
 
+static Renoir_Pass
+_renoir_null_pass_secondary_new(Renoir* api, Renoir_Pass parent)
+{
+	auto self = api->ctx;
+	auto hparent = (Renoir_Handle*)parent.handle;
+	mn_assert(hparent != nullptr);
+	mn_assert_msg(_renoir_null_pass_parent(hparent) == nullptr, "secondary passes can't be nested");
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+
+	auto h = _renoir_null_handle_new(self, hparent->kind);
+	_renoir_null_handle_ref(hparent);
+	if (h->kind == RENOIR_HANDLE_KIND_RASTER_PASS)
+		h->raster_pass.parent = hparent;
+	else
+		h->compute_pass.parent = hparent;
+	return Renoir_Pass{h};
+}
+
 static void
 _renoir_null_pass_free(Renoir* api, Renoir_Pass pass)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = (Renoir_Handle*)pass.handle;
 	mn_assert(h != nullptr);
@@ -1422,8 +1851,8 @@ _renoir_null_timer_new(Renoir* api)
 {
 	auto self = api->ctx;
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_TIMER);
 	return Renoir_Timer{h};
@@ -1436,8 +1865,8 @@ _renoir_null_timer_free(struct Renoir* api, Renoir_Timer timer)
 	auto h = (Renoir_Handle*)timer.handle;
 	mn_assert(h != nullptr);
 
-	mn::mutex_lock(self->mtx);
-	mn_defer{mn::mutex_unlock(self->mtx);};
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
 
 	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_TIMER_FREE);
 	command->timer_free.handle = h;
@@ -1455,16 +1884,59 @@ _renoir_null_timer_elapsed(Renoir*, Renoir_Timer timer, uint64_t*)
 
 // Graphics Commands
 static void
-_renoir_null_pass_submit(Renoir*, Renoir_Pass pass)
+_renoir_null_pass_submit(Renoir* api, Renoir_Pass pass)
 {
 	auto h = (Renoir_Handle*)pass.handle;
 	if (h != nullptr)
 	{
 		mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS ||
 			   h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+		mn_assert_msg(_renoir_null_pass_parent(h) == nullptr, "secondary passes are merged into their parent, not submitted");
+
+#if RENOIR_STATS
+		auto self = api->ctx;
+		auto& stats = _renoir_null_pass_stats(h);
+		if (stats.draws)
+			self->draws_frame.fetch_add(stats.draws);
+		if (stats.dispatches)
+			self->dispatches_frame.fetch_add(stats.dispatches);
+		if (stats.primitives)
+			self->primitives_frame.fetch_add(stats.primitives);
+		if (stats.upload_bytes)
+			self->upload_bytes_frame.fetch_add(stats.upload_bytes);
+		if (stats.pipeline_binds)
+			self->pipeline_binds_frame.fetch_add(stats.pipeline_binds);
+		if (stats.texture_binds)
+			self->texture_binds_frame.fetch_add(stats.texture_binds);
+		stats = Renoir_Null_Pass_Stats{};
+#endif
 	}
 }
 
+static void
+_renoir_null_pass_merge(Renoir*, Renoir_Pass pass, Renoir_Pass secondary)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	auto hsecondary = (Renoir_Handle*)secondary.handle;
+	mn_assert(hsecondary != nullptr);
+	mn_assert_msg(_renoir_null_pass_parent(hsecondary) == h, "secondary pass can only be merged into its parent");
+
+#if RENOIR_STATS
+	// the secondary pass commands are counted when the parent is submitted
+	auto& stats = _renoir_null_pass_stats(h);
+	auto& secondary_stats = _renoir_null_pass_stats(hsecondary);
+	stats.draws += secondary_stats.draws;
+	stats.dispatches += secondary_stats.dispatches;
+	stats.primitives += secondary_stats.primitives;
+	stats.upload_bytes += secondary_stats.upload_bytes;
+	stats.pipeline_binds += secondary_stats.pipeline_binds;
+	stats.texture_binds += secondary_stats.texture_binds;
+	secondary_stats = Renoir_Null_Pass_Stats{};
+#endif
+}
+
 static void
 _renoir_null_clear(Renoir*, Renoir_Pass pass, Renoir_Clear_Desc)
 {
@@ -1483,6 +1955,10 @@ _renoir_null_use_pipeline(Renoir*, Renoir_Pass pass, Renoir_Pipeline pipeline)
 
 	auto h_pipeline = (Renoir_Handle*)pipeline.handle;
 	mn_assert(h_pipeline->kind == RENOIR_HANDLE_KIND_PIPELINE);
+
+#if RENOIR_STATS
+	++h->raster_pass.stats.pipeline_binds;
+#endif
 }
 
 static void
@@ -1520,7 +1996,7 @@ _renoir_null_buffer_zero(Renoir*, Renoir_Pass pass, Renoir_Buffer buffer)
 }
 
 static void
-_renoir_null_buffer_write(Renoir*, Renoir_Pass pass, Renoir_Buffer buffer, size_t, void*, size_t)
+_renoir_null_buffer_write(Renoir* api, Renoir_Pass pass, Renoir_Buffer buffer, size_t, void*, size_t bytes_size)
 {
 	auto h = (Renoir_Handle*)pass.handle;
 	if (h != nullptr)
@@ -1533,10 +2009,18 @@ _renoir_null_buffer_write(Renoir*, Renoir_Pass pass, Renoir_Buffer buffer, size_
 	mn_assert(hbuffer != nullptr);
 
 	mn_assert(hbuffer->buffer.usage != RENOIR_USAGE_STATIC);
+	mn_assert_msg(hbuffer->buffer.usage != RENOIR_USAGE_STREAM, "stream buffers are written using buffer_stream_alloc");
+
+#if RENOIR_STATS
+	if (h != nullptr)
+		_renoir_null_pass_stats(h).upload_bytes += bytes_size;
+	else
+		api->ctx->upload_bytes_frame.fetch_add(bytes_size);
+#endif
 }
 
 static void
-_renoir_null_texture_write(Renoir*, Renoir_Pass pass, Renoir_Texture texture, Renoir_Texture_Edit_Desc)
+_renoir_null_texture_write(Renoir* api, Renoir_Pass pass, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc)
 {
 	auto h = (Renoir_Handle*)pass.handle;
 	if (h != nullptr)
@@ -1547,6 +2031,13 @@ _renoir_null_texture_write(Renoir*, Renoir_Pass pass, Renoir_Texture texture, Re
 
 	auto htexture = (Renoir_Handle*)texture.handle;
 	mn_assert(htexture->texture.desc.usage != RENOIR_USAGE_STATIC);
+
+#if RENOIR_STATS
+	if (h != nullptr)
+		_renoir_null_pass_stats(h).upload_bytes += desc.bytes_size;
+	else
+		api->ctx->upload_bytes_frame.fetch_add(desc.bytes_size);
+#endif
 }
 
 static void
@@ -1566,6 +2057,73 @@ _renoir_null_texture_read(Renoir*, Renoir_Texture texture, Renoir_Texture_Edit_D
 	::memset(desc.bytes, 0, desc.bytes_size);
 }
 
+static Renoir_Readback
+_renoir_null_buffer_read_async(Renoir* api, Renoir_Buffer buffer, size_t offset, size_t bytes_size)
+{
+	auto self = api->ctx;
+	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	mn_assert(hbuffer != nullptr && hbuffer->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert_msg(offset + bytes_size <= hbuffer->buffer.size, "read is out of the buffer bounds");
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+
+	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_READBACK);
+	h->readback.size = bytes_size;
+	return Renoir_Readback{h};
+}
+
+static Renoir_Readback
+_renoir_null_texture_read_async(Renoir* api, Renoir_Texture texture, Renoir_Texture_Edit_Desc desc)
+{
+	auto self = api->ctx;
+	auto htexture = (Renoir_Handle*)texture.handle;
+	mn_assert(htexture != nullptr && htexture->kind == RENOIR_HANDLE_KIND_TEXTURE);
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+
+	auto h = _renoir_null_handle_new(self, RENOIR_HANDLE_KIND_READBACK);
+	h->readback.size = desc.bytes_size;
+	return Renoir_Readback{h};
+}
+
+static bool
+_renoir_null_readback_poll(Renoir*, Renoir_Readback readback, void* bytes, size_t bytes_size)
+{
+	auto h = (Renoir_Handle*)readback.handle;
+	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_READBACK);
+	mn_assert_msg(bytes_size <= h->readback.size, "readback is smaller than the requested size");
+
+	::memset(bytes, 0, bytes_size);
+	return true;
+}
+
+static void
+_renoir_null_readback_wait(Renoir*, Renoir_Readback readback, void* bytes, size_t bytes_size)
+{
+	auto h = (Renoir_Handle*)readback.handle;
+	mn_assert(h != nullptr && h->kind == RENOIR_HANDLE_KIND_READBACK);
+	mn_assert_msg(bytes_size <= h->readback.size, "readback is smaller than the requested size");
+
+	::memset(bytes, 0, bytes_size);
+}
+
+static void
+_renoir_null_readback_free(Renoir* api, Renoir_Readback readback)
+{
+	auto self = api->ctx;
+	auto h = (Renoir_Handle*)readback.handle;
+	mn_assert(h != nullptr);
+
+	_renoir_null_mtx_lock(self);
+	mn_defer{_renoir_null_mtx_unlock(self);};
+
+	auto command = _renoir_null_command_new(self, RENOIR_COMMAND_KIND_READBACK_FREE);
+	command->readback_free.handle = h;
+	_renoir_null_command_process(self, command);
+}
+
 static void
 _renoir_null_buffer_bind(Renoir*, Renoir_Pass pass, Renoir_Buffer, RENOIR_SHADER, int)
 {
@@ -1576,12 +2134,37 @@ _renoir_null_buffer_bind(Renoir*, Renoir_Pass pass, Renoir_Buffer, RENOIR_SHADER
 }
 
 static void
-_renoir_null_buffer_storage_bind(Renoir*, Renoir_Pass pass, Renoir_Buffer_Storage_Bind_Desc)
+_renoir_null_buffer_bind_range(Renoir*, Renoir_Pass pass, Renoir_Buffer buffer, RENOIR_SHADER, int, size_t offset, size_t size)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	mn_assert(hbuffer != nullptr);
+	mn_assert_msg(size > 0, "buffer bind range should not be empty");
+	mn_assert_msg(offset % 256 == 0, "buffer bind offset should be a multiple of the buffer offset alignment");
+	mn_assert_msg(offset + size <= hbuffer->buffer.size, "buffer bind range is out of the buffer bounds");
+}
+
+static void
+_renoir_null_buffer_storage_bind(Renoir*, Renoir_Pass pass, Renoir_Buffer_Storage_Bind_Desc desc)
 {
 	auto h = (Renoir_Handle*)pass.handle;
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	for (int i = 0; i < RENOIR_CONSTANT_BUFFER_STORAGE_SIZE; ++i)
+	{
+		auto hbuffer = (Renoir_Handle*)desc.buffers[i].handle;
+		if (hbuffer == nullptr)
+			continue;
+
+		mn_assert_msg(desc.offsets[i] % 256 == 0, "buffer bind offset should be a multiple of the buffer offset alignment");
+		mn_assert_msg(desc.offsets[i] + desc.sizes[i] <= hbuffer->buffer.size, "buffer bind range is out of the buffer bounds");
+	}
 }
 
 static void
@@ -1592,6 +2175,10 @@ _renoir_null_texture_bind(Renoir*, Renoir_Pass pass, Renoir_Texture texture, REN
 
 	auto htex = (Renoir_Handle*)texture.handle;
 	mn_assert(htex != nullptr);
+
+#if RENOIR_STATS
+	++_renoir_null_pass_stats(h).texture_binds;
+#endif
 }
 
 static void
@@ -1602,6 +2189,10 @@ _renoir_null_texture_sampler_bind(Renoir*, Renoir_Pass pass, Renoir_Texture text
 
 	auto htex = (Renoir_Handle*)texture.handle;
 	mn_assert(htex != nullptr);
+
+#if RENOIR_STATS
+	++_renoir_null_pass_stats(h).texture_binds;
+#endif
 }
 
 static void
@@ -1637,12 +2228,48 @@ _renoir_null_texture_compute_bind(Renoir*, Renoir_Pass pass, Renoir_Texture, int
 }
 
 static void
-_renoir_null_draw(Renoir*, Renoir_Pass pass, Renoir_Draw_Desc)
+_renoir_null_draw(Renoir*, Renoir_Pass pass, Renoir_Draw_Desc desc)
 {
 	auto h = (Renoir_Handle*)pass.handle;
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+#if RENOIR_STATS
+	++h->raster_pass.stats.draws;
+	h->raster_pass.stats.primitives += _renoir_primitive_count(desc.primitive, desc.elements_count, desc.instances_count);
+#endif
+}
+
+static void
+_renoir_null_draw_indirect(Renoir*, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS);
+
+	auto indirect_buffer = (Renoir_Handle*)desc.indirect_buffer.handle;
+	mn_assert(indirect_buffer != nullptr);
+	mn_assert(indirect_buffer->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert(indirect_buffer->buffer.type == RENOIR_BUFFER_INDIRECT);
+	mn_assert_msg(desc.indirect_offset % 4 == 0, "indirect offset should be a multiple of 4");
+	mn_assert(desc.draw_count >= 0);
+
+#if RENOIR_STATS
+	h->raster_pass.stats.draws += desc.draw_count;
+#endif
+}
+
+static void
+_renoir_null_draw_indirect_count(Renoir* api, Renoir_Pass pass, Renoir_Draw_Indirect_Desc desc)
+{
+	_renoir_null_draw_indirect(api, pass, desc);
+
+	auto count_buffer = (Renoir_Handle*)desc.count_buffer.handle;
+	mn_assert(count_buffer != nullptr);
+	mn_assert(count_buffer->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert_msg(desc.count_offset % 4 == 0, "count offset should be a multiple of 4");
 }
 
 static void
@@ -1654,6 +2281,40 @@ _renoir_null_dispatch(Renoir*, Renoir_Pass pass, int x, int y, int z)
 	mn_assert(h != nullptr);
 
 	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+
+#if RENOIR_STATS
+	++h->compute_pass.stats.dispatches;
+#endif
+}
+
+static void
+_renoir_null_dispatch_indirect(Renoir*, Renoir_Pass pass, Renoir_Buffer buffer, size_t offset)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+
+	auto hbuffer = (Renoir_Handle*)buffer.handle;
+	mn_assert(hbuffer != nullptr);
+	mn_assert(hbuffer->kind == RENOIR_HANDLE_KIND_BUFFER);
+	mn_assert(hbuffer->buffer.type == RENOIR_BUFFER_INDIRECT);
+	mn_assert_msg(offset % 4 == 0, "indirect offset should be a multiple of 4");
+	mn_assert_msg(offset + sizeof(Renoir_Dispatch_Indirect_Command) <= hbuffer->buffer.size, "indirect offset out of range");
+
+#if RENOIR_STATS
+	++h->compute_pass.stats.dispatches;
+#endif
+}
+
+static void
+_renoir_null_barrier(Renoir*, Renoir_Pass pass, int barriers)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS ||
+		   h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+	mn_assert_msg((barriers & ~RENOIR_BARRIER_ALL) == 0, "invalid barrier flags");
 }
 
 static void
@@ -1680,6 +2341,45 @@ _renoir_null_timer_end(Renoir*, Renoir_Pass pass, Renoir_Timer timer)
 	mn_assert(htimer != nullptr && htimer->kind == RENOIR_HANDLE_KIND_TIMER);
 }
 
+static void
+_renoir_null_profile_begin(Renoir*, Renoir_Pass pass, const char* name)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS ||
+		   h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+	mn_assert(name != nullptr);
+}
+
+static void
+_renoir_null_profile_end(Renoir*, Renoir_Pass pass)
+{
+	auto h = (Renoir_Handle*)pass.handle;
+	mn_assert(h != nullptr);
+	mn_assert(h->kind == RENOIR_HANDLE_KIND_RASTER_PASS ||
+		   h->kind == RENOIR_HANDLE_KIND_COMPUTE_PASS);
+}
+
+static bool
+_renoir_null_profile_results(Renoir*, Renoir_Profile_Results* results)
+{
+	mn_assert(results != nullptr);
+	return false;
+}
+
+static void
+_renoir_null_trace_enable(Renoir*, bool)
+{
+	// tracing is not supported
+}
+
+static bool
+_renoir_null_trace_write(Renoir*, const char*)
+{
+	mn::log_error("null: tracing is not supported");
+	return false;
+}
+
 
 inline static void
 _renoir_load_api(Renoir* api)
@@ -1692,6 +2392,9 @@ _renoir_load_api(Renoir* api)
 	api->name = _renoir_null_name;
 	api->texture_origin = _renoir_null_texture_origin;
 	api->info = _renoir_null_info;
+	api->resource_stats = _renoir_null_resource_stats;
+	api->frame_stats = _renoir_null_frame_stats;
+	api->frame_stats_command_name = _renoir_null_frame_stats_command_name;
 
 	api->handle_ref = _renoir_null_handle_ref;
 	api->flush = _renoir_null_flush;
@@ -1704,6 +2407,7 @@ _renoir_load_api(Renoir* api)
 	api->buffer_new = _renoir_null_buffer_new;
 	api->buffer_free = _renoir_null_buffer_free;
 	api->buffer_size = _renoir_null_buffer_size;
+	api->buffer_stream_alloc = _renoir_null_buffer_stream_alloc;
 
 	api->texture_new = _renoir_null_texture_new;
 	api->texture_free = _renoir_null_texture_free;
@@ -1713,9 +2417,11 @@ _renoir_load_api(Renoir* api)
 
 	api->program_new = _renoir_null_program_new;
 	api->program_free = _renoir_null_program_free;
+	api->program_ready = _renoir_null_program_ready;
 
 	api->compute_new = _renoir_null_compute_new;
 	api->compute_free = _renoir_null_compute_free;
+	api->compute_ready = _renoir_null_compute_ready;
 
 	api->pipeline_new = _renoir_null_pipeline_new;
 	api->pipeline_free = _renoir_null_pipeline_free;
@@ -1723,6 +2429,7 @@ _renoir_load_api(Renoir* api)
 	api->pass_swapchain_new = _renoir_null_pass_swapchain_new;
 	api->pass_offscreen_new = _renoir_null_pass_offscreen_new;
 	api->pass_compute_new = _renoir_null_pass_compute_new;
+	api->pass_secondary_new = _renoir_null_pass_secondary_new;
 	api->pass_free = _renoir_null_pass_free;
 	api->pass_size = _renoir_null_pass_size;
 	api->pass_offscreen_desc = _renoir_null_pass_offscreen_desc;
@@ -1732,6 +2439,7 @@ _renoir_load_api(Renoir* api)
 	api->timer_elapsed = _renoir_null_timer_elapsed;
 
 	api->pass_submit = _renoir_null_pass_submit;
+	api->pass_merge = _renoir_null_pass_merge;
 	api->clear = _renoir_null_clear;
 	api->use_pipeline = _renoir_null_use_pipeline;
 	api->use_compute = _renoir_null_use_compute;
@@ -1741,16 +2449,31 @@ _renoir_load_api(Renoir* api)
 	api->texture_write = _renoir_null_texture_write;
 	api->buffer_read = _renoir_null_buffer_read;
 	api->texture_read = _renoir_null_texture_read;
+	api->buffer_read_async = _renoir_null_buffer_read_async;
+	api->texture_read_async = _renoir_null_texture_read_async;
+	api->readback_poll = _renoir_null_readback_poll;
+	api->readback_wait = _renoir_null_readback_wait;
+	api->readback_free = _renoir_null_readback_free;
 	api->buffer_bind = _renoir_null_buffer_bind;
+	api->buffer_bind_range = _renoir_null_buffer_bind_range;
 	api->buffer_storage_bind = _renoir_null_buffer_storage_bind;
 	api->texture_bind = _renoir_null_texture_bind;
 	api->texture_sampler_bind = _renoir_null_texture_sampler_bind;
 	api->texture_compute_bind = _renoir_null_texture_compute_bind;
 	api->buffer_compute_bind = _renoir_null_buffer_compute_bind;
 	api->draw = _renoir_null_draw;
+	api->draw_indirect = _renoir_null_draw_indirect;
+	api->draw_indirect_count = _renoir_null_draw_indirect_count;
 	api->dispatch = _renoir_null_dispatch;
+	api->dispatch_indirect = _renoir_null_dispatch_indirect;
+	api->barrier = _renoir_null_barrier;
 	api->timer_begin = _renoir_null_timer_begin;
 	api->timer_end = _renoir_null_timer_end;
+	api->profile_begin = _renoir_null_profile_begin;
+	api->profile_end = _renoir_null_profile_end;
+	api->profile_results = _renoir_null_profile_results;
+	api->trace_enable = _renoir_null_trace_enable;
+	api->trace_write = _renoir_null_trace_write;
 }
 
 extern "C" Renoir*